@@ -106,6 +106,10 @@ function initWebSocket() {
                     data.payload.format = 'openprinttag';
                 }
                 updateNfcData(data.payload);
+            } else if (data.type === 'nfcBays') {
+                updateBays(data.bays);
+            } else if (data.type === 'nfcBatch') {
+                updateNfcBatch(data);
             } else if (data.type === 'writeNfcTag') {
                 handleWriteNfcTagResponse(data.success);
             } else if (data.type === 'heartbeat') {
@@ -507,6 +511,23 @@ function handleSpoolIn(amsId, trayId) {
     }
 }
 
+function updateBays(bays) {
+    const section = document.getElementById('baySection');
+    const list = document.getElementById('bayList');
+    if (!section || !list) return;
+
+    section.classList.toggle('hidden', !bays || bays.length === 0);
+    list.innerHTML = '';
+    (bays || []).forEach(bay => {
+        const item = document.createElement('li');
+        let status = bay.online ? 'empty' : 'offline';
+        if (bay.state === 'spool') status = 'Spool #' + bay.spoolId;
+        else if (bay.state === 'error') status = 'Unknown tag';
+        item.textContent = (bay.location || 'SS ' + bay.ss) + ': ' + status;
+        list.appendChild(item);
+    });
+}
+
 function updateNfcStatusIndicator(data) {
     const indicator = document.getElementById('nfcStatusIndicator');
     
@@ -655,6 +676,28 @@ function updateNfcData(data) {
     nfcStatusContainer.appendChild(nfcDataDiv);
 }
 
+// NFC data packet of a spool tag with correct data types
+function spoolToNfcData(spool) {
+    // Extract temperature values correctly
+    let minTemp = "175";
+    let maxTemp = "275";
+    
+    if (Array.isArray(spool.filament.nozzle_temperature) && 
+        spool.filament.nozzle_temperature.length >= 2) {
+        minTemp = String(spool.filament.nozzle_temperature[0]);
+        maxTemp = String(spool.filament.nozzle_temperature[1]);
+    }
+
+    return {
+        color_hex: spool.filament.color_hex || "FFFFFF",
+        type: spool.filament.material,
+        min_temp: minTemp,
+        max_temp: maxTemp,
+        brand: spool.filament.vendor.name,
+        sm_id: String(spool.id) // Convert to string
+    };
+}
+
 function writeNfcTag() {
     if(!spoolDetected || confirm("Are you sure you want to overwrite the Tag?") == true){
         const selectedText = document.getElementById("selected-filament").textContent;
@@ -673,25 +716,7 @@ function writeNfcTag() {
             return;
         }
 
-        // Extract temperature values correctly
-        let minTemp = "175";
-        let maxTemp = "275";
-        
-        if (Array.isArray(selectedSpool.filament.nozzle_temperature) && 
-            selectedSpool.filament.nozzle_temperature.length >= 2) {
-            minTemp = String(selectedSpool.filament.nozzle_temperature[0]);
-            maxTemp = String(selectedSpool.filament.nozzle_temperature[1]);
-        }
-
-        // Create NFC data packet with correct data types
-        const nfcData = {
-            color_hex: selectedSpool.filament.color_hex || "FFFFFF",
-            type: selectedSpool.filament.material,
-            min_temp: minTemp,
-            max_temp: maxTemp,
-            brand: selectedSpool.filament.vendor.name,
-            sm_id: String(selectedSpool.id) // Convert to string
-        };
+        const nfcData = spoolToNfcData(selectedSpool);
 
         if (socket?.readyState === WebSocket.OPEN) {
             const writeButton = document.getElementById("writeNfcButton");
@@ -736,6 +761,66 @@ function writeLocationNfcTag() {
     }
 }
 
+// Writes a tag for every spool in the list, in list order, as tags are presented
+function writeNfcBatch() {
+    const button = document.getElementById("writeNfcBatchButton");
+    if (button.dataset.active === "true") {
+        socket?.send(JSON.stringify({ type: 'cancelNfcBatch' }));
+        return;
+    }
+
+    const spools = window.getListedSpools();
+    if (spools.length === 0) {
+        alert('No spools listed.');
+        return;
+    }
+    if (!confirm(`Write ${spools.length} tags? Place the tags on the reader one after another in list order.`)) {
+        return;
+    }
+
+    if (socket?.readyState === WebSocket.OPEN) {
+        socket.send(JSON.stringify({
+            type: 'writeNfcBatch',
+            payloads: spools.map(spoolToNfcData)
+        }));
+    } else {
+        alert('Not connected to Server. Please check connection.');
+    }
+}
+
+function updateNfcBatch(batch) {
+    const button = document.getElementById("writeNfcBatchButton");
+    const status = document.getElementById("nfcBatchStatus");
+    if (!button || !status) return;
+
+    if (batch.error) {
+        showNotification(batch.error, false);
+        return;
+    }
+
+    const wasRunning = button.dataset.running === "true";
+    button.dataset.active = batch.active ? "true" : "false";
+    button.dataset.running = (batch.active || batch.pendingUpdates > 0) ? "true" : "false";
+    button.textContent = batch.active ? "Cancel batch" : "Write all listed";
+    if (!batch.active && batch.total === 0) {
+        status.classList.add("hidden");
+        return;
+    }
+
+    let text = `${batch.written}/${batch.total} written`;
+    if (batch.active && batch.nextSpoolId) text += `, next: spool #${batch.nextSpoolId}`;
+    if (batch.failed > 0) text += `, ${batch.failed} failed attempts`;
+    if (batch.pendingUpdates > 0) text += `, ${batch.pendingUpdates} Spoolman updates pending`;
+    if (batch.tagsPerMinute > 0) text += ` (${batch.tagsPerMinute} tags/min)`;
+    status.textContent = text;
+    status.classList.remove("hidden");
+
+    // Refresh the spool list once the batch and its Spoolman updates are done
+    if (wasRunning && button.dataset.running === "false") {
+        window.reloadSpoolData?.();
+    }
+}
+
 function handleWriteNfcTagResponse(success) {
     const writeButton = document.getElementById("writeNfcButton");
     const writeLocationButton = document.getElementById("writeLocationNfcButton");
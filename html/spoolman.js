@@ -1,6 +1,7 @@
 // Global variables
 let spoolmanUrl = '';
 let spoolsData = [];
+let listedSpools = [];
 let locationData = [];
 
 // Helper functions for data manipulation
@@ -184,6 +185,7 @@ function updateFilamentDropdown(selectedSmId = null) {
                    (!onlyWithoutSmId || !hasValidNfcId);
         });
 
+        listedSpools = filteredFilaments;
         filteredFilaments.forEach(spool => {
             const option = document.createElement("div");
             option.className = "dropdown-option";
@@ -403,6 +405,7 @@ document.addEventListener('DOMContentLoaded', () => {
 
 // Export functions
 window.getSpoolData = () => spoolsData;
+window.getListedSpools = () => listedSpools;
 window.setSpoolData = (data) => { spoolsData = data; };
 window.reloadSpoolData = initSpoolman;
 window.populateVendorDropdown = populateVendorDropdown;
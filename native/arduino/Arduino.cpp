@@ -0,0 +1,246 @@
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+FILE* serialOutput = nullptr;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// --- String ---
+
+static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 16) base = DEC;
+    char buf[65];
+    char* p = buf + sizeof(buf);
+    *--p = '\0';
+    do {
+        *--p = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value);
+    return p;
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+    if (value < 0 && base == DEC) return "-" + formatUnsigned(0ULL - (unsigned long long)value, base);
+    return formatUnsigned((unsigned long long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    return buf;
+}
+
+String::String(const char* cstr) : _s(cstr ? cstr : "") {}
+String::String(const char* cstr, unsigned int length) : _s(cstr ? std::string(cstr, length) : "") {}
+String::String(char c) : _s(1, c) {}
+String::String(unsigned char value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : _s(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : _s(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : _s(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : _s(formatUnsigned(value, base)) {}
+String::String(float value, unsigned int decimalPlaces) : _s(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : _s(formatFloat(value, decimalPlaces)) {}
+
+String& String::operator=(const char* cstr) {
+    _s.assign(cstr ? cstr : "");
+    return *this;
+}
+
+bool String::reserve(unsigned int size) {
+    _s.reserve(size);
+    return true;
+}
+
+bool String::concat(const String& other) { _s += other._s; return true; }
+bool String::concat(const char* cstr) { if (!cstr) return false; _s += cstr; return true; }
+bool String::concat(const char* cstr, unsigned int length) { if (!cstr) return false; _s.append(cstr, length); return true; }
+bool String::concat(char c) { _s += c; return true; }
+bool String::concat(unsigned char value) { _s += formatUnsigned(value, DEC); return true; }
+bool String::concat(int value) { _s += formatSigned(value, DEC); return true; }
+bool String::concat(unsigned int value) { _s += formatUnsigned(value, DEC); return true; }
+bool String::concat(long value) { _s += formatSigned(value, DEC); return true; }
+bool String::concat(unsigned long value) { _s += formatUnsigned(value, DEC); return true; }
+bool String::concat(float value) { _s += formatFloat(value, 2); return true; }
+bool String::concat(double value) { _s += formatFloat(value, 2); return true; }
+
+int String::compareTo(const String& other) const {
+    return _s.compare(other._s);
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (_s.length() != other._s.length()) return false;
+    for (size_t i = 0; i < _s.length(); i++) {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)other._s[i])) return false;
+    }
+    return true;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return _s.compare(0, prefix._s.length(), prefix._s) == 0 && _s.length() >= prefix._s.length();
+}
+
+bool String::endsWith(const String& suffix) const {
+    return _s.length() >= suffix._s.length() &&
+           _s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < _s.length() ? _s[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+    if (index < _s.length()) _s[index] = c;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= _s.length()) {
+        dummy = '\0';
+        return dummy;
+    }
+    return _s[index];
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = _s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+    size_t pos = _s.find(text._s, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = _s.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& text) const {
+    size_t pos = _s.rfind(text._s);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from) const {
+    return substring(from, _s.length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.length()) return String();
+    if (to > _s.length()) to = _s.length();
+    return String(_s.c_str() + from, to - from);
+}
+
+void String::replace(char find, char replacement) {
+    std::replace(_s.begin(), _s.end(), find, replacement);
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find._s.empty()) return;
+    size_t pos = 0;
+    while ((pos = _s.find(find._s, pos)) != std::string::npos) {
+        _s.replace(pos, find._s.length(), replacement._s);
+        pos += replacement._s.length();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < _s.length()) _s.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < _s.length()) _s.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (char& c : _s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : _s) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t start = 0;
+    size_t end = _s.length();
+    while (start < end && isspace((unsigned char)_s[start])) start++;
+    while (end > start && isspace((unsigned char)_s[end - 1])) end--;
+    _s = _s.substr(start, end - start);
+}
+
+long String::toInt() const { return atol(_s.c_str()); }
+float String::toFloat() const { return (float)atof(_s.c_str()); }
+double String::toDouble() const { return atof(_s.c_str()); }
+
+StringSumHelper operator+(const StringSumHelper& lhs, const String& rhs) {
+    StringSumHelper result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+StringSumHelper operator+(const StringSumHelper& lhs, const char* rhs) {
+    StringSumHelper result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+StringSumHelper operator+(const StringSumHelper& lhs, char rhs) {
+    StringSumHelper result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+StringSumHelper operator+(const char* lhs, const String& rhs) {
+    StringSumHelper result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+// --- Print ---
+
+size_t Print::write(uint8_t c) {
+    if (serialOutput) fputc(c, serialOutput);
+    return 1;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    if (serialOutput) fwrite(buffer, 1, size, serialOutput);
+    return size;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return length < 0 ? 0 : write((const uint8_t*)buf, std::min((size_t)length, sizeof(buf) - 1));
+}
+
+size_t Print::print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+size_t Print::print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(int value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(unsigned int value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(unsigned long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t Print::print(double value, int digits) { return print(String(value, (unsigned int)digits)); }
+size_t Print::println() { return write((const uint8_t*)"\r\n", 2); }
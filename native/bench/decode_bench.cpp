@@ -0,0 +1,189 @@
+// Decode cost of tag dumps (NDEF area from page 4 on) on the host:
+// - stream: NdefStreamDecoder fed in 16-byte READ blocks, as streamReadTag()
+// - decode: decodeTagBuffer(), the buffer side of decodeNdefAndReturnJson()
+// Heap use counts malloc/realloc/calloc (linked with --wrap) and operator new;
+// peak is the high-water mark of live heap during one decode, in
+// malloc_usable_size() bytes.
+//
+//   pio run -e native && .pio/build/native/program [dump or directory ...]
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <chrono>
+#include <dirent.h>
+#include <malloc.h>
+#include <new>
+#include <vector>
+#include "ndefstream.h"
+#include "tagdecode.h"
+
+#define BENCH_DEFAULT_CORPUS    "native/fuzz/corpus/ntag"
+#define BENCH_MIN_NS            200000000ULL    // run each dump for at least 200 ms
+#define BENCH_READ_BLOCK        16
+
+// --- Heap counters ---
+
+static size_t allocCount = 0;
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+static void trackAlloc(void* ptr) {
+    if (!ptr) return;
+    allocCount++;
+    liveBytes += malloc_usable_size(ptr);
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+}
+
+static void trackFree(void* ptr) {
+    if (!ptr) return;
+    // Blocks from before the counters were reset can take live below zero
+    size_t size = malloc_usable_size(ptr);
+    liveBytes = liveBytes > size ? liveBytes - size : 0;
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __real_calloc(count, size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    trackFree(ptr);
+    void* result = __real_realloc(ptr, size);
+    // A failed realloc keeps the old block
+    trackAlloc(result ? result : (size ? ptr : nullptr));
+    return result;
+}
+
+void __wrap_free(void* ptr) {
+    trackFree(ptr);
+    __real_free(ptr);
+}
+}
+
+void* operator new(size_t size) {
+    void* ptr = __wrap_malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { __wrap_free(ptr); }
+void operator delete[](void* ptr) noexcept { __wrap_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { __wrap_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { __wrap_free(ptr); }
+
+// --- Decoders under test ---
+
+static bool streamDecode(const uint8_t* data, uint16_t size) {
+    NdefStreamDecoder decoder;
+    for (uint16_t pos = 0; pos < size && !decoder.finished() && !decoder.failed(); pos += BENCH_READ_BLOCK) {
+        decoder.push(data + pos, std::min<uint16_t>(BENCH_READ_BLOCK, size - pos));
+    }
+    return decoder.finished();
+}
+
+static bool fullDecode(const uint8_t* data, uint16_t size) {
+    TagDecodeResult result;
+    return decodeTagBuffer(data, size, result) == TAG_DECODE_OK;
+}
+
+// --- Measurement ---
+
+struct BenchResult {
+    bool ok;
+    double nsPerDecode;
+    size_t allocs;
+    size_t peak;
+};
+
+template <typename Decode>
+static BenchResult measure(Decode decode) {
+    BenchResult result;
+    allocCount = 0;
+    liveBytes = 0;
+    peakBytes = 0;
+    result.ok = decode();
+    result.allocs = allocCount;
+    result.peak = peakBytes;
+
+    uint64_t iterations = 0;
+    uint64_t elapsed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t batch = 16; elapsed < BENCH_MIN_NS; batch *= 2) {
+        for (uint64_t i = 0; i < batch; i++) decode();
+        iterations += batch;
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    result.nsPerDecode = (double)elapsed / iterations;
+    return result;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    uint8_t buf[1024];
+    size_t length;
+    data.clear();
+    while ((length = fread(buf, 1, sizeof(buf), file)) > 0) data.insert(data.end(), buf, buf + length);
+    fclose(file);
+    return true;
+}
+
+static void collect(const std::string& path, std::vector<std::string>& files) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        files.push_back(path);
+        return;
+    }
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') names.push_back(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    files.insert(files.end(), names.begin(), names.end());
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> files;
+    if (argc < 2) collect(BENCH_DEFAULT_CORPUS, files);
+    for (int i = 1; i < argc; i++) collect(argv[i], files);
+
+    printf("%-32s %5s | %10s %6s %7s | %10s %6s %7s\n",
+           "dump", "bytes", "stream ns", "allocs", "peak", "decode ns", "allocs", "peak");
+
+    int failures = 0;
+    for (const std::string& path : files) {
+        std::vector<uint8_t> data;
+        if (!readFile(path, data) || data.empty() || data.size() > 0xFFFF) {
+            printf("%s: cannot read\n", path.c_str());
+            failures++;
+            continue;
+        }
+
+        uint16_t size = data.size();
+        BenchResult stream = measure([&] { return streamDecode(data.data(), size); });
+        BenchResult decode = measure([&] { return fullDecode(data.data(), size); });
+
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        printf("%-32s %5u | %10.0f %6zu %7zu | %10.0f %6zu %7zu%s\n",
+               name.c_str(), size, stream.nsPerDecode, stream.allocs, stream.peak,
+               decode.nsPerDecode, decode.allocs, decode.peak, decode.ok ? "" : "  (not decoded)");
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+// Input: payload of a compact ("fm/s") record
+#include "compacttag.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > 0xFFFF) return 0;
+
+    uint32_t spoolId;
+    bool hasSpoolId = compactTagSpoolId(data, size, spoolId);
+
+    String json;
+    if (!compactTagDecode(data, size, json)) return 0;
+
+    // A decoded tag always has a header and puts sm_id first
+    if (!hasSpoolId || !json.startsWith("{\"sm_id\":\"")) abort();
+    return 0;
+}
@@ -0,0 +1,22 @@
+// NDEF area of a tag (page 4 on) taken apart like decodeNdefAndReturnJson()
+// does: first record, then the JSON object at the start of its payload.
+#include "ndefrecord.h"
+#include "openprinttag.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > 0xFFFF) return 0;
+
+    NdefRecordView record;
+    if (!parseNdefRecord(data, size, record)) return 0;
+
+    const uint8_t* end = data + size;
+    if (record.type.data + record.type.length > end || record.payload.data + record.payload.length > end) abort();
+
+    bool complete;
+    ByteSpan json = jsonObjectSpan(record.payload, complete);
+    if (json.data < record.payload.data ||
+        json.data + json.length > record.payload.data + record.payload.length) abort();
+
+    detectTagFormat(record.payload.data, record.payload.length, record.type.length, record.type.data);
+    return 0;
+}
@@ -0,0 +1,40 @@
+// NDEF area of a tag (page 4 on) pushed in chunks of varying size, so TLV,
+// record fields and JSON tokens get split at every kind of boundary.
+#include "ndefstream.h"
+
+static const uint16_t chunkSizes[] = { 16, 1, 64, 3, 16, 7 };
+
+static void onEvent(const NdefStreamEvent& event, void* context) {
+    size_t* total = (size_t*)context;
+    switch (event.type) {
+        case NDEF_EVENT_RECORD:
+            *total += strlen(event.recordType);
+            break;
+        case NDEF_EVENT_KEY_VALUE:
+            if (strlen(event.key) > NDEF_STREAM_MAX_KEY || strlen(event.value) > NDEF_STREAM_MAX_VALUE) abort();
+            *total += strlen(event.key) + strlen(event.value);
+            break;
+        case NDEF_EVENT_ERROR:
+            *total += strlen(event.error);
+            break;
+        default:
+            break;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > 0xFFFF) return 0;
+
+    size_t total = 0;
+    NdefStreamDecoder decoder(onEvent, &total);
+    size_t pos = 0;
+    // Pushing on after the end or an error must be harmless
+    for (uint8_t chunk = 0; pos < size; chunk++) {
+        size_t length = std::min((size_t)chunkSizes[chunk % (sizeof(chunkSizes) / sizeof(chunkSizes[0]))], size - pos);
+        decoder.push(data + pos, length);
+        pos += length;
+    }
+
+    if (decoder.hasPayload() && decoder.payloadOffset() > pos) abort();
+    return 0;
+}
@@ -0,0 +1,14 @@
+// Input: OpenPrintTag TLV payload of the NDEF record
+#include "openprinttag.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > 0xFFFF) return 0;
+
+    OpenPrintTagData optData;
+    if (!parseOpenPrintTag(data, size, optData)) return 0;
+
+    // Everything the web interface gets from a parsed tag
+    openPrintTagToJson(optData);
+    openPrintTagToOpenSpoolJson(optData);
+    return 0;
+}
@@ -0,0 +1,14 @@
+// Input: [type length][record type][payload]
+#include "openprinttag.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1 || size > 0xFFFF) return 0;
+
+    uint8_t typeLength = data[0];
+    if ((size_t)typeLength + 1 > size) return 0;
+    const uint8_t* recordType = data + 1;
+    const uint8_t* payload = recordType + typeLength;
+
+    detectTagFormat(payload, size - 1 - typeLength, typeLength, typeLength ? recordType : nullptr);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""Writes the seed corpus of the fuzz targets.
+
+The dumps are synthetic: they are generated here, not read from real tags.
+corpus/ntag holds NTAG213/215/216 user memory from page 4 on, sized like the
+buffer the firmware reads into (NtagGeometry::userDataBytes): NDEF TLV,
+record, terminator TLV and zeros for the rest of the data area. The layouts
+follow the firmware writers (buildNdefTlvImage, compactTagEncode,
+buildOpenPrintTagNdefMessage, formatNdefTag) and what other apps leave on
+tags (lock control TLV, OpenSpool JSON). The other directories hold the
+record payloads cut out of those dumps.
+
+    python3 native/fuzz/make_corpus.py
+"""
+
+import json
+import os
+import struct
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CORPUS = os.path.join(HERE, "corpus")
+
+# NtagGeometry::userDataBytes in src/taggeometry.cpp
+USER_BYTES = {"ntag213": 144, "ntag215": 504, "ntag216": 888}
+
+# Key dictionary of src/compacttag.cpp, index = key id
+COMPACT_KEYS = [None, "color_hex", "type", "min_temp", "max_temp", "brand", "location", "b", "an",
+                "cn", "c", "t", "et", "bt", "sw", "de", "di", "u", "mc", "mcd", "artnr"]
+
+
+def ndef_image(mime_type, payload, prefix=b""):
+    """NDEF message TLV with one MIME record plus terminator, as buildNdefTlvImage()."""
+    mime = mime_type.encode()
+    short = len(payload) <= 255
+    record = bytes([0xD2 if short else 0xC2, len(mime)])
+    record += bytes([len(payload)]) if short else struct.pack(">I", len(payload))
+    record += mime + payload
+    tlv = bytes([0x03, len(record)]) if len(record) < 0xFF else bytes([0x03, 0xFF]) + struct.pack(">H", len(record))
+    return prefix + tlv + record + b"\xFE"
+
+
+def tag_dump(tag, image):
+    size = USER_BYTES[tag]
+    assert len(image) <= size, (tag, len(image))
+    return image + bytes(size - len(image))
+
+
+def parse_decimal(text, max_value):
+    if not text or len(text) > 10 or (len(text) > 1 and text[0] == "0") or not text.isdigit():
+        return None
+    value = int(text)
+    return value if value <= max_value else None
+
+
+def is_upper_hex(text):
+    return len(text) >= 2 and len(text) % 2 == 0 and all(c in "0123456789ABCDEF" for c in text)
+
+
+def compact_payload(obj):
+    """Same encoding as compactTagEncode()."""
+    spool_id = 0
+    fields = b""
+    count = 0
+    for key, text in obj.items():
+        if key == "sm_id":
+            spool_id = parse_decimal(text, 0xFFFFFFFF)
+            continue
+        key_id = COMPACT_KEYS.index(key) if key in COMPACT_KEYS else 0
+        number = parse_decimal(text, 0xFFFF)
+        if number is not None:
+            value_type, value = 1, (struct.pack(">H", number) if number > 0xFF else bytes([number]))
+        elif is_upper_hex(text) and len(text) // 2 <= 128:
+            value_type, value = 2, bytes.fromhex(text)
+        else:
+            value_type, value = 0, text.encode()
+        if key_id == 0:
+            value = bytes([len(key)]) + key.encode() + value
+        fields += bytes([(value_type << 6) | key_id, len(value)]) + value
+        count += 1
+    return bytes([0x01, count, 0x00]) + struct.pack(">I", spool_id) + fields
+
+
+def opt_field(key, value):
+    if len(value) < 0x80:
+        return bytes([key, len(value)]) + value
+    return bytes([key, 0x82]) + struct.pack(">H", len(value)) + value
+
+
+def openprinttag_payload(uuid_instance, uuid_brand, material_type, name, abbreviation, brand, color, temps):
+    """Field order of encodeOpenPrintTag()."""
+    payload = opt_field(8, b"\x00")
+    payload += opt_field(0, bytes.fromhex(uuid_instance.replace("-", "")))
+    payload += opt_field(3, bytes.fromhex(uuid_brand.replace("-", "")))
+    payload += opt_field(9, bytes([material_type]))
+    payload += opt_field(10, name.encode())
+    payload += opt_field(52, abbreviation.encode())
+    payload += opt_field(11, brand.encode())
+    payload += opt_field(16, struct.pack(">H", 1000))
+    payload += opt_field(18, struct.pack(">H", 230))
+    payload += opt_field(19, bytes.fromhex(color))
+    for key, value in zip((34, 35, 37, 38), temps):
+        payload += opt_field(key, struct.pack(">H", value))
+    payload += opt_field(29, struct.pack(">H", 124))
+    payload += opt_field(57, struct.pack(">H", 55))
+    payload += opt_field(58, struct.pack(">H", 240))
+    return payload
+
+
+def json_bytes(obj):
+    return json.dumps(obj, separators=(",", ":")).encode()
+
+
+def write(directory, name, data):
+    path = os.path.join(CORPUS, directory)
+    os.makedirs(path, exist_ok=True)
+    with open(os.path.join(path, name), "wb") as f:
+        f.write(data)
+
+
+def main():
+    spool = {"sm_id": "2", "color_hex": "00FF00", "type": "PETG", "min_temp": "220", "max_temp": "250",
+             "brand": "Generic"}
+    brand = {"sm_id": "0", "b": "Prusament", "an": "1041", "cn": "Galaxy Black", "t": "PLA", "c": "3D3E3D",
+             "et": "215", "bt": "60", "sw": "201", "de": "1.24", "di": "1.75",
+             "u": "https://www.prusa3d.com/product/prusament-pla-galaxy-black-1kg/"}
+    multicolor = {"sm_id": "0", "b": "Sunlu", "an": "SL-SILK-RGB", "cn": "Silk Rainbow", "t": "PLA",
+                  "mc": "FF0000,00FF00,0000FF", "mcd": "coaxial", "et": "210", "bt": "55", "sw": "160",
+                  "u": "https://www.sunlu.com/products/silk-pla-multicolor"}
+    long_comment = dict(brand, sm_id="17", cn="Galaxy Black " * 20)
+    openspool = {"protocol": "openspool", "version": "1.0", "type": "PLA", "color_hex": "FFAABB",
+                 "brand": "Generic", "min_temp": "190", "max_temp": "220"}
+    compact_spool = {"sm_id": "1", "color_hex": "FF0000", "type": "PLA", "min_temp": "190", "max_temp": "220",
+                     "brand": "Generic"}
+    compact_brand = {"sm_id": "4711", "b": "Polymaker", "an": "PM70820", "cn": "PolyTerra Charcoal Black",
+                     "t": "PLA", "c": "2B2B2B", "sw": "140", "nozzle": "0.4"}
+    opt = openprinttag_payload("0f6a8d2e-5b1c-4c3a-9e7f-1a2b3c4d5e6f", "7d1f0c9a-3b2e-4f5a-8c6d-9e0f1a2b3c4d",
+                               1, "Prusament PETG Jet Black", "PETG", "Prusament", "1A1A1AFF",
+                               (230, 250, 80, 90))
+
+    records = {
+        "json_spool_ntag215": ("ntag215", "application/json", json_bytes(spool), b""),
+        "json_brand_ntag215": ("ntag215", "application/json", json_bytes(brand), b""),
+        "json_multicolor_ntag215": ("ntag215", "application/json", json_bytes(multicolor), b""),
+        "json_long_record_ntag216": ("ntag216", "application/json", json_bytes(long_comment), b""),
+        "json_location_ntag213": ("ntag213", "application/json", json_bytes({"location": "Shelf A2"}), b""),
+        "json_lock_control_ntag216": ("ntag216", "application/json", json_bytes(spool), b"\x01\x03\xA0\x10\x44"),
+        "openspool_ntag215": ("ntag215", "application/json", json_bytes(openspool), b""),
+        "compact_spool_ntag213": ("ntag213", "fm/s", compact_payload(compact_spool), b""),
+        "compact_brand_ntag213": ("ntag213", "fm/s", compact_payload(compact_brand), b""),
+        "openprinttag_ntag216": ("ntag216", "application/vnd.openprinttag", opt, b""),
+    }
+
+    for name, (tag, mime, payload, prefix) in records.items():
+        write("ntag", name + ".bin", tag_dump(tag, ndef_image(mime, payload, prefix)))
+        write("tagformat", name + ".bin", bytes([len(mime)]) + mime.encode() + payload)
+        if mime == "fm/s":
+            write("compacttag", name + ".bin", payload)
+        elif mime == "application/vnd.openprinttag":
+            write("openprinttag", name + ".bin", payload)
+
+    # Freshly formatted tag (formatNdefTag): empty NDEF message
+    write("ntag", "empty_ntag213.bin", tag_dump("ntag213", b"\x03\x00\xFE"))
+    # Raw spool ID written to the pages without NDEF structure
+    write("tagformat", "raw_spool_id.bin", b"\x00" + b"1234")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,3 @@
+#ifndef ASYNCTCP_NATIVE_SIM_H
+#define ASYNCTCP_NATIVE_SIM_H
+#endif
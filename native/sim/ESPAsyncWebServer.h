@@ -0,0 +1,30 @@
+#ifndef ESPASYNCWEBSERVER_NATIVE_SIM_H
+#define ESPASYNCWEBSERVER_NATIVE_SIM_H
+
+#include <Arduino.h>
+#include <vector>
+
+// The web interface is not served on the host; messages to it are dropped
+
+class AsyncWebServerRequest;
+
+class AsyncWebSocketClient {
+public:
+    uint32_t id() const { return 0; }
+};
+
+class AsyncWebSocket {
+public:
+    explicit AsyncWebSocket(const char*) {}
+    void text(uint32_t, const String&) {}
+    void textAll(const String&) {}
+    void cleanupClients() {}
+    std::vector<AsyncWebSocketClient*> getClients() const { return {}; }
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t) {}
+};
+
+#endif
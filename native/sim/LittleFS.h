@@ -0,0 +1,26 @@
+#ifndef LITTLEFS_NATIVE_SIM_H
+#define LITTLEFS_NATIVE_SIM_H
+
+#include <Arduino.h>
+
+// Empty file system: every open fails
+class File {
+public:
+    explicit operator bool() const { return false; }
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t readBytes(char*, size_t) { return 0; }
+    size_t write(const uint8_t*, size_t) { return 0; }
+    void close() {}
+};
+
+class LittleFSFS {
+public:
+    File open(const char*, const char* = "r") { return File(); }
+    bool exists(const char*) { return false; }
+    bool remove(const char*) { return false; }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
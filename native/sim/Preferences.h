@@ -0,0 +1,21 @@
+#ifndef PREFERENCES_NATIVE_SIM_H
+#define PREFERENCES_NATIVE_SIM_H
+
+#include <Arduino.h>
+
+// Nothing is stored, every key reads back its default
+class Preferences {
+public:
+    bool begin(const char*, bool = false) { return true; }
+    void end() {}
+    bool getBool(const char*, bool defaultValue = false) { return defaultValue; }
+    uint8_t getUChar(const char*, uint8_t defaultValue = 0) { return defaultValue; }
+    uint32_t getUInt(const char*, uint32_t defaultValue = 0) { return defaultValue; }
+    String getString(const char*, const String& defaultValue = String()) { return defaultValue; }
+    size_t putBool(const char*, bool) { return 1; }
+    size_t putUChar(const char*, uint8_t) { return 1; }
+    size_t putUInt(const char*, uint32_t) { return 4; }
+    size_t putString(const char*, const String& value) { return value.length(); }
+};
+
+#endif
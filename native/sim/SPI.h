@@ -0,0 +1,26 @@
+#ifndef SPI_NATIVE_SIM_H
+#define SPI_NATIVE_SIM_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0
+
+// No SPI bus on the host, reads return 0
+class SPISettings {
+public:
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+public:
+    void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) {}
+    void beginTransaction(const SPISettings&) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t) { return 0; }
+    void transfer(uint8_t* data, uint32_t length) { memset(data, 0, length); }
+    void writeBytes(const uint8_t*, uint32_t) {}
+};
+
+extern SPIClass SPI;
+
+#endif
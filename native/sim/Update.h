@@ -0,0 +1,3 @@
+#ifndef UPDATE_NATIVE_SIM_H
+#define UPDATE_NATIVE_SIM_H
+#endif
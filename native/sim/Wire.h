@@ -0,0 +1,23 @@
+#ifndef WIRE_NATIVE_SIM_H
+#define WIRE_NATIVE_SIM_H
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+// No I2C bus on the host, nothing answers
+class TwoWire {
+public:
+    bool begin(int = -1, int = -1, uint32_t = 0) { return true; }
+    void beginTransmission(uint8_t) {}
+    uint8_t endTransmission(bool = true) { return 2; }
+    size_t write(const uint8_t*, size_t length) { return length; }
+    size_t write(uint8_t) { return 1; }
+    uint8_t requestFrom(uint8_t, size_t, bool = true) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef ESP_TASK_WDT_NATIVE_SIM_H
+#define ESP_TASK_WDT_NATIVE_SIM_H
+
+// No watchdog on the host
+inline int esp_task_wdt_reset() { return 0; }
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef ESP_TIMER_NATIVE_SIM_H
+#define ESP_TIMER_NATIVE_SIM_H
+
+#include <Arduino.h>
+
+inline int64_t esp_timer_get_time() { return (int64_t)micros(); }
+
+#endif
@@ -0,0 +1,35 @@
+#include <Arduino.h>
+#include "api.h"
+#include "bambu.h"
+#include "main.h"
+#include "spoolmirror.h"
+#include "website.h"
+
+// The rest of the firmware that nfc.cpp calls into. Spoolman is reachable
+// and accepts every request at once, so the timings are the NFC side only.
+
+bool booting = false;
+BambuCredentials bambuCredentials;
+
+// --- Spoolman ---
+
+bool octoEnabled = false;
+bool spoolmanConnected = true;
+
+bool updateSpoolTagId(String, const char*, uint16_t, ApiPriority, ApiDoneCallback onDone, void* doneContext) {
+    if (onDone) onDone(API_REQUEST_SPOOL_TAG_ID_UPDATE, true, doneContext);
+    return true;
+}
+
+uint8_t updateSpoolLocation(String, String) { return 1; }
+bool createBrandFilament(JsonDocument&, String) { return true; }
+bool createSpoolFromOpenPrintTag(const OpenPrintTagData&, String) { return true; }
+bool spoolMirrorFind(uint16_t, SpoolMirrorEntry&) { return false; }
+
+// --- Web interface: no clients ---
+
+void sendNfcData() {}
+void foundNfcTag(AsyncWebSocketClient*, uint8_t) {}
+void sendWriteResult(AsyncWebSocketClient*, uint8_t) {}
+void sendNfcBays(AsyncWebSocketClient*) {}
+void sendNfcBatch(AsyncWebSocketClient*) {}
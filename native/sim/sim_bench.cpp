@@ -0,0 +1,133 @@
+// Scan and write timings of the firmware's NFC path against the PN532
+// simulator on the host: startNfc() and the RFID task run unchanged on
+// threads, the simulated PN532 charges its per-command latency and bus time,
+// and the simulator reports placement -> activeSpoolId and every write.
+//
+//   pio run -e native-sim && .pio/build/native-sim/program [-v] [scenario.json]
+//
+// -v passes the firmware's Serial output through to stdout.
+#include <Arduino.h>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "events.h"
+#include "nfc.h"
+#include "pn532sim.h"
+
+#define SIM_BENCH_TIMEOUT_MS    120000UL
+
+// Each tag type is placed, read, written and removed once
+static const char* const benchScenario = R"({
+  "latencyUs": 2000,
+  "byteTimeUs": 10,
+  "steps": [
+    { "delay": 1000, "action": "place", "tag": "ntag213", "uid": "04A1B2C3D4E513",
+      "payload": "{\"sm_id\":\"1\",\"color_hex\":\"FF0000\",\"type\":\"PLA\",\"min_temp\":\"190\",\"max_temp\":\"220\",\"brand\":\"Generic\"}" },
+    { "delay": 3000, "action": "write",
+      "payload": "{\"sm_id\":\"11\",\"color_hex\":\"FFFFFF\",\"type\":\"PLA\",\"min_temp\":\"190\",\"max_temp\":\"220\",\"brand\":\"Generic\"}" },
+    { "delay": 6000, "action": "remove" },
+    { "delay": 2000, "action": "place", "tag": "ntag215", "uid": "04A1B2C3D4E515",
+      "payload": "{\"sm_id\":\"2\",\"color_hex\":\"00FF00\",\"type\":\"PETG\",\"min_temp\":\"220\",\"max_temp\":\"250\",\"brand\":\"Generic\"}" },
+    { "delay": 3000, "action": "write",
+      "payload": "{\"sm_id\":\"12\",\"color_hex\":\"FFFFFF\",\"type\":\"PETG\",\"min_temp\":\"220\",\"max_temp\":\"250\",\"brand\":\"Generic\"}" },
+    { "delay": 6000, "action": "remove" },
+    { "delay": 2000, "action": "place", "tag": "ntag216", "uid": "04A1B2C3D4E516",
+      "payload": "{\"sm_id\":\"3\",\"color_hex\":\"0000FF\",\"type\":\"ABS\",\"min_temp\":\"240\",\"max_temp\":\"260\",\"brand\":\"Generic\"}" },
+    { "delay": 3000, "action": "write",
+      "payload": "{\"sm_id\":\"13\",\"color_hex\":\"FFFFFF\",\"type\":\"ABS\",\"min_temp\":\"240\",\"max_temp\":\"260\",\"brand\":\"Generic\"}" },
+    { "delay": 6000, "action": "remove" }
+  ]
+})";
+
+static std::mutex resultsMutex;
+static std::vector<Pn532SimResult> results;
+
+// Runs on the RFID and write tasks
+static void collectResult(const Pn532SimResult& result) {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    results.push_back(result);
+}
+
+static size_t resultCount() {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return results.size();
+}
+
+static bool readFile(const char* path, std::string& contents) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    char chunk[4096];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.append(chunk, length);
+    }
+    fclose(file);
+    return true;
+}
+
+// Results the scenario will produce: one per place and write step
+static size_t expectedResults(const char* scenario) {
+    JsonDocument doc;
+    if (deserializeJson(doc, scenario)) return 0;
+    size_t count = 0;
+    for (JsonObjectConst step : doc["steps"].as<JsonArrayConst>()) {
+        String action = step["action"] | "";
+        if (action == "place" || action == "write") count++;
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    std::string scenario = benchScenario;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            serialOutput = stdout;
+        } else {
+            scenario.clear();
+            if (!readFile(argv[i], scenario)) {
+                fprintf(stderr, "%s: cannot read\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    size_t expected = expectedResults(scenario.c_str());
+    if (expected == 0) {
+        fprintf(stderr, "scenario has no place or write steps\n");
+        return 1;
+    }
+
+    pn532SimSetScenario(scenario.c_str());
+    pn532SimSetResultCallback(collectResult);
+    initEvents();
+    startNfc();
+
+    // Nobody else reads the events here, keep the queue from filling up
+    unsigned long startMs = millis();
+    while (resultCount() < expected && millis() - startMs < SIM_BENCH_TIMEOUT_MS) {
+        AppEvent event;
+        waitForEvent(event, 100);
+    }
+
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    printf("%-8s %-5s %-6s | %10s | %11s %7s %7s\n",
+           "tag", "step", "result", "elapsed ms", "nfc ms", "written", "skipped");
+    for (const Pn532SimResult& result : results) {
+        if (result.write) {
+            printf("NTAG%-4u %-5s %-6s | %10lu | %11lu %7u %7u\n", result.tagType, "write",
+                   result.success ? "ok" : "FAILED", result.elapsedMs, result.ntagWriteMs,
+                   result.pagesWritten, result.pagesSkipped);
+        } else {
+            printf("NTAG%-4u %-5s %-6s | %10lu | %11lu %7s %7s\n", result.tagType, "read",
+                   "ok", result.elapsedMs, result.tagReadMs, "-", "-");
+        }
+    }
+    bool complete = results.size() == expected;
+    if (!complete) {
+        printf("timed out after %lu ms, %zu of %zu results\n", SIM_BENCH_TIMEOUT_MS, results.size(), expected);
+    }
+    // The RFID task threads never end, leave without running destructors
+    fflush(stdout);
+    _exit(complete ? 0 : 1);
+}
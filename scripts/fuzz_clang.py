@@ -0,0 +1,8 @@
+Import("env")
+
+# libFuzzer targets: clang with fuzzer, address and undefined behaviour
+# sanitizers, applied to compiling and linking alike
+sanitizers = "-fsanitize=fuzzer,address,undefined"
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+env.Append(CCFLAGS=[sanitizers, "-fno-sanitize-recover=undefined", "-g"], LINKFLAGS=[sanitizers])
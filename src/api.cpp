@@ -8,25 +8,30 @@
 #include "scale.h"
 #include "nfc.h"
 #include "openprinttag.h"
+#include "events.h"
+#include "scantrace.h"
+#include "httppool.h"
+#include "spoolmirror.h"
+#include "journal.h"
+#include "brandcache.h"
 #include <time.h>
 volatile spoolmanApiStateType spoolmanApiState = API_IDLE;
 
 //bool spoolman_connected = false;
 String spoolmanUrl = "";
 bool octoEnabled = false;
-bool sendOctoUpdate = false;
 String octoUrl = "";
 String octoToken = "";
 uint16_t remainingWeight = 0;
-uint16_t createdVendorId = 0;  // Store ID of newly created vendor
-uint16_t foundVendorId = 0;    // Store ID of found vendor
-uint16_t foundFilamentId = 0;  // Store ID of found filament
-uint16_t createdFilamentId = 0;  // Store ID of newly created filament
-uint16_t createdSpoolId = 0;  // Store ID of newly created spool
 uint16_t updateOctoSpoolId = 0; // Store spool ID for OctoPrint update
 bool spoolmanConnected = false;
 bool spoolmanExtraFieldsChecked = false;
-TaskHandle_t* apiTask;
+
+static QueueHandle_t apiQueueHigh = NULL;
+static QueueHandle_t apiQueueLow = NULL;
+static SemaphoreHandle_t apiPending = NULL;    // counts queued requests
+static SemaphoreHandle_t apiBusy = NULL;       // held while a request or health check runs
+static TaskHandle_t apiWorkerHandle = NULL;
 
 // Moonraker/Klipper integration
 bool moonrakerEnabled = false;
@@ -39,6 +44,98 @@ String printFarmerUrl = "";
 String printFarmerApiKey = "";
 String printFarmerPrinterId = "";
 
+// Result of a queued request that the caller waits for. Caller and API worker
+// each hold a reference; whoever lets go last frees it, so a caller that timed
+// out or cancelled can return while the request is still queued or running.
+struct ApiFuture {
+    SemaphoreHandle_t done;
+    bool success;
+    bool cancelled;             // not yet sent requests are skipped
+    bool rejected;              // Spoolman refused it with a client error
+    uint8_t refs;
+    uint16_t id;                // found or created vendor/filament/spool, 0 if none
+    uint16_t vendorId;          // vendor of a found filament
+};
+
+// Whole brand-filament onboarding, including the lookup once more after a
+// refused cached ID; one request takes up to three attempts of 10 s
+#define API_ONBOARDING_TIMEOUT_MS   60000
+
+enum ApiFutureStatus {
+    API_FUTURE_FOUND,
+    API_FUTURE_NOT_FOUND,       // answered without a matching vendor/filament
+    API_FUTURE_FAILED           // HTTP error, dropped request or deadline passed
+};
+
+static portMUX_TYPE apiFutureMux = portMUX_INITIALIZER_UNLOCKED;
+
+static ApiFuture* newApiFuture() {
+    ApiFuture* future = new ApiFuture();
+    future->done = xSemaphoreCreateBinary();
+    future->refs = 2;
+    return future;
+}
+
+static void releaseApiFuture(ApiFuture* future) {
+    portENTER_CRITICAL(&apiFutureMux);
+    bool last = --future->refs == 0;
+    portEXIT_CRITICAL(&apiFutureMux);
+    if (last) {
+        vSemaphoreDelete(future->done);
+        delete future;
+    }
+}
+
+static bool apiFutureCancelled(ApiFuture* future) {
+    portENTER_CRITICAL(&apiFutureMux);
+    bool cancelled = future->cancelled;
+    portEXIT_CRITICAL(&apiFutureMux);
+    return cancelled;
+}
+
+// Worker side
+static void completeApiFuture(ApiFuture* future, bool success, uint16_t id, uint16_t vendorId) {
+    future->success = success;
+    future->id = success ? id : 0;
+    future->vendorId = vendorId;
+    xSemaphoreGive(future->done);
+    releaseApiFuture(future);
+}
+
+// Caller side: drops a result nobody waits for anymore
+static void cancelApiFuture(ApiFuture* future) {
+    if (future == nullptr) return;
+    portENTER_CRITICAL(&apiFutureMux);
+    future->cancelled = true;
+    portEXIT_CRITICAL(&apiFutureMux);
+    releaseApiFuture(future);
+}
+
+// Caller side: waits until deadline (millis()) for the resulting ID, which is
+// 0 unless the status is API_FUTURE_FOUND
+static ApiFutureStatus awaitApiFuture(ApiFuture* future, unsigned long deadline, uint16_t& id,
+                                      uint16_t* vendorId = nullptr, bool* rejected = nullptr) {
+    id = 0;
+    if (future == nullptr) return API_FUTURE_FAILED;
+
+    long remaining = (long)(deadline - millis());
+    TickType_t wait = remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+    if (xSemaphoreTake(future->done, wait) != pdTRUE) {
+        Serial.println("Error: API request timed out.");
+        cancelApiFuture(future);
+        return API_FUTURE_FAILED;
+    }
+
+    bool success = future->success;
+    id = future->id;
+    if (vendorId) *vendorId = future->vendorId;
+    if (rejected) *rejected = future->rejected;
+    releaseApiFuture(future);
+
+    if (!success) return API_FUTURE_FAILED;
+    return id != 0 ? API_FUTURE_FOUND : API_FUTURE_NOT_FOUND;
+}
+
 struct SendToApiParams {
     SpoolmanApiRequestType requestType;
     String httpType;
@@ -49,86 +146,87 @@ struct SendToApiParams {
     bool triggerWeightUpdate;
     String spoolIdForWeight;
     uint16_t weightValue;
+    ApiDoneCallback onDone;
+    void* doneContext;
+    ApiFuture* future;
+    uint32_t journalSeq;        // journal entry of the update, 0 if none
+    uint32_t weightJournalSeq;  // journal entry of the weight follow-up
+    bool replay;                // journal entry sent by the flusher
+    bool traced;                // ends the running scan trace
 };
 
 JsonDocument fetchSingleSpoolInfo(int spoolId) {
-    HTTPClient http;
+    JsonDocument filteredDoc;
+    SpoolMirrorEntry entry;
+
+    // Answered from the local mirror when the spool is known
+    if (spoolMirrorFind(spoolId, entry)) {
+        spoolMirrorEntryToJson(entry, filteredDoc);
+        return filteredDoc;
+    }
+
     String spoolsUrl = spoolmanUrl + apiUrl + "/spool/" + spoolId;
 
     Serial.print("Rufe Spool-Daten von: ");
     Serial.println(spoolsUrl);
 
-    http.begin(spoolsUrl);
-    int httpCode = http.GET();
+    HttpPoolLease lease(spoolsUrl);
+    int httpCode = lease.send("GET");
 
-    JsonDocument filteredDoc;
     if (httpCode == HTTP_CODE_OK) {
-        String payload = http.getString();
+        HEAP_DEBUG_MESSAGE("fetchSingleSpoolInfo parse");
+        JsonDocument filter;
+        spoolMirrorSpoolFilter(filter.to<JsonObject>());
         JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
+        DeserializationError error = lease.readJson(doc, &filter);
         if (error) {
             Serial.print("Error parsing JSON response: ");
             Serial.println(error.c_str());
-        } else {
-            String filamentType = doc["filament"]["material"].as<String>();
-            String filamentBrand = doc["filament"]["vendor"]["name"].as<String>();
-
-            int nozzle_temp_min = 0;
-            int nozzle_temp_max = 0;
-            if (doc["filament"]["extra"]["nozzle_temperature"].is<String>()) {
-                String tempString = doc["filament"]["extra"]["nozzle_temperature"].as<String>();
-                tempString.replace("[", "");
-                tempString.replace("]", "");
-                int commaIndex = tempString.indexOf(',');
-                
-                if (commaIndex != -1) {
-                    nozzle_temp_min = tempString.substring(0, commaIndex).toInt();
-                    nozzle_temp_max = tempString.substring(commaIndex + 1).toInt();
-                }
-            } 
-
-            String filamentColor = doc["filament"]["color_hex"].as<String>();
-            filamentColor.toUpperCase();
-
-            String tray_info_idx = doc["filament"]["extra"]["bambu_idx"].as<String>();
-            tray_info_idx.replace("\"", "");
-            
-            String cali_idx = doc["filament"]["extra"]["bambu_cali_id"].as<String>(); // "\"153\""
-            cali_idx.replace("\"", "");
-            
-            String bambu_setting_id = doc["filament"]["extra"]["bambu_setting_id"].as<String>(); // "\"PFUSf40e9953b40d3d\""
-            bambu_setting_id.replace("\"", "");
-
+        } else if (spoolMirrorParseSpool(doc, entry)) {
             doc.clear();
-
-            filteredDoc["color"] = filamentColor;
-            filteredDoc["type"] = filamentType;
-            filteredDoc["nozzle_temp_min"] = nozzle_temp_min;
-            filteredDoc["nozzle_temp_max"] = nozzle_temp_max;
-            filteredDoc["brand"] = filamentBrand;
-            filteredDoc["tray_info_idx"] = tray_info_idx;
-            filteredDoc["cali_idx"] = cali_idx;
-            filteredDoc["bambu_setting_id"] = bambu_setting_id;
+            spoolMirrorStore(entry);
+            spoolMirrorEntryToJson(entry, filteredDoc);
         }
     } else {
         Serial.print("Error fetching spool data. HTTP code: ");
         Serial.println(httpCode);
     }
 
-    http.end();
     return filteredDoc;
 }
 
-void sendToApi(void *parameter) {
-    HEAP_DEBUG_MESSAGE("sendToApi begin");
-
-    // Wait until API is IDLE
-    while(spoolmanApiState != API_IDLE){
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-        yield();
+// Fields of the Spoolman answer each request type reads
+static void buildResponseFilter(SpoolmanApiRequestType requestType, JsonDocument& filter) {
+    switch (requestType) {
+    case API_REQUEST_VENDOR_CHECK:
+        filter.add<JsonObject>()["id"] = true;
+        break;
+    case API_REQUEST_FILAMENT_CHECK: {
+        JsonObject filament = filter.add<JsonObject>();
+        filament["id"] = true;
+        filament["vendor"]["id"] = true;
+        break;
+    }
+    case API_REQUEST_VENDOR_CREATE:
+    case API_REQUEST_FILAMENT_CREATE:
+    case API_REQUEST_SPOOL_CREATE:
+        filter["id"] = true;
+        break;
+    case API_REQUEST_BAMBU_UPDATE:
+        spoolMirrorFilamentFilter(filter.to<JsonObject>());
+        break;
+    case API_REQUEST_OCTO_SPOOL_UPDATE:
+        filter.set(false);
+        break;
+    default:
+        // Spool updates answer with the spool
+        spoolMirrorSpoolFilter(filter.to<JsonObject>());
+        break;
     }
-    spoolmanApiState = API_TRANSMITTING;
-    SendToApiParams* params = (SendToApiParams*)parameter;
+}
+
+static void sendToApi(SendToApiParams* params) {
+    HEAP_DEBUG_MESSAGE("sendToApi begin");
 
     // Extract values including weight update parameters
     SpoolmanApiRequestType requestType = params->requestType;
@@ -146,30 +244,39 @@ void sendToApi(void *parameter) {
     const uint16_t HTTP_TIMEOUT_MS = 10000; // 10 second HTTP timeout
     
     bool success = false;
+    bool rejected = false;          // client error, retrying will not help
+    bool octoUpdate = false;
     int httpCode = -1;
-    String responsePayload = "";
+    uint16_t resultId = 0;          // found or created vendor/filament/spool
+    uint16_t resultVendorId = 0;    // vendor of a found filament
+    JsonDocument doc;               // filtered response
+    DeserializationError error = DeserializationError::Ok;
+    JsonDocument filter;
+    buildResponseFilter(requestType, filter);
     
+    // A journaled update is replayed later anyway, no retries while Spoolman is down
+    const uint8_t attempts = (params->journalSeq && !spoolmanConnected) ? 1 : MAX_RETRIES;
+
     // Try request with retries
-    for (uint8_t attempt = 1; attempt <= MAX_RETRIES && !success; attempt++) {
-        Serial.printf("API Request attempt %d/%d to: %s\n", attempt, MAX_RETRIES, spoolsUrl.c_str());
+    for (uint8_t attempt = 1; attempt <= attempts && !success; attempt++) {
+        Serial.printf("API Request attempt %d/%d to: %s\n", attempt, attempts, spoolsUrl.c_str());
         
-        HTTPClient http;
-        http.setReuse(false);
-        http.setTimeout(HTTP_TIMEOUT_MS); // Set HTTP timeout
-        
-        http.begin(spoolsUrl);
+        // Keep-alive connection from the pool, reconnects if the server closed it
+        HttpPoolLease lease(spoolsUrl, HTTP_TIMEOUT_MS);
+        HTTPClient& http = lease.http();
         http.addHeader("Content-Type", "application/json");
         if (octoEnabled && octoToken != "") http.addHeader("X-Api-Key", octoToken);
 
         // Execute HTTP request based on type
-        if (httpType == "PATCH") httpCode = http.PATCH(updatePayload);
-        else if (httpType == "POST") httpCode = http.POST(updatePayload);
-        else if (httpType == "GET") httpCode = http.GET();
-        else httpCode = http.PUT(updatePayload);
+        if (httpType == "PATCH") httpCode = lease.send("PATCH", updatePayload);
+        else if (httpType == "POST") httpCode = lease.send("POST", updatePayload);
+        else if (httpType == "GET") httpCode = lease.send("GET");
+        else httpCode = lease.send("PUT", updatePayload);
 
         // Check if request was successful
         if (httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_CREATED) {
-            responsePayload = http.getString();
+            HEAP_DEBUG_MESSAGE("sendToApi parse");
+            error = lease.readJson(doc, &filter);
             success = true;
             Serial.printf("API Request successful on attempt %d, HTTP Code: %d\n", attempt, httpCode);
         } else {
@@ -179,32 +286,31 @@ void sendToApi(void *parameter) {
             // Don't retry on certain error codes (client errors)
             if (httpCode >= 400 && httpCode < 500 && httpCode != 408 && httpCode != 429) {
                 Serial.println("Client error detected, stopping retries");
+                rejected = true;
                 break;
             }
             
             // Wait before retry (except on last attempt)
-            if (attempt < MAX_RETRIES) {
+            if (attempt < attempts) {
                 Serial.printf("Waiting %dms before retry...\n", RETRY_DELAY_MS);
-                http.end();
                 vTaskDelay(RETRY_DELAY_MS / portTICK_PERIOD_MS);
                 continue;
             }
         }
-        
-        http.end();
     }
 
     // Process successful response
     if (success) {
         Serial.println("Spoolman query successful");
 
-        // Read remaining spool weight
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, responsePayload);
         if (error) {
             Serial.print("Error parsing JSON response: ");
             Serial.println(error.c_str());
         } else {
+            // Spoolman answers writes with the updated object, the mirror takes it over
+            if (requestType == API_REQUEST_BAMBU_UPDATE) spoolMirrorStoreFilament(doc);
+            else if (doc["filament"].is<JsonObject>()) spoolMirrorStoreSpool(doc);
+
             switch(requestType){
             case API_REQUEST_SPOOL_WEIGHT_UPDATE:
                 remainingWeight = doc["remaining_weight"].as<uint16_t>();
@@ -218,7 +324,7 @@ void sendToApi(void *parameter) {
                     remainingWeight = 0;
                 }else{
                     // ocoto is enabled, trigger octo update
-                    sendOctoUpdate = true;
+                    octoUpdate = true;
                 }
                 break;
             case API_REQUEST_SPOOL_LOCATION_UPDATE:
@@ -235,141 +341,54 @@ void sendToApi(void *parameter) {
                 break;
             case API_REQUEST_VENDOR_CREATE:
                 Serial.println("Vendor successfully created!");
-                createdVendorId = doc["id"].as<uint16_t>();
+                resultId = doc["id"].as<uint16_t>();
                 Serial.print("Created Vendor ID: ");
-                Serial.println(createdVendorId);
+                Serial.println(resultId);
                 oledShowProgressBar(1, 1, "Vendor", "Created!");
                 break;
             case API_REQUEST_VENDOR_CHECK:
                 if (doc.isNull() || doc.size() == 0) {
                     Serial.println("Vendor not found in response");
-                    foundVendorId = 0;
+                    resultId = 0;
                 } else {
-                    foundVendorId = doc[0]["id"].as<uint16_t>();
+                    resultId = doc[0]["id"].as<uint16_t>();
                     Serial.print("Found Vendor ID: ");
-                    Serial.println(foundVendorId);
+                    Serial.println(resultId);
                 }
                 break;
             case API_REQUEST_FILAMENT_CHECK:
                 if (doc.isNull() || doc.size() == 0) {
                     Serial.println("Filament not found in response");
-                    foundFilamentId = 0;
+                    resultId = 0;
                 } else {
-                    foundFilamentId = doc[0]["id"].as<uint16_t>();
+                    resultId = doc[0]["id"].as<uint16_t>();
+                    resultVendorId = doc[0]["vendor"]["id"].as<uint16_t>();
                     Serial.print("Found Filament ID: ");
-                    Serial.println(foundFilamentId);
+                    Serial.println(resultId);
                 }
                 break;
             case API_REQUEST_FILAMENT_CREATE:
                 Serial.println("Filament successfully created!");
-                createdFilamentId = doc["id"].as<uint16_t>();
+                resultId = doc["id"].as<uint16_t>();
                 Serial.print("Created Filament ID: ");
-                Serial.println(createdFilamentId);
+                Serial.println(resultId);
                 oledShowProgressBar(1, 1, "Filament", "Created!");
                 break;
             case API_REQUEST_SPOOL_CREATE:
                 Serial.println("Spool successfully created!");
-                createdSpoolId = doc["id"].as<uint16_t>();
+                resultId = doc["id"].as<uint16_t>();
                 Serial.print("Created Spool ID: ");
-                Serial.println(createdSpoolId);
+                Serial.println(resultId);
                 oledShowProgressBar(1, 1, "Spool", "Created!");
                 break;
             }
         }
         doc.clear();
-    } else if (httpCode == HTTP_CODE_CREATED) {
-        Serial.println("Spoolman successfully created");
-        
-        // Parse response for created resources  
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, responsePayload);
-        if (error) {
-            Serial.print("Error parsing JSON response: ");
-            Serial.println(error.c_str());
-        } else {
-            switch(requestType){
-            case API_REQUEST_VENDOR_CREATE:
-                Serial.println("Vendor successfully created!");
-                createdVendorId = doc["id"].as<uint16_t>();
-                Serial.print("Created Vendor ID: ");
-                Serial.println(createdVendorId);
-                oledShowProgressBar(1, 1, "Vendor", "Created!");
-                break;
-            case API_REQUEST_FILAMENT_CREATE:
-                Serial.println("Filament successfully created!");
-                createdFilamentId = doc["id"].as<uint16_t>();
-                Serial.print("Created Filament ID: ");
-                Serial.println(createdFilamentId);
-                oledShowProgressBar(1, 1, "Filament", "Created!");
-                break;
-            case API_REQUEST_SPOOL_CREATE:
-                Serial.println("Spool successfully created!");
-                createdSpoolId = doc["id"].as<uint16_t>();
-                Serial.print("Created Spool ID: ");
-                Serial.println(createdSpoolId);
-                oledShowProgressBar(1, 1, "Spool", "Created!");
-                break;
-            default:
-                // Handle other create operations if needed
-                break;
-            }
-        }
-        doc.clear();
-
-        // Execute weight update if requested and tag update was successful
-        if (triggerWeightUpdate && requestType == API_REQUEST_SPOOL_TAG_ID_UPDATE && weightValue > 10) {
-            Serial.println("Executing weight update after successful tag update");
-            
-            // Prepare weight update request
-            String weightUrl = spoolmanUrl + apiUrl + "/spool/" + spoolIdForWeight + "/measure";
-            JsonDocument weightDoc;
-            weightDoc["weight"] = weightValue;
-            
-            String weightPayload;
-            serializeJson(weightDoc, weightPayload);
-            
-            Serial.print("Weight update URL: ");
-            Serial.println(weightUrl);
-            Serial.print("Weight update payload: ");
-            Serial.println(weightPayload);
-
-            // Execute weight update
-            HTTPClient weightHttp;
-            weightHttp.setReuse(false);
-            weightHttp.setTimeout(HTTP_TIMEOUT_MS);
-            weightHttp.begin(weightUrl);
-            weightHttp.addHeader("Content-Type", "application/json");
-            
-            int weightHttpCode = weightHttp.PUT(weightPayload);
-            
-            if (weightHttpCode == HTTP_CODE_OK) {
-                Serial.println("Weight update successful");
-                String weightResponse = weightHttp.getString();
-                JsonDocument weightResponseDoc;
-                DeserializationError weightError = deserializeJson(weightResponseDoc, weightResponse);
-                
-                if (!weightError) {
-                    remainingWeight = weightResponseDoc["remaining_weight"].as<uint16_t>();
-                    Serial.print("Updated weight: ");
-                    Serial.println(remainingWeight);
-                    
-                    if (!octoEnabled) {
-                        oledShowProgressBar(1, 1, "Spool Tag", ("Done: " + String(remainingWeight) + " g remain").c_str());
-                        remainingWeight = 0;
-                    } else {
-                        sendOctoUpdate = true;
-                    }
-                }
-                weightResponseDoc.clear();
-            } else {
-                Serial.print("Weight update failed with HTTP code: ");
-                Serial.println(weightHttpCode);
-                oledShowProgressBar(1, 1, "Failure!", "Weight update");
-            }
-            
-            weightHttp.end();
-            weightDoc.clear();
-        }
+    } else if (params->journalSeq && !rejected) {
+        Serial.println("Spoolman not reached, update stays in the journal. HTTP code: " + String(httpCode));
+        oledShowProgressBar(1, 1, "Queued", "Sent when online");
+        vTaskDelay(2000 / portTICK_PERIOD_MS);
+        nfcReaderState = NFC_IDLE;
     } else {
         switch(requestType){
         case API_REQUEST_SPOOL_WEIGHT_UPDATE:
@@ -385,23 +404,18 @@ void sendToApi(void *parameter) {
             break;
         case API_REQUEST_VENDOR_CHECK:
             oledShowProgressBar(1, 1, "Failure!", "Vendor check");
-            foundVendorId = 0; // Set to 0 to indicate error/not found
             break;
         case API_REQUEST_VENDOR_CREATE:
             oledShowProgressBar(1, 1, "Failure!", "Vendor create");
-            createdVendorId = 0; // Set to 0 to indicate error
             break;
         case API_REQUEST_FILAMENT_CHECK:
             oledShowProgressBar(1, 1, "Failure!", "Filament check");
-            foundFilamentId = 0; // Set to 0 to indicate error/not found
             break;
         case API_REQUEST_FILAMENT_CREATE:
             oledShowProgressBar(1, 1, "Failure!", "Filament create");
-            createdFilamentId = 0; // Set to 0 to indicate error
             break;
         case API_REQUEST_SPOOL_CREATE:
             oledShowProgressBar(1, 1, "Failure!", "Spool create");
-            createdSpoolId = 0; // Set to 0 to indicate error instead of hanging
             break;
         }
         Serial.println("Error sending to Spoolman! HTTP code: " + String(httpCode));
@@ -409,16 +423,193 @@ void sendToApi(void *parameter) {
         nfcReaderState = NFC_IDLE; // Reset NFC state to allow retry
     }
 
-    vTaskDelay(50 / portTICK_PERIOD_MS);
+    // Execute weight update if requested and tag update was successful (the PATCH answers 200)
+    if (success && triggerWeightUpdate && requestType == API_REQUEST_SPOOL_TAG_ID_UPDATE && weightValue > 10) {
+        Serial.println("Executing weight update after successful tag update");
+        
+        // Prepare weight update request
+        String weightUrl = spoolmanUrl + apiUrl + "/spool/" + spoolIdForWeight + "/measure";
+        JsonDocument weightDoc;
+        weightDoc["weight"] = weightValue;
+        
+        String weightPayload;
+        serializeJson(weightDoc, weightPayload);
+        
+        Serial.print("Weight update URL: ");
+        Serial.println(weightUrl);
+        Serial.print("Weight update payload: ");
+        Serial.println(weightPayload);
+
+        // Execute weight update, usually on the connection of the tag update
+        HttpPoolLease weightLease(weightUrl, HTTP_TIMEOUT_MS);
+        HTTPClient& weightHttp = weightLease.http();
+        weightHttp.addHeader("Content-Type", "application/json");
+        
+        int weightHttpCode = weightLease.send("PUT", weightPayload);
+        
+        if (weightHttpCode == HTTP_CODE_OK) {
+            Serial.println("Weight update successful");
+            journalAck(params->weightJournalSeq);
+            JsonDocument weightResponseDoc;
+            DeserializationError weightError = weightLease.readJson(weightResponseDoc, &filter);
+            
+            if (!weightError) {
+                spoolMirrorStoreSpool(weightResponseDoc);
+                remainingWeight = weightResponseDoc["remaining_weight"].as<uint16_t>();
+                Serial.print("Updated weight: ");
+                Serial.println(remainingWeight);
+                
+                if (!octoEnabled) {
+                    oledShowProgressBar(1, 1, "Spool Tag", ("Done: " + String(remainingWeight) + " g remain").c_str());
+                    remainingWeight = 0;
+                } else {
+                    octoUpdate = true;
+                }
+            }
+            weightResponseDoc.clear();
+        } else {
+            Serial.print("Weight update failed with HTTP code: ");
+            Serial.println(weightHttpCode);
+            oledShowProgressBar(1, 1, "Failure!", "Weight update");
+        }
+        
+        weightDoc.clear();
+    }
+
+    // Accepted or refused for good leaves the journal, anything else is replayed
+    if (success || rejected) journalAck(params->journalSeq);
+    else journalRelease(params->journalSeq);
+    journalRelease(params->weightJournalSeq);
 
-    // Free memory
-    delete params;
     HEAP_DEBUG_MESSAGE("sendToApi end");
-    spoolmanApiState = API_IDLE;
-    vTaskDelete(NULL);
+    if (params->traced) scanTraceFinish(success);
+    if (params->onDone) params->onDone(requestType, success, params->doneContext);
+    if (params->future) {
+        params->future->rejected = rejected;
+        completeApiFuture(params->future, success, resultId, resultVendorId);
+    }
+    postApiResult(requestType, success);
+
+    // OctoPrint follows the weight update, queued behind anything already waiting
+    if (octoUpdate) updateSpoolOcto(updateOctoSpoolId);
+}
+
+// Sends a journal entry as it was recorded, unless a newer one replaced it meanwhile
+static void replayJournalEntry(SendToApiParams* params) {
+    SpoolmanApiRequestType requestType;
+    String method;
+    String path;
+    String payload;
+    bool success = false;
+
+    if (journalIsCurrent(params->journalSeq) &&
+        journalRead(params->journalSeq, requestType, method, path, payload)) {
+        String url = spoolmanUrl + apiUrl + path;
+        Serial.printf("Journal replay %lu: %s %s\n", (unsigned long)params->journalSeq, method.c_str(), url.c_str());
+
+        HttpPoolLease lease(url, 10000);
+        HTTPClient& http = lease.http();
+        http.addHeader("Content-Type", "application/json");
+        int httpCode = lease.send(method.c_str(), payload);
+
+        if (httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_CREATED) {
+            JsonDocument filter;
+            buildResponseFilter(requestType, filter);
+            JsonDocument doc;
+            if (!lease.readJson(doc, &filter)) {
+                if (requestType == API_REQUEST_BAMBU_UPDATE) spoolMirrorStoreFilament(doc);
+                else spoolMirrorStoreSpool(doc);
+            }
+            success = true;
+        } else if (httpCode >= 400 && httpCode < 500 && httpCode != 408 && httpCode != 429) {
+            // Spool or filament gone, dropped
+            Serial.printf("Journal replay rejected, HTTP code: %d\n", httpCode);
+            success = true;
+        } else {
+            Serial.printf("Journal replay failed, HTTP code: %d\n", httpCode);
+        }
+    } else {
+        // Replaced or acked meanwhile, nothing to send
+        success = true;
+    }
+
+    if (success) journalAck(params->journalSeq);
+    else journalRelease(params->journalSeq);
+    if (params->onDone) params->onDone(params->requestType, success, params->doneContext);
+}
+
+static void apiWorkerTask(void *parameter) {
+    SendToApiParams* params = nullptr;
+    for (;;) {
+        xSemaphoreTake(apiPending, portMAX_DELAY);
+        if (xQueueReceive(apiQueueHigh, &params, 0) != pdTRUE &&
+            xQueueReceive(apiQueueLow, &params, 0) != pdTRUE) {
+            continue;
+        }
+
+        if (params->future && apiFutureCancelled(params->future)) {
+            completeApiFuture(params->future, false, 0, 0);
+            delete params;
+            continue;
+        }
+
+        xSemaphoreTake(apiBusy, portMAX_DELAY);
+        spoolmanApiState = API_TRANSMITTING;
+        if (params->replay) replayJournalEntry(params);
+        else sendToApi(params);
+        delete params;
+        spoolmanApiState = API_IDLE;
+        xSemaphoreGive(apiBusy);
+    }
+}
+
+void initApiWorker() {
+    if (apiWorkerHandle != NULL) return;
+    apiQueueHigh = xQueueCreate(API_QUEUE_LENGTH, sizeof(SendToApiParams*));
+    apiQueueLow = xQueueCreate(API_QUEUE_LENGTH, sizeof(SendToApiParams*));
+    apiPending = xSemaphoreCreateCounting(2 * API_QUEUE_LENGTH, 0);
+    apiBusy = xSemaphoreCreateMutex();
+
+    // Stack sized for the tag update with its weight follow-up
+    xTaskCreate(apiWorkerTask, "ApiWorkerTask", 8192, NULL, 0, &apiWorkerHandle);
 }
 
-bool updateSpoolTagId(String uidString, const char* payload) {
+// Hands the request to the worker, which deletes it. When the queue is full
+// the caller waits for room; the worker itself never waits on its own queue.
+static bool enqueueApiRequest(SendToApiParams* params, ApiPriority priority = API_PRIORITY_HIGH) {
+    QueueHandle_t queue = (priority == API_PRIORITY_HIGH) ? apiQueueHigh : apiQueueLow;
+    TickType_t wait = (xTaskGetCurrentTaskHandle() == apiWorkerHandle) ? 0 : pdMS_TO_TICKS(API_QUEUE_WAIT_MS);
+
+    if (queue == NULL || xQueueSend(queue, &params, wait) != pdTRUE) {
+        Serial.println("Error: API queue full, request dropped.");
+        if (params->future) completeApiFuture(params->future, false, 0, 0);
+        journalRelease(params->journalSeq);
+        journalRelease(params->weightJournalSeq);
+        delete params;
+        return false;
+    }
+    xSemaphoreGive(apiPending);
+    return true;
+}
+
+bool queueJournalReplay(uint32_t seq, ApiDoneCallback onDone, void* doneContext) {
+    SendToApiParams* params = new SendToApiParams();
+    if (params == nullptr) {
+        journalRelease(seq);
+        return false;
+    }
+    params->requestType = API_REQUEST_SPOOL_WEIGHT_UPDATE;  // read from the journal when sent
+    params->journalSeq = seq;
+    params->replay = true;
+    params->onDone = onDone;
+    params->doneContext = doneContext;
+
+    // Behind everything the user is waiting for
+    return enqueueApiRequest(params, API_PRIORITY_LOW);
+}
+
+bool updateSpoolTagId(String uidString, const char* payload, uint16_t weightValue,
+                      ApiPriority priority, ApiDoneCallback onDone, void* doneContext) {
     oledShowProgressBar(2, 3, "Write Tag", "Update Spoolman");
 
     JsonDocument doc;
@@ -437,7 +628,8 @@ bool updateSpoolTagId(String uidString, const char* payload) {
     }
 
     String spoolId = doc["sm_id"].as<String>();
-    String spoolsUrl = spoolmanUrl + apiUrl + "/spool/" + spoolId;
+    String path = "/spool/" + spoolId;
+    String spoolsUrl = spoolmanUrl + apiUrl + path;
     Serial.print("Update spool with URL: ");
     Serial.println(spoolsUrl);
     
@@ -463,32 +655,30 @@ bool updateSpoolTagId(String uidString, const char* payload) {
     params->updatePayload = updatePayload;
     
     // Add weight update parameters for sequential execution
-    params->triggerWeightUpdate = (weight > 10);
+    params->triggerWeightUpdate = (weightValue > 10);
     params->spoolIdForWeight = spoolId;
-    params->weightValue = weight;
-
-    // Create task with increased stack size for additional HTTP request
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        8192,                     // Increased stack size for additional HTTP request
-        (void*)params,            // Parameter
-        0,                        // Priority
-        apiTask                   // Task handle (not needed)
-    );
+    params->weightValue = weightValue;
+    params->onDone = onDone;
+    params->doneContext = doneContext;
 
-    updateDoc.clear();
+    params->journalSeq = journalAppend(API_REQUEST_SPOOL_TAG_ID_UPDATE, spoolId.toInt(), "PATCH", path, updatePayload);
+    if (params->triggerWeightUpdate) {
+        String weightPayload = "{\"weight\":" + String(weightValue) + "}";
+        params->weightJournalSeq = journalAppend(API_REQUEST_SPOOL_WEIGHT_UPDATE, spoolId.toInt(), "PUT",
+                                                 path + "/measure", weightPayload);
+    }
 
-    // Update Spool weight now handled sequentially in sendToApi task
-    // to prevent parallel API access issues
+    updateDoc.clear();
 
-    return true;
+    // The weight follows in the same request on the API worker
+    return enqueueApiRequest(params, priority);
 }
 
-uint8_t updateSpoolWeight(String spoolId, uint16_t weight) {
+uint8_t updateSpoolWeight(String spoolId, uint16_t weight, bool traced) {
     HEAP_DEBUG_MESSAGE("updateSpoolWeight begin");
     oledShowProgressBar(3, octoEnabled?5:4, "Spool Tag", "Spoolman update");
-    String spoolsUrl = spoolmanUrl + apiUrl + "/spool/" + spoolId + "/measure";
+    String path = "/spool/" + spoolId + "/measure";
+    String spoolsUrl = spoolmanUrl + apiUrl + path;
     Serial.print("Update spool with URL: ");
     Serial.println(spoolsUrl);
 
@@ -511,21 +701,14 @@ uint8_t updateSpoolWeight(String spoolId, uint16_t weight) {
     params->httpType = "PUT";
     params->spoolsUrl = spoolsUrl;
     params->updatePayload = updatePayload;
-
-    // Create task
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        apiTask                      // Task handle (not needed)
-    );
+    params->journalSeq = journalAppend(API_REQUEST_SPOOL_WEIGHT_UPDATE, spoolId.toInt(), "PUT", path, updatePayload);
+    params->traced = traced;
 
     updateDoc.clear();
+    bool queued = enqueueApiRequest(params);
     HEAP_DEBUG_MESSAGE("updateSpoolWeight end");
 
-    return 1;
+    return queued ? 1 : 0;
 }
 
 uint8_t updateSpoolLocation(String spoolId, String location){
@@ -533,7 +716,8 @@ uint8_t updateSpoolLocation(String spoolId, String location){
 
     oledShowProgressBar(3, octoEnabled?5:4, "Loc. Tag", "Spoolman update");
 
-    String spoolsUrl = spoolmanUrl + apiUrl + "/spool/" + spoolId;
+    String path = "/spool/" + spoolId;
+    String spoolsUrl = spoolmanUrl + apiUrl + path;
     Serial.print("Update spool with URL: ");
     Serial.println(spoolsUrl);
 
@@ -555,26 +739,13 @@ uint8_t updateSpoolLocation(String spoolId, String location){
     params->httpType = "PATCH";
     params->spoolsUrl = spoolsUrl;
     params->updatePayload = updatePayload;
-
-
-    if(apiTask == nullptr){
-        // Create task
-        BaseType_t result = xTaskCreate(
-            sendToApi,                // Task-Funktion
-            "SendToApiTask",          // Task-Name
-            6144,                     // Stack size in bytes
-            (void*)params,            // Parameter
-            0,                        // Priority
-            apiTask                   // Task-Handle
-        );
-    }else{
-        Serial.println("Not spawning new task, API still active!");
-    }
+    params->journalSeq = journalAppend(API_REQUEST_SPOOL_LOCATION_UPDATE, spoolId.toInt(), "PATCH", path, updatePayload);
 
     updateDoc.clear();
+    bool queued = enqueueApiRequest(params);
 
     HEAP_DEBUG_MESSAGE("updateSpoolLocation end");
-    return 1;
+    return queued ? 1 : 0;
 }
 
 bool updateSpoolOcto(int spoolId) {
@@ -604,19 +775,9 @@ bool updateSpoolOcto(int spoolId) {
     params->updatePayload = updatePayload;
     params->octoToken = octoToken;
 
-    // Create task
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        apiTask                      // Task handle (not needed)
-    );
-
     updateDoc.clear();
 
-    return true;
+    return enqueueApiRequest(params);
 }
 
 bool updateSpoolBambuData(String payload) {
@@ -628,7 +789,9 @@ bool updateSpoolBambuData(String payload) {
         return false;
     }
 
-    String spoolsUrl = spoolmanUrl + apiUrl + "/filament/" + doc["filament_id"].as<String>();
+    uint16_t filamentId = doc["filament_id"].as<uint16_t>();
+    String path = "/filament/" + String(filamentId);
+    String spoolsUrl = spoolmanUrl + apiUrl + path;
     Serial.print("Update spool with URL: ");
     Serial.println(spoolsUrl);
 
@@ -656,29 +819,62 @@ bool updateSpoolBambuData(String payload) {
     params->httpType = "PATCH";
     params->spoolsUrl = spoolsUrl;
     params->updatePayload = updatePayload;
+    params->journalSeq = journalAppend(API_REQUEST_BAMBU_UPDATE, filamentId, "PATCH", path, updatePayload);
 
-    // Create task
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        apiTask                      // Task handle (not needed)
-    );
-
-    return true;
+    // Printer settings are not time critical
+    return enqueueApiRequest(params, API_PRIORITY_LOW);
 }
 
 // #### Brand Filament
-uint16_t createVendor(const JsonDocument& payload) {
+// Queues a request whose result the caller awaits
+static ApiFuture* queueApiLookup(SpoolmanApiRequestType requestType, const char* httpType,
+                                 const String& url, const String& payload) {
+    SendToApiParams* params = new SendToApiParams();
+    if (params == nullptr) {
+        Serial.println("Error: Cannot allocate memory for task parameters.");
+        return nullptr;
+    }
+    ApiFuture* future = newApiFuture();
+    params->requestType = requestType;
+    params->httpType = httpType;
+    params->spoolsUrl = url;
+    params->updatePayload = payload;
+    params->future = future;
+
+    // A dropped request completes the future as failed
+    enqueueApiRequest(params);
+    return future;
+}
+
+static String urlQueryValue(String value) {
+    value.trim();
+    value.replace(" ", "+");
+    return value;
+}
+
+static ApiFuture* queueVendorCheck(const JsonDocument& payload) {
+    String spoolsUrl = spoolmanUrl + apiUrl + "/vendor?name=" + urlQueryValue(payload["b"].as<String>());
+    Serial.print("Check vendor with URL: ");
+    Serial.println(spoolsUrl);
+
+    return queueApiLookup(API_REQUEST_VENDOR_CHECK, "GET", spoolsUrl, "");
+}
+
+// Looked up by vendor name, so it does not have to wait for the vendor ID
+static ApiFuture* queueFilamentCheck(const JsonDocument& payload) {
+    if (!payload["an"].is<String>()) return nullptr;
+
+    String spoolsUrl = spoolmanUrl + apiUrl + "/filament?vendor.name=" + urlQueryValue(payload["b"].as<String>()) +
+                       "&external_id=" + urlQueryValue(payload["an"].as<String>());
+    Serial.print("Check filament with URL: ");
+    Serial.println(spoolsUrl);
+
+    return queueApiLookup(API_REQUEST_FILAMENT_CHECK, "GET", spoolsUrl, "");
+}
+
+uint16_t createVendor(const JsonDocument& payload, unsigned long deadline) {
     oledShowProgressBar(2, 5, "New Brand", "Create new Vendor");
 
-    // Create new vendor in Spoolman database using task system
-    // Note: Due to async nature, the ID will be stored in createdVendorId global variable
-    // Note: This function assumes that the caller has already ensured API is IDLE
-    createdVendorId = 65535; // Reset previous value
-    
     String spoolsUrl = spoolmanUrl + apiUrl + "/vendor";
     Serial.print("Create vendor with URL: ");
     Serial.println(spoolsUrl);
@@ -708,121 +904,17 @@ uint16_t createVendor(const JsonDocument& payload) {
     serializeJson(vendorDoc, vendorPayload);
     Serial.print("Vendor Payload: ");
     Serial.println(vendorPayload);
-
-    SendToApiParams* params = new SendToApiParams();
-    if (params == nullptr) {
-        Serial.println("Error: Cannot allocate memory for task parameters.");
-        vendorDoc.clear();
-        return 0;
-    }
-    params->requestType = API_REQUEST_VENDOR_CREATE;
-    params->httpType = "POST";
-    params->spoolsUrl = spoolsUrl;
-    params->updatePayload = vendorPayload;
-
-    // Create task without additional API state check since caller ensures synchronization
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        NULL                      // Task handle (not needed)
-    );
-
-    if (result != pdPASS) {
-        Serial.println("Failed to create vendor task!");
-        delete params;
-        vendorDoc.clear();
-        return 0;
-    }
-
     vendorDoc.clear();
-    
-    // Delay for Display Bar
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
 
-    // Wait for task completion and return the created vendor ID
-    // Note: createdVendorId will be set by sendToApi when response is received
-    while(createdVendorId == 65535) {
-        vTaskDelay(50 / portTICK_PERIOD_MS);
-    }
-    
-    return createdVendorId;
+    uint16_t vendorId;
+    awaitApiFuture(queueApiLookup(API_REQUEST_VENDOR_CREATE, "POST", spoolsUrl, vendorPayload), deadline, vendorId);
+    return vendorId;
 }
 
-uint16_t checkVendor(const JsonDocument& payload) {
-    oledShowProgressBar(1, 5, "New Brand", "Check Vendor");
-
-    // Check if vendor exists using task system
-    foundVendorId = 65535; // Reset to invalid value to detect when API response is received
-    
-    String vendorName = payload["b"].as<String>();
-    vendorName.trim();
-    vendorName.replace(" ", "+");
-    String spoolsUrl = spoolmanUrl + apiUrl + "/vendor?name=" + vendorName;
-    Serial.print("Check vendor with URL: ");
-    Serial.println(spoolsUrl);
-
-    SendToApiParams* params = new SendToApiParams();
-    if (params == nullptr) {
-        Serial.println("Error: Cannot allocate memory for task parameters.");
-        return 0;
-    }
-    params->requestType = API_REQUEST_VENDOR_CHECK;
-    params->httpType = "GET";
-    params->spoolsUrl = spoolsUrl;
-    params->updatePayload = ""; // Empty for GET request
-
-    // Check if API is idle before creating task
-    while (spoolmanApiState != API_IDLE)
-    {
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-    }
-    
-    // Create task
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        NULL                      // Task handle (not needed)
-    );
-    
-    // Wait until foundVendorId is updated by the API response (not 65535 anymore)
-    while (foundVendorId == 65535)
-    {
-        vTaskDelay(50 / portTICK_PERIOD_MS);
-    }
-
-    // Check if vendor was found
-    if (foundVendorId == 0) {
-        Serial.println("Vendor not found, creating new vendor...");
-        uint16_t vendorId = createVendor(payload);
-        if (vendorId == 0) {
-            Serial.println("Failed to create vendor, returning 0.");
-            return 0; // Failed to create vendor
-        } else {
-            Serial.println("Vendor created with ID: " + String(vendorId));
-            return vendorId;
-        }
-    } else {
-        Serial.println("Vendor found: " + payload["b"].as<String>());
-        Serial.print("Vendor ID: ");
-        Serial.println(foundVendorId);
-        return foundVendorId;
-    }
-}
-
-uint16_t createFilament(uint16_t vendorId, const JsonDocument& payload) {
+uint16_t createFilament(uint16_t vendorId, const JsonDocument& payload, unsigned long deadline,
+                        bool* rejected = nullptr) {
     oledShowProgressBar(4, 5, "New Brand", "Create Filament");
 
-    // Create new filament in Spoolman database using task system
-    // Note: Due to async nature, the ID will be stored in createdFilamentId global variable
-    // Note: This function assumes that the caller has already ensured API is IDLE
-    createdFilamentId = 65535; // Reset previous value
-    
     String spoolsUrl = spoolmanUrl + apiUrl + "/filament";
     Serial.print("Create filament with URL: ");
     Serial.println(spoolsUrl);
@@ -863,111 +955,18 @@ uint16_t createFilament(uint16_t vendorId, const JsonDocument& payload) {
     serializeJson(filamentDoc, filamentPayload);
     Serial.print("Filament Payload: ");
     Serial.println(filamentPayload);
-
-    SendToApiParams* params = new SendToApiParams();
-    if (params == nullptr) {
-        Serial.println("Error: Cannot allocate memory for task parameters.");
-        filamentDoc.clear();
-        return 0;
-    }
-    params->requestType = API_REQUEST_FILAMENT_CREATE;
-    params->httpType = "POST";
-    params->spoolsUrl = spoolsUrl;
-    params->updatePayload = filamentPayload;
-
-    // Create task without additional API state check since caller ensures synchronization
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        NULL                      // Task handle (not needed)
-    );
-
-    if (result != pdPASS) {
-        Serial.println("Failed to create filament task!");
-        delete params;
-        filamentDoc.clear();
-        return 0;
-    }
-
     filamentDoc.clear();
-    
-    // Delay for Display Bar
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
 
-    // Wait for task completion and return the created filament ID
-    // Note: createdFilamentId will be set by sendToApi when response is received
-    while(createdFilamentId == 65535) {
-        vTaskDelay(50 / portTICK_PERIOD_MS);
-    }
-    
-    return createdFilamentId;
+    uint16_t filamentId;
+    awaitApiFuture(queueApiLookup(API_REQUEST_FILAMENT_CREATE, "POST", spoolsUrl, filamentPayload), deadline,
+                   filamentId, nullptr, rejected);
+    return filamentId;
 }
 
-uint16_t checkFilament(uint16_t vendorId, const JsonDocument& payload) {
-    oledShowProgressBar(3, 5, "New Brand", "Check Filament");
-
-    // Check if filament exists using task system
-    foundFilamentId = 65535; // Reset to invalid value to detect when API response is received
-
-    String spoolsUrl = spoolmanUrl + apiUrl + "/filament?vendor.id=" + String(vendorId) + "&external_id=" + String(payload["artnr"].as<String>());
-    Serial.print("Check filament with URL: ");
-    Serial.println(spoolsUrl);
-
-    SendToApiParams* params = new SendToApiParams();
-    if (params == nullptr) {
-        Serial.println("Error: Cannot allocate memory for task parameters.");
-        return 0;
-    }
-    params->requestType = API_REQUEST_FILAMENT_CHECK;
-    params->httpType = "GET";
-    params->spoolsUrl = spoolsUrl;
-    params->updatePayload = ""; // Empty for GET request
-
-     // Create task
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        NULL                      // Task handle (not needed)
-    );
-    
-    // Wait until foundFilamentId is updated by the API response (not 65535 anymore)
-    while (foundFilamentId == 65535) {
-        vTaskDelay(50 / portTICK_PERIOD_MS);
-    }
-
-    // Check if filament was found
-    if (foundFilamentId == 0) {
-        Serial.println("Filament not found, creating new filament...");
-        uint16_t filamentId = createFilament(vendorId, payload);
-        if (filamentId == 0) {
-            Serial.println("Failed to create filament, returning 0.");
-            return 0; // Failed to create filament
-        } else {
-            Serial.println("Filament created with ID: " + String(filamentId));
-            return filamentId;
-        }
-    } else {
-        Serial.println("Filament found for vendor ID: " + String(vendorId));
-        Serial.print("Filament ID: ");
-        Serial.println(foundFilamentId);
-        return foundFilamentId;
-    }
-}
-
-uint16_t createSpool(uint16_t vendorId, uint16_t filamentId, JsonDocument& payload, String uidString) {
+uint16_t createSpool(uint16_t vendorId, uint16_t filamentId, JsonDocument& payload, String uidString,
+                     unsigned long deadline, bool* rejected = nullptr) {
     oledShowProgressBar(5, 5, "New Brand", "Create new Spool");
 
-    // Create new spool in Spoolman database using task system
-    // Note: Due to async nature, the ID will be stored in createdSpoolId global variable
-    // Note: This function assumes that the caller has already ensured API is IDLE
-    createdSpoolId = 65535; // Reset to invalid value to detect when API response is received
-    
     String spoolsUrl = spoolmanUrl + apiUrl + "/spool";
     Serial.print("Create spool with URL: ");
     Serial.println(spoolsUrl);
@@ -988,52 +987,20 @@ uint16_t createSpool(uint16_t vendorId, uint16_t filamentId, JsonDocument& paylo
     Serial.println(spoolPayload);
     spoolDoc.clear();
 
-    SendToApiParams* params = new SendToApiParams();
-    if (params == nullptr) {
-        Serial.println("Error: Cannot allocate memory for task parameters.");
-        spoolDoc.clear();
-        return 0;
-    }
-    params->requestType = API_REQUEST_SPOOL_CREATE;
-    params->httpType = "POST";
-    params->spoolsUrl = spoolsUrl;
-    params->updatePayload = spoolPayload;
-
-    // Create task without additional API state check since caller ensures synchronization
-    BaseType_t result = xTaskCreate(
-        sendToApi,                // Task-Funktion
-        "SendToApiTask",          // Task-Name
-        6144,                     // Stack size in bytes
-        (void*)params,            // Parameter
-        0,                        // Priority
-        NULL                      // Task handle (not needed)
-    );
-
-    if (result != pdPASS) {
-        Serial.println("Failed to create spool task!");
-        delete params;
-        return 0;
-    }
-    
-    // Wait for task completion and return the created spool ID
-    // Note: createdSpoolId will be set by sendToApi when response is received
-    while(createdSpoolId == 65535) {
-        vTaskDelay(50 / portTICK_PERIOD_MS);
-    }
+    uint16_t spoolId;
+    awaitApiFuture(queueApiLookup(API_REQUEST_SPOOL_CREATE, "POST", spoolsUrl, spoolPayload), deadline,
+                   spoolId, nullptr, rejected);
     
     // Check if spool creation was successful
-    if (createdSpoolId == 0) {
+    if (spoolId == 0) {
         Serial.println("ERROR: Spool creation failed");
         nfcReaderState = NFC_IDLE; // Reset NFC state
         return 0;
     }
 
-    // Write data to tag with startWriteJsonToTag
-    // void startWriteJsonToTag(const bool isSpoolTag, const char* payload);
-    
     // Create optimized JSON structure with sm_id at the beginning for fast-path detection
     JsonDocument optimizedPayload;
-    optimizedPayload["sm_id"] = String(createdSpoolId);  // Place sm_id first for fast scanning
+    optimizedPayload["sm_id"] = String(spoolId);  // Place sm_id first for fast scanning
     optimizedPayload["b"] = payload["b"].as<String>();
     optimizedPayload["cn"] = payload["an"].as<String>();
     
@@ -1052,27 +1019,100 @@ uint16_t createSpool(uint16_t vendorId, uint16_t filamentId, JsonDocument& paylo
     
     startWriteJsonToTag(true, payloadString.c_str());
 
-    return createdSpoolId;
+    return spoolId;
 }
 
-bool createBrandFilament(JsonDocument& payload, String uidString) {
-    uint16_t vendorId = checkVendor(payload);
-    if (vendorId == 0) {
-        Serial.println("ERROR: Failed to create/find vendor");
-        return false;
-    }
-    
-    uint16_t filamentId = checkFilament(vendorId, payload);
-    if (filamentId == 0) {
-        Serial.println("ERROR: Failed to create/find filament");
-        return false;
+// Vendor and filament come from the brand cache when known. Otherwise their
+// lookups are queued together and answered back to back, and only what is
+// missing gets created. A lookup that failed aborts, as creating then could
+// duplicate an existing vendor or filament. All steps share one deadline.
+// staleCache: Spoolman refused a cached ID.
+static uint16_t createBrandFilamentSpool(JsonDocument& payload, const String& uidString, unsigned long deadline,
+                                         bool& staleCache) {
+    String brand = payload["b"].as<String>();
+    String articleNumber = payload["an"].is<String>() ? payload["an"].as<String>() : "";
+    uint16_t vendorId = brandCacheVendor(brand);
+    uint16_t filamentId = brandCacheFilament(vendorId, articleNumber);
+    bool vendorCached = vendorId != 0;
+    bool filamentCached = filamentId != 0;
+    bool rejected = false;
+
+    if (filamentCached) {
+        Serial.printf("Brand cache: vendor %u, filament %u\n", vendorId, filamentId);
+    } else {
+        oledShowProgressBar(1, 5, "New Brand", "Check Vendor");
+        ApiFuture* vendorLookup = vendorCached ? nullptr : queueVendorCheck(payload);
+        ApiFuture* filamentLookup = queueFilamentCheck(payload);
+
+        if (!vendorCached) {
+            ApiFutureStatus vendorStatus = awaitApiFuture(vendorLookup, deadline, vendorId);
+            if (vendorStatus == API_FUTURE_FAILED) {
+                Serial.println("ERROR: Vendor check failed");
+                cancelApiFuture(filamentLookup);
+                return 0;
+            }
+            if (vendorStatus == API_FUTURE_NOT_FOUND) {
+                Serial.println("Vendor not found, creating new vendor...");
+                vendorId = createVendor(payload, deadline);
+            }
+            if (vendorId == 0) {
+                Serial.println("ERROR: Failed to create/find vendor");
+                cancelApiFuture(filamentLookup);
+                return 0;
+            }
+            brandCacheStoreVendor(brand, vendorId);
+        }
+        Serial.println("Vendor ID: " + String(vendorId));
+
+        oledShowProgressBar(3, 5, "New Brand", "Check Filament");
+        uint16_t filamentVendorId = 0;
+        // Without an article number there is nothing to look up
+        ApiFutureStatus filamentStatus = payload["an"].is<String>()
+            ? awaitApiFuture(filamentLookup, deadline, filamentId, &filamentVendorId)
+            : API_FUTURE_NOT_FOUND;
+        if (filamentStatus == API_FUTURE_FAILED) {
+            Serial.println("ERROR: Filament check failed");
+            return 0;
+        }
+        // The name filter also matches vendors whose name merely contains it
+        if (filamentId != 0 && filamentVendorId != vendorId) {
+            Serial.println("Filament found for another vendor, ignoring it");
+            filamentId = 0;
+        }
+        if (filamentId == 0) {
+            Serial.println("Filament not found, creating new filament...");
+            filamentId = createFilament(vendorId, payload, deadline, &rejected);
+        }
+        if (filamentId == 0) {
+            Serial.println("ERROR: Failed to create/find filament");
+            staleCache = vendorCached && rejected;
+            return 0;
+        }
+        brandCacheStoreFilament(vendorId, articleNumber, filamentId);
     }
-    
-    uint16_t spoolId = createSpool(vendorId, filamentId, payload, uidString);
+    Serial.println("Filament ID: " + String(filamentId));
+
+    uint16_t spoolId = createSpool(vendorId, filamentId, payload, uidString, deadline, &rejected);
     if (spoolId == 0) {
         Serial.println("ERROR: Failed to create spool");
-        return false;
+        staleCache = filamentCached && rejected;
     }
+    return spoolId;
+}
+
+bool createBrandFilament(JsonDocument& payload, String uidString) {
+    unsigned long deadline = millis() + API_ONBOARDING_TIMEOUT_MS;
+    bool staleCache = false;
+    uint16_t spoolId = createBrandFilamentSpool(payload, uidString, deadline, staleCache);
+
+    // Vendor or filament was deleted in Spoolman, looked up once more
+    if (spoolId == 0 && staleCache) {
+        Serial.println("Cached vendor/filament refused, looking them up again");
+        brandCacheForget(payload["b"].as<String>());
+        staleCache = false;
+        spoolId = createBrandFilamentSpool(payload, uidString, deadline, staleCache);
+    }
+    if (spoolId == 0) return false;
     
     Serial.println("SUCCESS: Brand filament created with Spool ID: " + String(spoolId));
     return true;
@@ -1088,10 +1128,10 @@ bool createSpoolFromOpenPrintTag(const OpenPrintTagData& optData, String uidStri
         return false;
     }
 
-    // Build the JSON payload in the format expected by checkVendor/checkFilament/createSpool
+    // Build the JSON payload in the format expected by createBrandFilament
     JsonDocument payload;
 
-    // Brand name → "b" key (used by checkVendor)
+    // Brand name → "b" key (used for the vendor lookup)
     payload["b"] = optData.brandName.length() > 0 ? optData.brandName : "Unknown";
 
     // Material type → "t" key (used by createFilament as "material")
@@ -1179,7 +1219,6 @@ bool createSpoolFromOpenPrintTag(const OpenPrintTagData& optData, String uidStri
 bool checkSpoolmanExtraFields() {
     // Only check extra fields if they have not been checked before
     if(!spoolmanExtraFieldsChecked){
-        HTTPClient http;
         String checkUrls[] = {
             spoolmanUrl + apiUrl + "/field/spool",
             spoolmanUrl + apiUrl + "/field/filament"
@@ -1258,13 +1297,22 @@ bool checkSpoolmanExtraFields() {
         for (uint8_t i = 0; i < urlLength; i++) {
             Serial.println();
             Serial.println("-------- Checking fields for "+checkUrls[i]+" --------");
-            http.begin(checkUrls[i]);
-            int httpCode = http.GET();
+            JsonDocument doc;
+            DeserializationError error = DeserializationError::Ok;
+            int httpCode;
+            {
+                // Released before the POSTs below take a connection
+                HttpPoolLease lease(checkUrls[i]);
+                httpCode = lease.send("GET");
+                if (httpCode == HTTP_CODE_OK) {
+                    // Only the field keys are compared
+                    JsonDocument filter;
+                    filter.add<JsonObject>()["key"] = true;
+                    error = lease.readJson(doc, &filter);
+                }
+            }
         
             if (httpCode == HTTP_CODE_OK) {
-                String payload = http.getString();
-                JsonDocument doc;
-                DeserializationError error = deserializeJson(doc, payload);
                 if (!error) {
                     String* extraFields;
                     String* extraFieldData;
@@ -1293,9 +1341,10 @@ bool checkSpoolmanExtraFields() {
                             Serial.println("Field not found: " + extraFields[s]);
 
                             // Add extra field
-                            http.begin(checkUrls[i] + "/" + extraFields[s]);
+                            HttpPoolLease lease(checkUrls[i] + "/" + extraFields[s]);
+                            HTTPClient& http = lease.http();
                             http.addHeader("Content-Type", "application/json");
-                            int httpCode = http.POST(extraFieldData[s]);
+                            int httpCode = lease.send("POST", extraFieldData[s]);
 
                             if (httpCode > 0) {
                                 // Get response code and message
@@ -1311,7 +1360,6 @@ bool checkSpoolmanExtraFields() {
                                 Serial.println("Error sending request: " + String(http.errorToString(httpCode)));
                                 return false;
                             }
-                            //http.end();
                         }
                         yield();
                         vTaskDelay(100 / portTICK_PERIOD_MS);
@@ -1324,8 +1372,6 @@ bool checkSpoolmanExtraFields() {
         Serial.println("-------- END checking fields --------");
         Serial.println();
 
-        http.end();
-
         spoolmanExtraFieldsChecked = true;
         return true;
     }else{
@@ -1334,28 +1380,31 @@ bool checkSpoolmanExtraFields() {
 }
 
 bool checkSpoolmanInstance() {
-    HTTPClient http;
     bool returnValue = false;
 
-    // Only do the spoolman instance check if there is no active API request going on
-    if(spoolmanApiState == API_IDLE){
+    // Only do the spoolman instance check if there is no active API request going on.
+    // Before the worker runs (setup) there is nothing to collide with.
+    if(apiBusy == NULL || xSemaphoreTake(apiBusy, 0) == pdTRUE){
         spoolmanApiState = API_TRANSMITTING;
         String healthUrl = spoolmanUrl + apiUrl + "/health";
 
         Serial.print("Checking spoolman instance: ");
         Serial.println(healthUrl);
 
-        http.begin(healthUrl);
-        int httpCode = http.GET();
+        JsonDocument doc;
+        DeserializationError error = DeserializationError::Ok;
+        int httpCode;
+        {
+            // Released before the extra field check takes a connection
+            HttpPoolLease lease(healthUrl);
+            httpCode = lease.send("GET");
+            if (httpCode == HTTP_CODE_OK) error = lease.readJson(doc);
+        }
 
         if (httpCode > 0) {
             if (httpCode == HTTP_CODE_OK) {
-                String payload = http.getString();
-                JsonDocument doc;
-                DeserializationError error = deserializeJson(doc, payload);
                 if (!error && doc["status"].is<String>()) {
                     const char* status = doc["status"];
-                    http.end();
 
                     if (!checkSpoolmanExtraFields()) {
                         Serial.println("Error checking extra fields.");
@@ -1363,11 +1412,12 @@ bool checkSpoolmanInstance() {
                         // TBD
                         oledShowMessage("Spoolman Error creating Extrafields");
                         vTaskDelay(2000 / portTICK_PERIOD_MS);
-                        
+
+                        spoolmanApiState = API_IDLE;
+                        if (apiBusy != NULL) xSemaphoreGive(apiBusy);
                         return false;
                     }
 
-                    spoolmanApiState = API_IDLE;
                     oledShowTopRow();
                     spoolmanConnected = true;
                     returnValue = strcmp(status, "healthy") == 0;
@@ -1383,8 +1433,8 @@ bool checkSpoolmanInstance() {
             spoolmanConnected = false;
             Serial.println("Error contacting spoolman instance! HTTP Code: " + String(httpCode));
         }
-        http.end();
         spoolmanApiState = API_IDLE;
+        if (apiBusy != NULL) xSemaphoreGive(apiBusy);
     }
     else
     {
@@ -1407,7 +1457,13 @@ bool saveSpoolmanUrl(const String& url, bool octoOn, const String& octo_url, con
 
     //TBD: This could be handled nicer in the future
     spoolmanExtraFieldsChecked = false;
+    bool urlChanged = (url != spoolmanUrl);
     spoolmanUrl = url;
+    if (urlChanged) {
+        spoolMirrorReset();
+        journalClear();
+        brandCacheClear();
+    }
     octoEnabled = octoOn;
     octoUrl = octo_url;
     octoToken = octoTk;
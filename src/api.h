@@ -26,23 +26,40 @@ typedef enum {
     API_REQUEST_SPOOL_CREATE
 } SpoolmanApiRequestType;
 
+// One worker task sends all Spoolman/OctoPrint requests in order. High
+// priority requests (scan pipeline, brand filament flow) go before low
+// priority ones (Bambu settings, batch tag updates).
+typedef enum {
+    API_PRIORITY_HIGH,
+    API_PRIORITY_LOW
+} ApiPriority;
+
+#define API_QUEUE_LENGTH    8       // per priority
+#define API_QUEUE_WAIT_MS   2000    // longest wait for room in a full queue
+
+// Runs on the API worker once the request finished
+typedef void (*ApiDoneCallback)(SpoolmanApiRequestType requestType, bool success, void* context);
+
 extern volatile spoolmanApiStateType spoolmanApiState;
 extern bool spoolman_connected;
 extern String spoolmanUrl;
 extern bool octoEnabled;
-extern bool sendOctoUpdate;
 extern String octoUrl;
 extern String octoToken;
 extern bool spoolmanConnected;
 extern uint16_t updateOctoSpoolId;
 
+void initApiWorker();
+bool queueJournalReplay(uint32_t seq, ApiDoneCallback onDone, void* doneContext); // sends a journal entry on the worker
 bool checkSpoolmanInstance();
 bool saveSpoolmanUrl(const String& url, bool octoOn, const String& octoWh, const String& octoTk);
 String loadSpoolmanUrl(); // Function to load the URL
 bool checkSpoolmanExtraFields(); // Function for checking extra fields
 JsonDocument fetchSingleSpoolInfo(int spoolId); // API function for the web page
-bool updateSpoolTagId(String uidString, const char* payload); // Function to update a spool
-uint8_t updateSpoolWeight(String spoolId, uint16_t weight); // Function to update weight
+bool updateSpoolTagId(String uidString, const char* payload, uint16_t weightValue,
+                      ApiPriority priority = API_PRIORITY_HIGH,
+                      ApiDoneCallback onDone = nullptr, void* doneContext = nullptr); // nfc_id, then weight if above 10 g
+uint8_t updateSpoolWeight(String spoolId, uint16_t weight, bool traced = false); // Function to update weight, traced ends the scan trace
 uint8_t updateSpoolLocation(String spoolId, String location);
 bool initSpoolman(); // Function to initialize Spoolman
 bool updateSpoolBambuData(String payload); // Function to update Bambu data
@@ -1,5 +1,6 @@
 #include "bambu.h"
 #include "config.h"
+#include "events.h"
 
 #ifdef DISABLE_BAMBU
 
@@ -38,6 +39,9 @@ bool setBambuSpool(String) {
     return false;
 }
 
+void autoSetSpool(int, uint8_t) {
+}
+
 void bambu_restart() {
 }
 
@@ -537,10 +541,8 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
                     trayObj["cali_idx"].as<String>() != ams_data[storedIndex].trays[j].cali_idx) {
                     hasChanges = true;
 
-                    if (bambuCredentials.autosend_enable && autoSetToBambuSpoolId > 0 && hasChanges)
-                    {
-                        autoSetSpool(autoSetToBambuSpoolId, ams_data[storedIndex].trays[j].id);
-                    }
+                    // Auto set is decided in the main loop
+                    postTrayChanged(ams_data[storedIndex].trays[j].id);
 
                     break;
                 }
@@ -561,10 +563,7 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
                         (vtTray["tray_type"].as<String>() != "" && vtTray["cali_idx"].as<String>() != ams_data[i].trays[0].cali_idx)) {
                         hasChanges = true;
 
-                        if (bambuCredentials.autosend_enable && autoSetToBambuSpoolId > 0 && hasChanges)
-                        {
-                            autoSetSpool(autoSetToBambuSpoolId, 254);
-                        }
+                        postTrayChanged(254);
                     }
                     break;
                 }
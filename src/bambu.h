@@ -47,6 +47,7 @@ bool saveBambuCredentials(const String& bambu_ip, const String& bambu_serialnr,
 bool setupMqtt();
 void mqtt_loop(void * parameter);
 bool setBambuSpool(String payload);
+void autoSetSpool(int spoolId, uint8_t trayId);
 void bambu_restart();
 
 extern TaskHandle_t BambuMqttTask;
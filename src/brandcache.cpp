@@ -0,0 +1,196 @@
+#include "brandcache.h"
+#include "api.h"
+#include <LittleFS.h>
+
+#define BRAND_CACHE_FILE        "/brandcache.bin"
+#define BRAND_CACHE_MAGIC       0x43524E42UL    // "BNRC"
+#define BRAND_CACHE_VERSION     1
+
+struct BrandCacheHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t urlHash;           // Spoolman instance the IDs belong to
+};
+
+struct BrandCacheVendor {
+    char brand[32];
+    uint16_t vendorId;          // 0 marks a free slot
+    uint32_t filledAt;          // millis(), reset on load
+};
+
+struct BrandCacheFilament {
+    char articleNumber[24];
+    uint16_t vendorId;
+    uint16_t filamentId;        // 0 marks a free slot
+    uint32_t filledAt;
+};
+
+static SemaphoreHandle_t cacheMutex = NULL;
+static BrandCacheVendor vendors[BRAND_CACHE_VENDORS];
+static BrandCacheFilament filaments[BRAND_CACHE_FILAMENTS];
+
+static uint32_t urlHash(const String& url) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < url.length(); i++) {
+        hash ^= (uint8_t)url[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static bool expired(uint32_t filledAt) {
+    return millis() - filledAt > BRAND_CACHE_TTL_MS;
+}
+
+static void saveLocked() {
+    BrandCacheHeader header = { BRAND_CACHE_MAGIC, BRAND_CACHE_VERSION, 0, urlHash(spoolmanUrl) };
+    File file = LittleFS.open(BRAND_CACHE_FILE, "w");
+    if (!file) return;
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t*)vendors, sizeof(vendors)) == sizeof(vendors) &&
+              file.write((const uint8_t*)filaments, sizeof(filaments)) == sizeof(filaments);
+    file.close();
+    if (!ok) LittleFS.remove(BRAND_CACHE_FILE);
+}
+
+// IDs of the previous boot, unless they belong to another Spoolman
+static void loadLocked() {
+    File file = LittleFS.open(BRAND_CACHE_FILE, "r");
+    if (!file) return;
+
+    BrandCacheHeader header;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == BRAND_CACHE_MAGIC && header.version == BRAND_CACHE_VERSION &&
+              header.urlHash == urlHash(spoolmanUrl) &&
+              file.read((uint8_t*)vendors, sizeof(vendors)) == sizeof(vendors) &&
+              file.read((uint8_t*)filaments, sizeof(filaments)) == sizeof(filaments);
+    file.close();
+
+    if (!ok) {
+        memset(vendors, 0, sizeof(vendors));
+        memset(filaments, 0, sizeof(filaments));
+        return;
+    }
+
+    // millis() of the previous boot mean nothing now
+    for (uint8_t i = 0; i < BRAND_CACHE_VENDORS; i++) {
+        vendors[i].brand[sizeof(vendors[i].brand) - 1] = '\0';
+        vendors[i].filledAt = millis();
+    }
+    for (uint8_t i = 0; i < BRAND_CACHE_FILAMENTS; i++) {
+        filaments[i].articleNumber[sizeof(filaments[i].articleNumber) - 1] = '\0';
+        filaments[i].filledAt = millis();
+    }
+}
+
+void initBrandCache() {
+    if (cacheMutex != NULL) return;
+    cacheMutex = xSemaphoreCreateMutex();
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    loadLocked();
+    xSemaphoreGive(cacheMutex);
+}
+
+static int findVendor(const String& brand) {
+    for (uint8_t i = 0; i < BRAND_CACHE_VENDORS; i++) {
+        if (vendors[i].vendorId != 0 && brand.equalsIgnoreCase(vendors[i].brand)) return i;
+    }
+    return -1;
+}
+
+static int findFilament(uint16_t vendorId, const String& articleNumber) {
+    for (uint8_t i = 0; i < BRAND_CACHE_FILAMENTS; i++) {
+        if (filaments[i].filamentId != 0 && filaments[i].vendorId == vendorId &&
+            articleNumber == filaments[i].articleNumber) return i;
+    }
+    return -1;
+}
+
+uint16_t brandCacheVendor(const String& brand) {
+    if (cacheMutex == NULL) return 0;
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    int index = findVendor(brand);
+    uint16_t vendorId = (index >= 0 && !expired(vendors[index].filledAt)) ? vendors[index].vendorId : 0;
+    xSemaphoreGive(cacheMutex);
+    return vendorId;
+}
+
+uint16_t brandCacheFilament(uint16_t vendorId, const String& articleNumber) {
+    if (cacheMutex == NULL || vendorId == 0 || articleNumber.length() == 0) return 0;
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    int index = findFilament(vendorId, articleNumber);
+    uint16_t filamentId = (index >= 0 && !expired(filaments[index].filledAt)) ? filaments[index].filamentId : 0;
+    xSemaphoreGive(cacheMutex);
+    return filamentId;
+}
+
+void brandCacheStoreVendor(const String& brand, uint16_t vendorId) {
+    if (cacheMutex == NULL || vendorId == 0 || brand.length() == 0 ||
+        brand.length() >= sizeof(vendors[0].brand)) return;
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    // Same brand, otherwise a free or the oldest slot
+    int index = findVendor(brand);
+    if (index < 0) {
+        index = 0;
+        for (uint8_t i = 0; i < BRAND_CACHE_VENDORS && vendors[index].vendorId != 0; i++) {
+            if (vendors[i].vendorId == 0 || vendors[i].filledAt < vendors[index].filledAt) index = i;
+        }
+    }
+    strlcpy(vendors[index].brand, brand.c_str(), sizeof(vendors[index].brand));
+    vendors[index].vendorId = vendorId;
+    vendors[index].filledAt = millis();
+    saveLocked();
+    xSemaphoreGive(cacheMutex);
+}
+
+void brandCacheStoreFilament(uint16_t vendorId, const String& articleNumber, uint16_t filamentId) {
+    if (cacheMutex == NULL || vendorId == 0 || filamentId == 0 || articleNumber.length() == 0 ||
+        articleNumber.length() >= sizeof(filaments[0].articleNumber)) return;
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    // Same filament, otherwise a free or the oldest slot
+    int index = findFilament(vendorId, articleNumber);
+    if (index < 0) {
+        index = 0;
+        for (uint8_t i = 0; i < BRAND_CACHE_FILAMENTS && filaments[index].filamentId != 0; i++) {
+            if (filaments[i].filamentId == 0 || filaments[i].filledAt < filaments[index].filledAt) index = i;
+        }
+    }
+    strlcpy(filaments[index].articleNumber, articleNumber.c_str(), sizeof(filaments[index].articleNumber));
+    filaments[index].vendorId = vendorId;
+    filaments[index].filamentId = filamentId;
+    filaments[index].filledAt = millis();
+    saveLocked();
+    xSemaphoreGive(cacheMutex);
+}
+
+void brandCacheForget(const String& brand) {
+    if (cacheMutex == NULL) return;
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    int index = findVendor(brand);
+    if (index >= 0) {
+        uint16_t vendorId = vendors[index].vendorId;
+        for (uint8_t i = 0; i < BRAND_CACHE_FILAMENTS; i++) {
+            if (filaments[i].vendorId == vendorId) filaments[i] = {};
+        }
+        vendors[index] = {};
+        saveLocked();
+    }
+    xSemaphoreGive(cacheMutex);
+}
+
+void brandCacheClear() {
+    if (cacheMutex == NULL) return;
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    memset(vendors, 0, sizeof(vendors));
+    memset(filaments, 0, sizeof(filaments));
+    LittleFS.remove(BRAND_CACHE_FILE);
+    xSemaphoreGive(cacheMutex);
+}
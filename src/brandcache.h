@@ -0,0 +1,23 @@
+#ifndef BRANDCACHE_H
+#define BRANDCACHE_H
+
+#include <Arduino.h>
+
+// Spoolman IDs of brand-filament tags: brand name to vendor ID and (vendor
+// ID, article number) to filament ID. Filled from the lookups and creates of
+// createBrandFilament and kept on LittleFS, so a box of identical spools
+// needs the lookups only once. Entries expire after BRAND_CACHE_TTL_MS of
+// uptime (counted again from boot) or when Spoolman refuses a cached ID.
+#define BRAND_CACHE_VENDORS     16
+#define BRAND_CACHE_FILAMENTS   32
+#define BRAND_CACHE_TTL_MS      (24UL * 60UL * 60UL * 1000UL)
+
+void initBrandCache();
+uint16_t brandCacheVendor(const String& brand);                                 // 0 if unknown
+uint16_t brandCacheFilament(uint16_t vendorId, const String& articleNumber);    // 0 if unknown
+void brandCacheStoreVendor(const String& brand, uint16_t vendorId);
+void brandCacheStoreFilament(uint16_t vendorId, const String& articleNumber, uint16_t filamentId);
+void brandCacheForget(const String& brand);     // vendor and its filaments, a cached ID was refused
+void brandCacheClear();                         // Spoolman URL changed
+
+#endif
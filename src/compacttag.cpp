@@ -0,0 +1,228 @@
+#include "compacttag.h"
+#include <ArduinoJson.h>
+
+// --- Key dictionary ---
+// Ids are stored on tags, only ever append to this list
+static const char* const compactTagKeys[] = {
+    nullptr,        // 0: inline key
+    "color_hex",    // 1
+    "type",         // 2
+    "min_temp",     // 3
+    "max_temp",     // 4
+    "brand",        // 5
+    "location",     // 6
+    "b",            // 7
+    "an",           // 8
+    "cn",           // 9
+    "c",            // 10
+    "t",            // 11
+    "et",           // 12
+    "bt",           // 13
+    "sw",           // 14
+    "de",           // 15
+    "di",           // 16
+    "u",            // 17
+    "mc",           // 18
+    "mcd",          // 19
+    "artnr",        // 20
+};
+static const uint8_t compactTagKeyCount = sizeof(compactTagKeys) / sizeof(compactTagKeys[0]);
+
+static uint8_t compactKeyId(const char* key) {
+    for (uint8_t i = 1; i < compactTagKeyCount; i++) {
+        if (strcmp(key, compactTagKeys[i]) == 0) return i;
+    }
+    return COMPACT_KEY_INLINE;
+}
+
+// --- Value helpers ---
+
+// Decimal without leading zeros, so the string survives the round trip
+static bool parseDecimal(const char* text, uint32_t maxValue, uint32_t& value) {
+    size_t length = strlen(text);
+    if (length == 0 || length > 10 || (length > 1 && text[0] == '0')) return false;
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        result = result * 10 + (text[i] - '0');
+    }
+    if (result > maxValue) return false;
+    value = (uint32_t)result;
+    return true;
+}
+
+static int8_t hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool isUpperHex(const char* text, size_t length) {
+    if (length < 2 || (length % 2) != 0) return false;
+    for (size_t i = 0; i < length; i++) {
+        if (hexNibble(text[i]) < 0) return false;
+    }
+    return true;
+}
+
+// --- Encoder ---
+
+bool compactTagEncode(const char* json, uint8_t* buffer, uint16_t bufferSize, uint16_t& length) {
+    JsonDocument doc;
+    if (deserializeJson(doc, json) || !doc.is<JsonObject>()) return false;
+    if (bufferSize < COMPACT_TAG_HEADER_SIZE) return false;
+
+    JsonObject object = doc.as<JsonObject>();
+    uint32_t spoolId = 0;
+    uint16_t pos = COMPACT_TAG_HEADER_SIZE;
+    uint8_t fieldCount = 0;
+
+    for (JsonPair kv : object) {
+        const char* key = kv.key().c_str();
+        if (!kv.value().is<const char*>()) return false;
+        const char* text = kv.value().as<const char*>();
+        size_t textLength = strlen(text);
+
+        if (strcmp(key, "sm_id") == 0) {
+            if (!parseDecimal(text, UINT32_MAX, spoolId)) return false;
+            continue;
+        }
+
+        uint8_t keyId = compactKeyId(key);
+        size_t keyLength = (keyId == COMPACT_KEY_INLINE) ? strlen(key) : 0;
+        uint8_t value[128];
+        size_t valueLength;
+        CompactTagValueType type;
+        uint32_t number;
+
+        if (parseDecimal(text, 0xFFFF, number)) {
+            type = COMPACT_VALUE_UINT;
+            if (number > 0xFF) {
+                value[0] = number >> 8;
+                value[1] = number & 0xFF;
+                valueLength = 2;
+            } else {
+                value[0] = number;
+                valueLength = 1;
+            }
+        } else if (isUpperHex(text, textLength) && textLength / 2 <= sizeof(value)) {
+            type = COMPACT_VALUE_HEX;
+            valueLength = textLength / 2;
+            for (size_t i = 0; i < valueLength; i++) {
+                value[i] = (hexNibble(text[2 * i]) << 4) | hexNibble(text[2 * i + 1]);
+            }
+        } else {
+            type = COMPACT_VALUE_TEXT;
+            valueLength = 0;
+        }
+
+        const uint8_t* valueData = (type == COMPACT_VALUE_TEXT) ? (const uint8_t*)text : value;
+        if (type == COMPACT_VALUE_TEXT) valueLength = textLength;
+
+        size_t fieldLength = (keyId == COMPACT_KEY_INLINE ? 1 + keyLength : 0) + valueLength;
+        if (keyLength > 0xFF || fieldLength > 0xFF || fieldCount == 0xFF) return false;
+        if (pos + 2 + fieldLength > bufferSize) return false;
+
+        buffer[pos++] = (type << 6) | keyId;
+        buffer[pos++] = fieldLength;
+        if (keyId == COMPACT_KEY_INLINE) {
+            buffer[pos++] = keyLength;
+            memcpy(buffer + pos, key, keyLength);
+            pos += keyLength;
+        }
+        memcpy(buffer + pos, valueData, valueLength);
+        pos += valueLength;
+        fieldCount++;
+    }
+
+    buffer[0] = COMPACT_TAG_VERSION;
+    buffer[1] = fieldCount;
+    buffer[2] = 0;                      // flags, reserved
+    buffer[3] = spoolId >> 24;
+    buffer[4] = spoolId >> 16;
+    buffer[5] = spoolId >> 8;
+    buffer[6] = spoolId;
+    length = pos;
+    return true;
+}
+
+// --- Decoder ---
+
+bool compactTagSpoolId(const uint8_t* payload, uint16_t length, uint32_t& spoolId) {
+    if (length < COMPACT_TAG_HEADER_SIZE || payload[0] != COMPACT_TAG_VERSION) return false;
+    const uint8_t* id = payload + COMPACT_TAG_SM_ID_OFFSET;
+    spoolId = ((uint32_t)id[0] << 24) | ((uint32_t)id[1] << 16) | ((uint32_t)id[2] << 8) | id[3];
+    return true;
+}
+
+bool compactTagDecode(const uint8_t* payload, uint16_t length, String& json) {
+    uint32_t spoolId;
+    if (!compactTagSpoolId(payload, length, spoolId)) return false;
+
+    JsonDocument doc;
+    doc["sm_id"] = String(spoolId);
+
+    uint16_t pos = COMPACT_TAG_HEADER_SIZE;
+    uint8_t fieldCount = payload[1];
+    char text[256];
+
+    for (uint8_t field = 0; field < fieldCount; field++) {
+        if (pos + 2 > length) return false;
+        uint8_t type = payload[pos] >> 6;
+        uint8_t keyId = payload[pos] & 0x3F;
+        uint8_t fieldLength = payload[pos + 1];
+        pos += 2;
+        if (pos + fieldLength > length) return false;
+
+        const uint8_t* value = payload + pos;
+        uint8_t valueLength = fieldLength;
+        pos += fieldLength;
+
+        String key;
+        if (keyId == COMPACT_KEY_INLINE) {
+            if (fieldLength < 1 || value[0] >= fieldLength) return false;
+            uint8_t keyLength = value[0];
+            memcpy(text, value + 1, keyLength);
+            text[keyLength] = '\0';
+            key = text;
+            value += 1 + keyLength;
+            valueLength -= 1 + keyLength;
+        } else if (keyId < compactTagKeyCount) {
+            key = compactTagKeys[keyId];
+        } else {
+            // Key from a newer dictionary, skip the field
+            continue;
+        }
+
+        switch (type) {
+            case COMPACT_VALUE_UINT:
+                if (valueLength == 1) {
+                    snprintf(text, sizeof(text), "%u", value[0]);
+                } else if (valueLength == 2) {
+                    snprintf(text, sizeof(text), "%u", (value[0] << 8) | value[1]);
+                } else {
+                    return false;
+                }
+                break;
+            case COMPACT_VALUE_HEX:
+                if (2 * valueLength >= sizeof(text)) return false;
+                for (uint8_t i = 0; i < valueLength; i++) {
+                    snprintf(text + 2 * i, 3, "%02X", value[i]);
+                }
+                text[2 * valueLength] = '\0';
+                break;
+            case COMPACT_VALUE_TEXT:
+                memcpy(text, value, valueLength);
+                text[valueLength] = '\0';
+                break;
+            default:
+                return false;
+        }
+        doc[key] = (const char*)text;
+    }
+
+    json = "";
+    serializeJson(doc, json);
+    return true;
+}
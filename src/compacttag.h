@@ -0,0 +1,37 @@
+#ifndef COMPACTTAG_H
+#define COMPACTTAG_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Compact spool tag encoding (NDEF MIME type "fm/s")
+//
+// Payload: [version][field count][flags][sm_id uint32 BE] followed by fields
+// [type:2 | key id:6][length][value]. With the 4-character MIME type the
+// payload starts at byte 9 of the NDEF area, which puts sm_id exactly on
+// page 7, inside the first 16-byte READ of pages 4-7.
+//
+// Only flat JSON objects with string values are encoded; decoding produces
+// the same object as JSON text, sm_id first.
+// ============================================================================
+
+#define COMPACT_TAG_MIME_TYPE       "fm/s"
+#define COMPACT_TAG_VERSION         0x01
+#define COMPACT_TAG_HEADER_SIZE     7
+#define COMPACT_TAG_SM_ID_OFFSET    3
+
+// Value types (upper two bits of the field key byte)
+enum CompactTagValueType : uint8_t {
+    COMPACT_VALUE_TEXT      = 0,    // UTF-8 text
+    COMPACT_VALUE_UINT      = 1,    // decimal string 0-65535, 1 or 2 bytes BE
+    COMPACT_VALUE_HEX       = 2,    // upper-case hex string, raw bytes
+};
+
+// Key id 0: the field carries its own key, [key length][key][value]
+#define COMPACT_KEY_INLINE          0
+
+bool compactTagEncode(const char* json, uint8_t* buffer, uint16_t bufferSize, uint16_t& length);
+bool compactTagDecode(const uint8_t* payload, uint16_t length, String& json);
+bool compactTagSpoolId(const uint8_t* payload, uint16_t length, uint32_t& spoolId);
+
+#endif
@@ -9,7 +9,10 @@ Pn532Pins pn532Pins = {
   DEFAULT_PN532_MOSI,
   DEFAULT_PN532_SS,
   DEFAULT_PN532_IRQ,
-  DEFAULT_PN532_RESET
+  DEFAULT_PN532_RESET,
+  DEFAULT_PN532_BUS,
+  DEFAULT_PN532_CLOCK,
+  DEFAULT_PN532_USE_IRQ
 };
 // ***** PN532
 
@@ -78,7 +81,34 @@ static bool isValidPinConfig(const Pn532Pins &pins) {
       if (arr[i] == arr[j]) return false;
     }
   }
-  return true;
+
+  // PN532 limits: SPI 5 MHz, I2C 400 kHz, HSU runs at its 115200 baud power-on rate
+  switch (pins.bus) {
+    case PN532_BUS_SOFT_SPI: return true;
+    case PN532_BUS_SPI:      return pins.clock >= 100000 && pins.clock <= 5000000;
+    case PN532_BUS_I2C:      return pins.clock >= 10000 && pins.clock <= 400000;
+    case PN532_BUS_HSU:      return pins.clock == 115200;
+    default:                 return false;
+  }
+}
+
+uint32_t defaultPn532Clock(uint8_t bus) {
+  switch (bus) {
+    case PN532_BUS_SPI: return 1000000;
+    case PN532_BUS_I2C: return 100000;
+    case PN532_BUS_HSU: return 115200;
+    default:            return 0;
+  }
+}
+
+const char* pn532BusToString(uint8_t bus) {
+  switch (bus) {
+    case PN532_BUS_SOFT_SPI: return "softspi";
+    case PN532_BUS_SPI:      return "spi";
+    case PN532_BUS_I2C:      return "i2c";
+    case PN532_BUS_HSU:      return "hsu";
+    default:                 return "unknown";
+  }
 }
 
 void loadPinConfig() {
@@ -90,9 +120,13 @@ void loadPinConfig() {
     prefs.getUChar(NVS_KEY_PN532_MOSI,  DEFAULT_PN532_MOSI),
     prefs.getUChar(NVS_KEY_PN532_SS,    DEFAULT_PN532_SS),
     prefs.getUChar(NVS_KEY_PN532_IRQ,   DEFAULT_PN532_IRQ),
-    prefs.getUChar(NVS_KEY_PN532_RESET, DEFAULT_PN532_RESET)
+    prefs.getUChar(NVS_KEY_PN532_RESET, DEFAULT_PN532_RESET),
+    prefs.getUChar(NVS_KEY_PN532_BUS,   DEFAULT_PN532_BUS),
+    prefs.getUInt(NVS_KEY_PN532_CLOCK,  DEFAULT_PN532_CLOCK),
+    prefs.getBool(NVS_KEY_PN532_USE_IRQ, DEFAULT_PN532_USE_IRQ)
   };
   prefs.end();
+  if (loadedPins.clock == 0) loadedPins.clock = defaultPn532Clock(loadedPins.bus);
 
   if (!isValidPinConfig(loadedPins)) {
     Serial.printf("Invalid PN532 pin config in NVS (SCK=%u MISO=%u MOSI=%u SS=%u IRQ=%u RST=%u). Using defaults.\n",
@@ -104,15 +138,20 @@ void loadPinConfig() {
       DEFAULT_PN532_MOSI,
       DEFAULT_PN532_SS,
       DEFAULT_PN532_IRQ,
-      DEFAULT_PN532_RESET
+      DEFAULT_PN532_RESET,
+      DEFAULT_PN532_BUS,
+      defaultPn532Clock(DEFAULT_PN532_BUS),
+      DEFAULT_PN532_USE_IRQ
     };
   } else {
     pn532Pins = loadedPins;
   }
 
-  Serial.printf("PN532 pins: SCK=%u MISO=%u MOSI=%u SS=%u IRQ=%u RST=%u\n",
+  Serial.printf("PN532 pins: SCK=%u MISO=%u MOSI=%u SS=%u IRQ=%u RST=%u BUS=%s CLK=%u IRQ detection=%s\n",
     pn532Pins.sck, pn532Pins.miso, pn532Pins.mosi,
-    pn532Pins.ss, pn532Pins.irq, pn532Pins.reset);
+    pn532Pins.ss, pn532Pins.irq, pn532Pins.reset,
+    pn532BusToString(pn532Pins.bus), pn532Pins.clock,
+    pn532Pins.useIrq ? "on" : "off");
 }
 
 bool savePinConfig(const Pn532Pins &pins) {
@@ -126,6 +165,9 @@ bool savePinConfig(const Pn532Pins &pins) {
   prefs.putUChar(NVS_KEY_PN532_SS,    pins.ss);
   prefs.putUChar(NVS_KEY_PN532_IRQ,   pins.irq);
   prefs.putUChar(NVS_KEY_PN532_RESET, pins.reset);
+  prefs.putUChar(NVS_KEY_PN532_BUS,   pins.bus);
+  prefs.putUInt(NVS_KEY_PN532_CLOCK,  pins.clock);
+  prefs.putBool(NVS_KEY_PN532_USE_IRQ, pins.useIrq);
   prefs.end();
 
   pn532Pins = pins;
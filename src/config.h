@@ -32,6 +32,12 @@
 #define NVS_KEY_AUTOTARE                    "auto_tare"
 #define SCALE_DEFAULT_CALIBRATION_VALUE     430.0f;
 
+#define NVS_NAMESPACE_NFC                   "nfc"
+#define NVS_KEY_NFC_WRITE_POLICY            "writePolicy"
+#define NVS_KEY_NFC_TAG_ENCODING            "tagEncoding"
+#define NVS_KEY_NFC_BAYS                    "bays"
+#define NVS_KEY_NFC_DUAL_TARGET             "dualTarget"
+
 // ── Pin configuration NVS ──
 #define NVS_NAMESPACE_PINS                  "pins"
 #define NVS_KEY_PN532_SCK                   "pn532Sck"
@@ -40,6 +46,9 @@
 #define NVS_KEY_PN532_SS                    "pn532Ss"
 #define NVS_KEY_PN532_IRQ                   "pn532Irq"
 #define NVS_KEY_PN532_RESET                 "pn532Rst"
+#define NVS_KEY_PN532_BUS                   "pn532Bus"
+#define NVS_KEY_PN532_CLOCK                 "pn532Clk"
+#define NVS_KEY_PN532_USE_IRQ               "pn532UseIrq"
 
 // Board name set via build flag; fallback for legacy builds
 #ifndef BOARD_NAME
@@ -66,6 +75,27 @@
   #define DEFAULT_PN532_RESET 27
 #endif
 
+// PN532 host interface. I2C uses MOSI as SDA and SCK as SCL,
+// HSU (UART) uses MISO as RX and MOSI as TX.
+typedef enum {
+  PN532_BUS_SOFT_SPI,
+  PN532_BUS_SPI,
+  PN532_BUS_I2C,
+  PN532_BUS_HSU
+} Pn532BusType;
+
+#ifndef DEFAULT_PN532_BUS
+  #define DEFAULT_PN532_BUS   PN532_BUS_SOFT_SPI
+#endif
+// 0 = default clock of the selected bus (see defaultPn532Clock())
+#ifndef DEFAULT_PN532_CLOCK
+  #define DEFAULT_PN532_CLOCK 0
+#endif
+// IRQ driven tag detection, needs the IRQ line wired
+#ifndef DEFAULT_PN532_USE_IRQ
+  #define DEFAULT_PN532_USE_IRQ false
+#endif
+
 // PN532 pin structure
 struct Pn532Pins {
   uint8_t sck;
@@ -74,12 +104,17 @@ struct Pn532Pins {
   uint8_t ss;
   uint8_t irq;
   uint8_t reset;
+  uint8_t bus;        // Pn532BusType
+  uint32_t clock;     // SPI/I2C clock in Hz, HSU baud rate
+  bool useIrq;        // wait for tags on the IRQ line instead of polling
 };
 
 extern Pn532Pins pn532Pins;
 
 void loadPinConfig();
 bool savePinConfig(const Pn532Pins &pins);
+uint32_t defaultPn532Clock(uint8_t bus);
+const char* pn532BusToString(uint8_t bus);
 
 #define BAMBU_USERNAME                      "bblp"
 
@@ -0,0 +1,87 @@
+#include "events.h"
+
+#define EVENT_QUEUE_LENGTH 32
+
+static QueueHandle_t eventQueue = NULL;
+static volatile uint32_t droppedEvents = 0;
+
+void initEvents() {
+    if (eventQueue == NULL) {
+        eventQueue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(AppEvent));
+    }
+}
+
+bool postEvent(const AppEvent& event) {
+    // Events posted before setup() created the queue are dropped
+    if (eventQueue == NULL) return false;
+    if (xQueueSend(eventQueue, &event, 0) != pdTRUE) {
+        droppedEvents++;
+        return false;
+    }
+    return true;
+}
+
+bool IRAM_ATTR postEventFromIsr(const AppEvent& event) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if (eventQueue == NULL || xQueueSendFromISR(eventQueue, &event, &higherPriorityTaskWoken) != pdTRUE) {
+        return false;
+    }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    return true;
+}
+
+bool waitForEvent(AppEvent& event, uint32_t timeoutMs) {
+    if (eventQueue == NULL) {
+        vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+        return false;
+    }
+
+    if (droppedEvents > 0) {
+        Serial.printf("⚠ Event queue full, %u events dropped\n", droppedEvents);
+        droppedEvents = 0;
+    }
+    return xQueueReceive(eventQueue, &event, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+// ##### Producer shorthands #####
+void postTagRead(uint32_t spoolId) {
+    AppEvent event = {};
+    event.type = EVENT_TAG_READ;
+    event.spoolId = spoolId;
+    postEvent(event);
+}
+
+void postTagWritten(uint32_t spoolId) {
+    AppEvent event = {};
+    event.type = EVENT_TAG_WRITTEN;
+    event.spoolId = spoolId;
+    postEvent(event);
+}
+
+void postTagRemoved() {
+    AppEvent event = {};
+    event.type = EVENT_TAG_REMOVED;
+    postEvent(event);
+}
+
+void postWeightEvent(AppEventType type, int16_t weight) {
+    AppEvent event = {};
+    event.type = type;
+    event.weight = weight;
+    postEvent(event);
+}
+
+void postApiResult(uint8_t requestType, bool success) {
+    AppEvent event = {};
+    event.type = EVENT_API_RESULT;
+    event.requestType = requestType;
+    event.success = success;
+    postEvent(event);
+}
+
+void postTrayChanged(uint8_t trayId) {
+    AppEvent event = {};
+    event.type = EVENT_TRAY_CHANGED;
+    event.trayId = trayId;
+    postEvent(event);
+}
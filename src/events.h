@@ -0,0 +1,43 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <Arduino.h>
+
+// Typed events from the RFID, scale, API and MQTT tasks to the main loop.
+// Events are small PODs copied into a FreeRTOS queue, so producers never
+// share Strings with the consumer. loop() sleeps on the queue until the next
+// event or its next periodic job.
+typedef enum {
+    EVENT_TAG_READ,         // spool tag read, spoolId
+    EVENT_TAG_WRITTEN,      // spool tag written, spoolId (weight sent by the write task)
+    EVENT_TAG_REMOVED,      // tag left the reader (or could not be read)
+    EVENT_WEIGHT_CHANGED,   // stabilised weight changed, weight
+    EVENT_WEIGHT_STABLE,    // weight held within +-2 g for SCALE_STABLE_MS, weight
+    EVENT_API_RESULT,       // Spoolman request finished, requestType and success
+    EVENT_TRAY_CHANGED,     // Bambu AMS tray content changed, trayId
+    EVENT_TARE_BUTTON       // touch sensor pressed
+} AppEventType;
+
+struct AppEvent {
+    AppEventType type;
+    uint32_t spoolId;
+    int16_t weight;
+    uint8_t requestType;    // SpoolmanApiRequestType
+    uint8_t trayId;
+    bool success;
+};
+
+void initEvents();
+bool postEvent(const AppEvent& event);      // never blocks, false when the queue is full
+bool postEventFromIsr(const AppEvent& event);
+bool waitForEvent(AppEvent& event, uint32_t timeoutMs);
+
+// Shorthands for the producers
+void postTagRead(uint32_t spoolId);
+void postTagWritten(uint32_t spoolId);
+void postTagRemoved();
+void postWeightEvent(AppEventType type, int16_t weight);
+void postApiResult(uint8_t requestType, bool success);
+void postTrayChanged(uint8_t trayId);
+
+#endif
@@ -0,0 +1,256 @@
+#include "httppool.h"
+#include <esp_timer.h>
+
+struct HttpPoolSlot {
+    HTTPClient http;
+    WiFiClient client;
+    String host;
+    uint16_t port;
+    bool inUse;
+    bool reused;                // current request runs on an already open connection
+    unsigned long lastUsed;
+};
+
+struct HttpPoolStats {
+    uint32_t requests;
+    uint32_t reused;
+    uint32_t connects;
+    uint32_t connectFailures;
+    uint32_t deadConnections;   // reused connections the server had closed
+    uint32_t expired;           // closed after HTTP_POOL_MAX_IDLE_MS
+    uint64_t connectUsTotal;
+    uint32_t connectUsMax;
+};
+
+static HttpPoolSlot slots[HTTP_POOL_SIZE];
+static SemaphoreHandle_t poolMutex = NULL;  // guards slot selection
+static SemaphoreHandle_t poolFree = NULL;   // counts slots not in use
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+static HttpPoolStats stats = {};
+
+void initHttpPool() {
+    if (poolMutex != NULL) return;
+    poolMutex = xSemaphoreCreateMutex();
+    poolFree = xSemaphoreCreateCounting(HTTP_POOL_SIZE, HTTP_POOL_SIZE);
+}
+
+// Host and port of a plain http:// URL
+static bool parseHttpUrl(const String& url, String& host, uint16_t& port) {
+    if (!url.startsWith("http://")) return false;
+
+    const int hostStart = 7;
+    int pathStart = url.indexOf('/', hostStart);
+    if (pathStart < 0) pathStart = url.length();
+    String hostPort = url.substring(hostStart, pathStart);
+
+    int at = hostPort.lastIndexOf('@');
+    if (at >= 0) hostPort = hostPort.substring(at + 1);
+
+    int colon = hostPort.lastIndexOf(':');
+    if (colon >= 0) {
+        port = hostPort.substring(colon + 1).toInt();
+        host = hostPort.substring(0, colon);
+    } else {
+        port = 80;
+        host = hostPort;
+    }
+    return host.length() > 0 && port > 0;
+}
+
+static bool connectSlot(HttpPoolSlot* slot, uint16_t timeoutMs) {
+    int64_t start = esp_timer_get_time();
+    bool connected = slot->client.connect(slot->host.c_str(), slot->port, timeoutMs);
+    uint32_t connectUs = (uint32_t)(esp_timer_get_time() - start);
+
+    portENTER_CRITICAL(&statsMux);
+    if (connected) {
+        stats.connects++;
+        stats.connectUsTotal += connectUs;
+        if (connectUs > stats.connectUsMax) stats.connectUsMax = connectUs;
+    } else {
+        stats.connectFailures++;
+    }
+    portEXIT_CRITICAL(&statsMux);
+
+    if (!connected) {
+        Serial.printf("HTTP pool: connect to %s:%u failed\n", slot->host.c_str(), slot->port);
+    }
+    return connected;
+}
+
+// An idle open connection to the host, otherwise the least recently used free slot
+static HttpPoolSlot* takeSlot(const String& host, uint16_t port) {
+    HttpPoolSlot* best = nullptr;
+    xSemaphoreTake(poolMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        HttpPoolSlot& slot = slots[i];
+        if (slot.inUse) continue;
+        if (slot.port == port && slot.host == host && slot.client.connected()) {
+            best = &slot;
+            break;
+        }
+        if (best == nullptr || slot.lastUsed < best->lastUsed) best = &slot;
+    }
+    if (best) best->inUse = true;
+    xSemaphoreGive(poolMutex);
+    return best;
+}
+
+HttpPoolLease::HttpPoolLease(const String& url, uint16_t timeoutMs)
+    : _slot(nullptr), _http(&_unpooled), _timeoutMs(timeoutMs), _valid(false) {
+    String host;
+    uint16_t port = 0;
+
+    // https and calls before setup() get a connection of their own
+    if (poolMutex == NULL || !parseHttpUrl(url, host, port)) {
+        _unpooled.setReuse(false);
+        _unpooled.setTimeout(timeoutMs);
+        _valid = _unpooled.begin(url);
+        return;
+    }
+
+    if (xSemaphoreTake(poolFree, pdMS_TO_TICKS(HTTP_POOL_WAIT_MS)) != pdTRUE) {
+        Serial.println("HTTP pool: no free connection");
+        return;
+    }
+    _slot = takeSlot(host, port);
+
+    bool sameHost = _slot->port == port && _slot->host == host;
+    if (_slot->client.connected() && (!sameHost || millis() - _slot->lastUsed > HTTP_POOL_MAX_IDLE_MS)) {
+        if (sameHost) {
+            portENTER_CRITICAL(&statsMux);
+            stats.expired++;
+            portEXIT_CRITICAL(&statsMux);
+        }
+        _slot->client.stop();
+    }
+    _slot->host = host;
+    _slot->port = port;
+    _slot->reused = _slot->client.connected();
+
+    portENTER_CRITICAL(&statsMux);
+    stats.requests++;
+    if (_slot->reused) stats.reused++;
+    portEXIT_CRITICAL(&statsMux);
+
+    if (!_slot->reused && !connectSlot(_slot, timeoutMs)) return;
+
+    _http = &_slot->http;
+    _http->setReuse(true);
+    _http->setTimeout(timeoutMs);
+    _valid = _http->begin(_slot->client, url);
+}
+
+HttpPoolLease::~HttpPoolLease() {
+    // Keeps the connection open when the server allows it
+    _http->end();
+
+    if (_slot) {
+        _slot->lastUsed = millis();
+        xSemaphoreTake(poolMutex, portMAX_DELAY);
+        _slot->inUse = false;
+        xSemaphoreGive(poolMutex);
+        xSemaphoreGive(poolFree);
+    }
+}
+
+int HttpPoolLease::send(const char* method, const String& payload) {
+    if (!_valid) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    int httpCode = _http->sendRequest(method, payload);
+
+    // The server closed the keep-alive connection since its last use
+    if (httpCode < 0 && _slot && _slot->reused) {
+        portENTER_CRITICAL(&statsMux);
+        stats.deadConnections++;
+        portEXIT_CRITICAL(&statsMux);
+
+        _slot->client.stop();
+        _slot->reused = false;
+        if (!connectSlot(_slot, _timeoutMs)) return HTTPC_ERROR_CONNECTION_REFUSED;
+        httpCode = _http->sendRequest(method, payload);
+    }
+    return httpCode;
+}
+
+// ArduinoJson reader over a response body of known length. Reads in chunks
+// instead of byte by byte and never past the body, so the connection stays
+// usable for the next request.
+class HttpBodyReader {
+public:
+    HttpBodyReader(Stream& stream, int length) : _stream(stream), _remaining(length), _pos(0), _len(0) {}
+
+    int read() {
+        if (_pos == _len && !fill()) return -1;
+        return _buffer[_pos++];
+    }
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t n = 0;
+        while (n < length && (_pos < _len || fill())) {
+            size_t chunk = min(length - n, _len - _pos);
+            memcpy(buffer + n, _buffer + _pos, chunk);
+            _pos += chunk;
+            n += chunk;
+        }
+        return n;
+    }
+
+    // Skips what the parser left, e.g. a trailing newline
+    void drain() {
+        while (fill()) _pos = _len;
+    }
+
+private:
+    bool fill() {
+        if (_remaining <= 0) return false;
+        size_t n = _stream.readBytes(_buffer, min((size_t)_remaining, sizeof(_buffer)));
+        if (n == 0) {
+            _remaining = 0;    // timed out, the connection is dropped by the server anyway
+            return false;
+        }
+        _remaining -= n;
+        _pos = 0;
+        _len = n;
+        return true;
+    }
+
+    Stream& _stream;
+    int _remaining;
+    size_t _pos;
+    size_t _len;
+    uint8_t _buffer[128];
+};
+
+DeserializationError HttpPoolLease::readJson(JsonDocument& doc, const JsonDocument* filter) {
+    int length = _http->getSize();
+
+    // Chunked or without length: HTTPClient decodes the body into a String
+    if (length < 0) {
+        String payload = _http->getString();
+        if (filter) return deserializeJson(doc, payload, DeserializationOption::Filter(*filter));
+        return deserializeJson(doc, payload);
+    }
+
+    HttpBodyReader reader(_http->getStream(), length);
+    DeserializationError error = filter
+        ? deserializeJson(doc, reader, DeserializationOption::Filter(*filter))
+        : deserializeJson(doc, reader);
+    reader.drain();
+    return error;
+}
+
+void httpPoolStatsToJson(JsonObject out) {
+    portENTER_CRITICAL(&statsMux);
+    HttpPoolStats copy = stats;
+    portEXIT_CRITICAL(&statsMux);
+
+    out["requests"] = copy.requests;
+    out["reused"] = copy.reused;
+    out["connects"] = copy.connects;
+    out["connectFailures"] = copy.connectFailures;
+    out["deadConnections"] = copy.deadConnections;
+    out["expired"] = copy.expired;
+    out["connectAvgUs"] = copy.connects > 0 ? (uint32_t)(copy.connectUsTotal / copy.connects) : 0;
+    out["connectMaxUs"] = copy.connectUsMax;
+}
@@ -0,0 +1,47 @@
+#ifndef HTTPPOOL_H
+#define HTTPPOOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+
+// Keep-alive connections for the Spoolman API, shared by all tasks. A lease
+// borrows a connection to the URL's host (reusing an open one when possible)
+// and hands it back when it goes out of scope. https URLs are not pooled.
+#define HTTP_POOL_SIZE          2
+#define HTTP_POOL_MAX_IDLE_MS   20000   // connections idle longer are closed before reuse
+#define HTTP_POOL_WAIT_MS       15000   // longest wait for a free connection
+
+struct HttpPoolSlot;
+
+class HttpPoolLease {
+public:
+    HttpPoolLease(const String& url, uint16_t timeoutMs = 10000);
+    ~HttpPoolLease();
+
+    bool valid() const { return _valid; }
+    HTTPClient& http() { return *_http; }
+
+    // sendRequest() that reconnects once if a reused connection turned out dead
+    int send(const char* method, const String& payload = "");
+
+    // Parses the response body straight from the connection, keeping only
+    // what the filter selects (everything without one)
+    DeserializationError readJson(JsonDocument& doc, const JsonDocument* filter = nullptr);
+
+private:
+    HttpPoolLease(const HttpPoolLease&);
+    HttpPoolLease& operator=(const HttpPoolLease&);
+
+    HttpPoolSlot* _slot;
+    HTTPClient* _http;
+    HTTPClient _unpooled;
+    uint16_t _timeoutMs;
+    bool _valid;
+};
+
+void initHttpPool();
+void httpPoolStatsToJson(JsonObject stats);
+
+#endif
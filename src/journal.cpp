@@ -0,0 +1,378 @@
+#include "journal.h"
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+
+#define JOURNAL_FILE        "/journal.bin"
+#define JOURNAL_TMP_FILE    "/journal.tmp"
+#define JOURNAL_MAGIC       0x4A52      // "JR"
+#define JOURNAL_BODY_MAX    512
+
+#define JOURNAL_RECORD_ENTRY    1
+#define JOURNAL_RECORD_ACK      2
+
+// On flash: the header, then method, path and payload, each NUL terminated
+struct JournalRecordHeader {
+    uint16_t magic;
+    uint8_t kind;
+    uint8_t requestType;
+    uint32_t seq;
+    uint16_t targetId;
+    uint16_t bodyLen;
+    uint32_t crc;               // over the header (crc = 0) and the body
+};
+
+struct JournalPending {
+    uint32_t seq;
+    uint32_t offset;            // of the record in the file
+    uint16_t targetId;
+    uint8_t requestType;
+    bool inFlight;              // queued on the API worker, live or replayed
+};
+
+struct JournalStats {
+    uint32_t appended;
+    uint32_t coalesced;
+    uint32_t flushed;
+    uint32_t replayed;
+    uint32_t rejected;          // journal full
+    uint32_t flushFailures;
+    unsigned long windowStart;
+    uint32_t windowFlushed;
+    uint32_t lastWindowFlushed; // acked in the last full minute
+};
+
+static SemaphoreHandle_t journalMutex = NULL;
+static JournalPending pending[JOURNAL_MAX_ENTRIES];
+static uint8_t pendingCount = 0;
+static uint32_t nextSeq = 1;
+static uint32_t fileBytes = 0;
+static JournalStats stats = {};
+static volatile bool lastReplayOk = false;
+
+static uint32_t recordCrc(JournalRecordHeader header, const uint8_t* body, uint16_t bodyLen) {
+    header.crc = 0;
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)&header, sizeof(header));
+    return esp_rom_crc32_le(crc, body, bodyLen);
+}
+
+static int findPending(uint32_t seq) {
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        if (pending[i].seq == seq) return i;
+    }
+    return -1;
+}
+
+static int findPendingKey(uint8_t requestType, uint16_t targetId) {
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        if (pending[i].requestType == requestType && pending[i].targetId == targetId) return i;
+    }
+    return -1;
+}
+
+static void removePending(int index) {
+    pending[index] = pending[--pendingCount];
+}
+
+static bool appendRecord(JournalRecordHeader& header, const uint8_t* body, uint32_t& offset) {
+    header.magic = JOURNAL_MAGIC;
+    header.crc = recordCrc(header, body, header.bodyLen);
+
+    File file = LittleFS.open(JOURNAL_FILE, "a");
+    if (!file) return false;
+    offset = file.size();
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write(body, header.bodyLen) == header.bodyLen;
+    // Closing commits the write to flash
+    file.close();
+    if (ok) fileBytes = offset + sizeof(header) + header.bodyLen;
+    return ok;
+}
+
+// Header and body of a record, false if it is torn or corrupt
+static bool readRecord(File& file, JournalRecordHeader& header, uint8_t* body) {
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) return false;
+    if (header.magic != JOURNAL_MAGIC || header.bodyLen > JOURNAL_BODY_MAX) return false;
+    if (file.read(body, header.bodyLen) != header.bodyLen) return false;
+    return header.crc == recordCrc(header, body, header.bodyLen);
+}
+
+// Rewrites the file with the pending entries only
+static void compactLocked() {
+    if (pendingCount == 0) {
+        LittleFS.remove(JOURNAL_FILE);
+        fileBytes = 0;
+        return;
+    }
+
+    File source = LittleFS.open(JOURNAL_FILE, "r");
+    File target = LittleFS.open(JOURNAL_TMP_FILE, "w");
+    if (!source || !target) {
+        if (source) source.close();
+        if (target) target.close();
+        return;
+    }
+
+    uint8_t body[JOURNAL_BODY_MAX];
+    uint32_t offsets[JOURNAL_MAX_ENTRIES];
+    uint32_t offset = 0;
+    bool ok = true;
+    for (uint8_t i = 0; i < pendingCount && ok; i++) {
+        JournalRecordHeader header;
+        ok = source.seek(pending[i].offset) && readRecord(source, header, body) &&
+             target.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+             target.write(body, header.bodyLen) == header.bodyLen;
+        offsets[i] = offset;
+        offset += sizeof(header) + header.bodyLen;
+    }
+    source.close();
+    target.close();
+
+    if (!ok) {
+        LittleFS.remove(JOURNAL_TMP_FILE);
+        Serial.println("Journal: compaction failed");
+        return;
+    }
+    LittleFS.remove(JOURNAL_FILE);
+    LittleFS.rename(JOURNAL_TMP_FILE, JOURNAL_FILE);
+    for (uint8_t i = 0; i < pendingCount; i++) pending[i].offset = offsets[i];
+    fileBytes = offset;
+}
+
+uint32_t journalAppend(SpoolmanApiRequestType requestType, uint16_t targetId,
+                       const char* method, const String& path, const String& payload) {
+    if (journalMutex == NULL) return 0;
+
+    size_t methodLen = strlen(method) + 1;
+    size_t bodyLen = methodLen + path.length() + 1 + payload.length() + 1;
+    if (bodyLen > JOURNAL_BODY_MAX) return 0;
+
+    uint8_t body[JOURNAL_BODY_MAX];
+    memcpy(body, method, methodLen);
+    memcpy(body + methodLen, path.c_str(), path.length() + 1);
+    memcpy(body + methodLen + path.length() + 1, payload.c_str(), payload.length() + 1);
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+
+    // Only the latest update per spool and kind is worth sending
+    int older = findPendingKey(requestType, targetId);
+    if (older >= 0) {
+        removePending(older);
+        stats.coalesced++;
+    }
+
+    if (fileBytes + sizeof(JournalRecordHeader) + bodyLen > JOURNAL_MAX_BYTES) compactLocked();
+    if (pendingCount >= JOURNAL_MAX_ENTRIES ||
+        fileBytes + sizeof(JournalRecordHeader) + bodyLen > JOURNAL_MAX_BYTES) {
+        stats.rejected++;
+        xSemaphoreGive(journalMutex);
+        Serial.println("Journal: full, update is sent without journal");
+        return 0;
+    }
+
+    JournalRecordHeader header = {};
+    header.kind = JOURNAL_RECORD_ENTRY;
+    header.requestType = requestType;
+    header.seq = nextSeq;
+    header.targetId = targetId;
+    header.bodyLen = bodyLen;
+
+    uint32_t seq = 0;
+    uint32_t offset;
+    if (appendRecord(header, body, offset)) {
+        seq = nextSeq++;
+        pending[pendingCount++] = { seq, offset, targetId, (uint8_t)requestType, true };
+        stats.appended++;
+    }
+    xSemaphoreGive(journalMutex);
+    return seq;
+}
+
+void journalAck(uint32_t seq) {
+    if (journalMutex == NULL || seq == 0) return;
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    int index = findPending(seq);
+    if (index >= 0) {
+        removePending(index);
+        stats.flushed++;
+        stats.windowFlushed++;
+        if (pendingCount == 0) {
+            compactLocked();
+        } else {
+            JournalRecordHeader header = {};
+            header.kind = JOURNAL_RECORD_ACK;
+            header.seq = seq;
+            uint32_t offset;
+            appendRecord(header, nullptr, offset);
+        }
+    }
+    xSemaphoreGive(journalMutex);
+}
+
+void journalRelease(uint32_t seq) {
+    if (journalMutex == NULL || seq == 0) return;
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    int index = findPending(seq);
+    if (index >= 0) pending[index].inFlight = false;
+    xSemaphoreGive(journalMutex);
+}
+
+bool journalIsCurrent(uint32_t seq) {
+    if (journalMutex == NULL) return false;
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    bool current = findPending(seq) >= 0;
+    xSemaphoreGive(journalMutex);
+    return current;
+}
+
+bool journalRead(uint32_t seq, SpoolmanApiRequestType& requestType, String& method, String& path, String& payload) {
+    if (journalMutex == NULL) return false;
+
+    uint8_t body[JOURNAL_BODY_MAX + 1];
+    JournalRecordHeader header;
+    bool ok = false;
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    int index = findPending(seq);
+    if (index >= 0) {
+        File file = LittleFS.open(JOURNAL_FILE, "r");
+        ok = file && file.seek(pending[index].offset) && readRecord(file, header, body);
+        if (file) file.close();
+    }
+    xSemaphoreGive(journalMutex);
+    if (!ok) return false;
+
+    body[header.bodyLen] = '\0';
+    const char* text = (const char*)body;
+    requestType = (SpoolmanApiRequestType)header.requestType;
+    method = text;
+    text += method.length() + 1;
+    path = text;
+    text += path.length() + 1;
+    payload = text;
+    return true;
+}
+
+void journalClear() {
+    if (journalMutex == NULL) return;
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    pendingCount = 0;
+    compactLocked();
+    xSemaphoreGive(journalMutex);
+}
+
+// Oldest entry nobody is sending, marked in flight
+static uint32_t takeNext() {
+    uint32_t seq = 0;
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    int oldest = -1;
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        if (!pending[i].inFlight && (oldest < 0 || pending[i].seq < pending[oldest].seq)) oldest = i;
+    }
+    if (oldest >= 0) {
+        pending[oldest].inFlight = true;
+        seq = pending[oldest].seq;
+        stats.replayed++;
+    }
+    xSemaphoreGive(journalMutex);
+    return seq;
+}
+
+// Entries of the previous boot; a torn record at the end stops the scan
+static void loadJournalLocked() {
+    File file = LittleFS.open(JOURNAL_FILE, "r");
+    if (!file) return;
+
+    uint8_t body[JOURNAL_BODY_MAX];
+    JournalRecordHeader header;
+    uint32_t offset = 0;
+    while (readRecord(file, header, body)) {
+        if (header.kind == JOURNAL_RECORD_ENTRY) {
+            int older = findPendingKey(header.requestType, header.targetId);
+            if (older >= 0) removePending(older);
+            if (pendingCount < JOURNAL_MAX_ENTRIES) {
+                pending[pendingCount++] = { header.seq, offset, header.targetId, header.requestType, false };
+            }
+        } else {
+            int index = findPending(header.seq);
+            if (index >= 0) removePending(index);
+        }
+        if (header.seq >= nextSeq) nextSeq = header.seq + 1;
+        offset += sizeof(header) + header.bodyLen;
+    }
+    file.close();
+
+    fileBytes = offset;
+    compactLocked();
+    if (pendingCount > 0) {
+        Serial.printf("Journal: %u Spoolman updates to replay\n", pendingCount);
+    }
+}
+
+static void journalReplayDone(SpoolmanApiRequestType requestType, bool success, void* context) {
+    lastReplayOk = success;
+    xTaskNotifyGive((TaskHandle_t)context);
+}
+
+// Replays one entry at a time through the API worker while Spoolman is up
+static void journalFlushTask(void *parameter) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(JOURNAL_FLUSH_INTERVAL_MS));
+
+        xSemaphoreTake(journalMutex, portMAX_DELAY);
+        if (millis() - stats.windowStart >= 60000UL) {
+            stats.lastWindowFlushed = stats.windowFlushed;
+            stats.windowFlushed = 0;
+            stats.windowStart = millis();
+        }
+        xSemaphoreGive(journalMutex);
+
+        while (spoolmanConnected) {
+            uint32_t seq = takeNext();
+            if (seq == 0) break;
+            if (!queueJournalReplay(seq, journalReplayDone, xTaskGetCurrentTaskHandle())) break;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (!lastReplayOk) {
+                // Back off until the next interval
+                stats.flushFailures++;
+                break;
+            }
+        }
+    }
+}
+
+void initJournal() {
+    if (journalMutex != NULL) return;
+    journalMutex = xSemaphoreCreateMutex();
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    loadJournalLocked();
+    stats.windowStart = millis();
+    xSemaphoreGive(journalMutex);
+
+    xTaskCreate(journalFlushTask, "JournalFlushTask", 4096, NULL, 0, NULL);
+}
+
+void journalStatsToJson(JsonObject out) {
+    if (journalMutex == NULL) return;
+
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    JournalStats copy = stats;
+    uint8_t depth = pendingCount;
+    uint32_t bytes = fileBytes;
+    xSemaphoreGive(journalMutex);
+
+    out["depth"] = depth;
+    out["capacity"] = JOURNAL_MAX_ENTRIES;
+    out["bytes"] = bytes;
+    out["appended"] = copy.appended;
+    out["coalesced"] = copy.coalesced;
+    out["flushed"] = copy.flushed;
+    out["replayed"] = copy.replayed;
+    out["rejected"] = copy.rejected;
+    out["flushFailures"] = copy.flushFailures;
+    out["flushedPerMinute"] = copy.lastWindowFlushed;
+}
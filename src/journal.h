@@ -0,0 +1,27 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "api.h"
+
+// Write-ahead journal of Spoolman updates (weight, location, nfc_id and Bambu
+// extras) on LittleFS. An update is journaled before it is sent and acked
+// once Spoolman accepted it. Whatever is left, also after a reboot, is
+// replayed when Spoolman is reachable. A newer update of the same kind for
+// the same spool (filament for Bambu extras) replaces one not yet sent.
+#define JOURNAL_MAX_ENTRIES         32
+#define JOURNAL_MAX_BYTES           8192    // compacted before it grows larger
+#define JOURNAL_FLUSH_INTERVAL_MS   10000UL
+
+void initJournal();
+uint32_t journalAppend(SpoolmanApiRequestType requestType, uint16_t targetId,
+                       const char* method, const String& path, const String& payload); // 0 if not journaled
+void journalAck(uint32_t seq);          // accepted by Spoolman (or rejected for good)
+void journalRelease(uint32_t seq);      // not sent, left to the flusher
+bool journalIsCurrent(uint32_t seq);    // neither acked nor replaced meanwhile
+bool journalRead(uint32_t seq, SpoolmanApiRequestType& requestType, String& method, String& path, String& payload);
+void journalClear();                    // Spoolman URL changed
+void journalStatsToJson(JsonObject stats);
+
+#endif
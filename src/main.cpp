@@ -15,6 +15,12 @@
 #include <esp_idf_version.h>
 #endif
 #include "commonFS.h"
+#include "events.h"
+#include "scantrace.h"
+#include "httppool.h"
+#include "spoolmirror.h"
+#include "journal.h"
+#include "brandcache.h"
 
 bool mainTaskWasPaused = 0;
 uint8_t scaleTareCounter = 0;
@@ -23,6 +29,15 @@ bool booting = true;
 unsigned long lastHeartbeat = 0;
 const unsigned long HEARTBEAT_INTERVAL = 60000; // 60 seconds
 
+#ifndef DISABLE_SCALE
+// Touch sensor pressed: tare request for the main loop
+void IRAM_ATTR touchSensorIsr() {
+  AppEvent event = {};
+  event.type = EVENT_TARE_BUTTON;
+  postEventFromIsr(event);
+}
+#endif
+
 // ##### SETUP #####
 void setup() {
   Serial.begin(115200);
@@ -33,6 +48,13 @@ void setup() {
   Serial.printf("ESP32 Chip ID = %04X", (uint16_t)(chipid >> 32)); //print High 2 bytes
   Serial.printf("%08X\n", (uint32_t)chipid); //print Low 4bytes.
 
+  // Event queue between the tasks and the main loop
+  initEvents();
+  // Keep-alive connections for Spoolman
+  initHttpPool();
+  // Single task sending all Spoolman requests
+  initApiWorker();
+
   // Initialize SPIFFS
   initializeFileSystem();
 
@@ -47,6 +69,12 @@ void setup() {
 
   // Spoolman API
   initSpoolman();
+  // Local copy of the spools, needs the Spoolman URL
+  initSpoolMirror();
+  // Spoolman updates not yet sent, replayed once Spoolman is reachable
+  initJournal();
+  // Vendor and filament IDs of brand-filament tags
+  initBrandCache();
 
   // Moonraker/Klipper
   loadMoonrakerUrl();
@@ -70,6 +98,7 @@ void setup() {
   {
     Serial.println("Touch Sensor is connected");
     touchSensorConnected = true;
+    attachInterrupt(digitalPinToInterrupt(TTP223_PIN), touchSensorIsr, RISING);
   }
 
   // Scale
@@ -110,15 +139,14 @@ bool intervalElapsed(unsigned long currentTime, unsigned long &lastTime, unsigne
   return false;
 }
 
-unsigned long lastWeightReadTime = 0;
-const unsigned long weightReadInterval = 1000; // 1 second
-
 unsigned long lastAutoSetBambuAmsTime = 0;
 const unsigned long autoSetBambuAmsInterval = 1000; // 1 second
 uint8_t autoAmsCounter = 0;
 
-uint8_t weightSend = 0;
-int16_t lastWeight = 0;
+// Spool on the reader whose weight has not been sent yet, 0 = none
+uint32_t pendingSpoolId = 0;
+// Last weight reported stable by the scale, 0 while the weight is moving
+int16_t stableWeight = 0;
 
 // WIFI check variables
 unsigned long lastWifiCheckTime = 0;
@@ -129,18 +157,132 @@ unsigned long lastSpoolmanHealcheckTime = 0;
 unsigned long lastButtonPress = 0;
 const unsigned long debounceDelay = 500; // 500 ms debounce delay
 
+/**
+ * Time until an interval elapses, 0 if it already has
+ */
+unsigned long timeUntil(unsigned long currentTime, unsigned long lastTime, unsigned long interval) {
+  unsigned long elapsed = currentTime - lastTime;
+  return (elapsed >= interval) ? 0 : interval - elapsed;
+}
+
+// When a tag with SM id was read and the weight is stable, send to SM
+void sendPendingSpoolWeight() {
+  if (pendingSpoolId == 0 || stableWeight == 0 || !scaleCalibrated) return;
+  // Retried on the next API result; the API worker queues behind running requests
+  if (nfcWriteInProgress) return;
+
+  uint32_t spoolId = pendingSpoolId;
+  pendingSpoolId = 0;
+
+  scanTraceMark(SCAN_PHASE_WEIGHT);
+  if (updateSpoolWeight(String(spoolId), stableWeight, true)) 
+  {
+    // Set Bambu spool ID for auto-send if enabled
+    if (bambuCredentials.autosend_enable) 
+    {
+      autoSetToBambuSpoolId = spoolId;
+    }
+    if (octoEnabled) 
+    {
+      updateOctoSpoolId = spoolId;
+    }
+    // Notify Moonraker of active spool change
+    if (moonrakerEnabled) {
+      updateSpoolMoonraker(spoolId);
+    }
+    // Notify PrintFarmer of active spool change
+    if (printFarmerEnabled) {
+      updateSpoolPrintFarmer(spoolId);
+      SpoolMirrorEntry spool;
+      if (spoolMirrorFind(spoolId, spool)) {
+        sendPrintFarmerScanEvent(spoolId, "nfc", spool.material, spool.brand);
+      } else {
+        sendPrintFarmerScanEvent(spoolId, "nfc", "", "");
+      }
+    }
+  }
+  else
+  {
+    scanTraceFinish(false);
+    oledShowIcon("failed");
+    vTaskDelay(2000 / portTICK_PERIOD_MS);
+  }
+}
+
+void handleEvent(const AppEvent& event) {
+  switch (event.type) {
+    case EVENT_TAG_READ:
+      pendingSpoolId = event.spoolId;
+      sendPendingSpoolWeight();
+      break;
+
+    case EVENT_TAG_WRITTEN:
+      // The write task already sent the weight of the written spool, and a
+      // spool read before the write is no longer on the reader
+      pendingSpoolId = 0;
+      break;
+
+    case EVENT_TAG_REMOVED:
+      pendingSpoolId = 0;
+      break;
+
+    case EVENT_WEIGHT_CHANGED:
+      if (stableWeight != 0 && abs(event.weight - stableWeight) > SCALE_STABLE_TOLERANCE) {
+        stableWeight = 0;
+      }
+      // Display weight on screen, blocked during NFC write operations
+      if (scaleCalibrated && pauseMainTask == 0 && !nfcWriteInProgress &&
+          nfcReaderState == NFC_IDLE && (!bambuCredentials.autosend_enable || autoSetToBambuSpoolId == 0))
+      {
+        // Use filtered weight for smooth display
+        int16_t displayWeight = getFilteredDisplayWeight();
+        (displayWeight < 2) ? ((displayWeight < -2) ? oledShowMessage("!! -0") : oledShowWeight(0)) : oledShowWeight(displayWeight);
+      }
+      break;
+
+    case EVENT_WEIGHT_STABLE:
+      stableWeight = event.weight;
+      sendPendingSpoolWeight();
+      break;
+
+    case EVENT_API_RESULT:
+      sendPendingSpoolWeight();
+      break;
+
+    case EVENT_TRAY_CHANGED:
+      // When Bambu auto set Spool is active
+      if (bambuCredentials.autosend_enable && autoSetToBambuSpoolId > 0) {
+        autoSetSpool(autoSetToBambuSpoolId, event.trayId);
+      }
+      break;
+
+    case EVENT_TARE_BUTTON:
+      if (millis() - lastButtonPress > debounceDelay) {
+        lastButtonPress = millis();
+        scaleTareRequest = true;
+      }
+      break;
+  }
+}
+
 // ##### PROGRAM START #####
 void loop() {
   unsigned long currentMillis = millis();
 
-#ifndef DISABLE_SCALE
-  // Check touch sensor status
-  if (touchSensorConnected && digitalRead(TTP223_PIN) == HIGH && currentMillis - lastButtonPress > debounceDelay) 
-  {
-    lastButtonPress = currentMillis;
-    scaleTareRequest = true;
+  // Sleep until an event arrives or the next periodic job is due
+  unsigned long timeout = timeUntil(currentMillis, lastTopRowUpdateTime, DISPLAY_UPDATE_INTERVAL);
+  if (bambuCredentials.autosend_enable && autoSetToBambuSpoolId > 0) {
+    timeout = min(timeout, timeUntil(currentMillis, lastAutoSetBambuAmsTime, autoSetBambuAmsInterval));
   }
-#endif
+
+  AppEvent event;
+  if (waitForEvent(event, timeout)) {
+    do {
+      handleEvent(event);
+      esp_task_wdt_reset();
+    } while (waitForEvent(event, 0));
+  }
+  currentMillis = millis();
 
   // Regularly check WiFi connection
   if (intervalElapsed(currentMillis, lastWifiCheckTime, WIFI_CHECK_INTERVAL)) 
@@ -167,7 +309,7 @@ void loop() {
     sendPrintFarmerHeartbeat();
   }
 
-  // When Bambu auto set Spool is active
+  // Auto set countdown while the Bambu auto set Spool is armed
   if (bambuCredentials.autosend_enable && autoSetToBambuSpoolId > 0 && !nfcWriteInProgress) 
   {
     if (!bambuDisabled && !bambu_connected) 
@@ -179,7 +321,6 @@ void loop() {
     {
       if (nfcReaderState == NFC_IDLE)
       {
-        lastAutoSetBambuAmsTime = currentMillis;
         oledShowMessage("Auto Set         " + String(bambuCredentials.autosend_time - autoAmsCounter) + "s");
         autoAmsCounter++;
 
@@ -205,114 +346,18 @@ void loop() {
     // Do not show the warning if the calibratin process is onging
     if(!scaleCalibrationActive){
       oledShowMessage("Scale not calibrated");
-      vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
   } 
-  else 
+  else if (pauseMainTask != 0 || nfcWriteInProgress)
   {
-    // Display weight on screen
-    // Block weight display during NFC write operations
-    if(pauseMainTask == 0 && !nfcWriteInProgress)
-    {
-      // Use filtered weight for smooth display, but still check API weight for significant changes
-      int16_t displayWeight = getFilteredDisplayWeight();
-      if (mainTaskWasPaused || (weight != lastWeight && nfcReaderState == NFC_IDLE && (!bambuCredentials.autosend_enable || autoSetToBambuSpoolId == 0)))
-      {
-        (displayWeight < 2) ? ((displayWeight < -2) ? oledShowMessage("!! -0") : oledShowWeight(0)) : oledShowWeight(displayWeight);
-      }
-      mainTaskWasPaused = false;
-    }
-    else
-    {
-      mainTaskWasPaused = true;
-    }
-
-
-    // When timer expired and not currently writing an RFID tag
-    if (currentMillis - lastWeightReadTime >= weightReadInterval && nfcReaderState < NFC_WRITING)
-    {
-      lastWeightReadTime = currentMillis;
-
-      // Check if weight remains stable then send
-      if (abs(weight - lastWeight) <= 2 && weight > 5)
-      {
-        weightCounterToApi++;
-      } 
-      else 
-      {
-        weightCounterToApi = 0;
-        weightSend = 0;
-      }
-    }
-
-    // reset weight counter after writing tag
-    if (currentMillis - lastWeightReadTime >= weightReadInterval && nfcReaderState != NFC_IDLE && nfcReaderState != NFC_READ_SUCCESS)
-    {
-      weightCounterToApi = 0;
-    }
-    
-    lastWeight = weight;
-
-    // When a tag with SM id was detected and weight counter triggers, send to SM
-    if (activeSpoolId != "" && weightCounterToApi > 3 && weightSend == 0 && nfcReaderState == NFC_READ_SUCCESS && tagProcessed == false && spoolmanApiState == API_IDLE) 
-    {
-      // set the current tag as processed to prevent it beeing processed again
-      tagProcessed = true;
-
-      if (updateSpoolWeight(activeSpoolId, weight)) 
-      {
-        weightSend = 1;
-        
-        // Set Bambu spool ID for auto-send if enabled
-        if (bambuCredentials.autosend_enable) 
-        {
-          autoSetToBambuSpoolId = activeSpoolId.toInt();
-        }
-        if (octoEnabled) 
-        {
-          updateOctoSpoolId = activeSpoolId.toInt();
-        }
-        // Notify Moonraker of active spool change
-        if (moonrakerEnabled) {
-          updateSpoolMoonraker(activeSpoolId.toInt());
-        }
-        // Notify PrintFarmer of active spool change
-        if (printFarmerEnabled) {
-          updateSpoolPrintFarmer(activeSpoolId.toInt());
-          sendPrintFarmerScanEvent(activeSpoolId.toInt(), "nfc", "", "");
-        }
-      }
-      else
-      {
-        oledShowIcon("failed");
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
-      }
-    }
-
-    // Handle successful tag write: Send weight to Spoolman but NEVER auto-send to Bambu
-    if (activeSpoolId != "" && weightCounterToApi > 3 && weightSend == 0 && nfcReaderState == NFC_WRITE_SUCCESS && tagProcessed == false && spoolmanApiState == API_IDLE) 
-    {
-      // set the current tag as processed to prevent it beeing processed again
-      tagProcessed = true;
-
-      if (updateSpoolWeight(activeSpoolId, weight)) 
-      {
-        weightSend = 1;
-        Serial.println("Tag written: Weight sent to Spoolman, but NO auto-send to Bambu");
-        // INTENTIONALLY do NOT set autoSetToBambuSpoolId here to prevent Bambu auto-send
-      }
-      else
-      {
-        oledShowIcon("failed");
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
-      }
-    }
-
-    if(octoEnabled && sendOctoUpdate && spoolmanApiState == API_IDLE)
-    {
-      updateSpoolOcto(updateOctoSpoolId);
-      sendOctoUpdate = false;
-    }
+    mainTaskWasPaused = true;
+  }
+  else if (mainTaskWasPaused)
+  {
+    // Show the weight again after calibration or a tag write
+    int16_t displayWeight = getFilteredDisplayWeight();
+    (displayWeight < 2) ? ((displayWeight < -2) ? oledShowMessage("!! -0") : oledShowWeight(0)) : oledShowWeight(displayWeight);
+    mainTaskWasPaused = false;
   }
   
   esp_task_wdt_reset();
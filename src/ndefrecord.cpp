@@ -0,0 +1,120 @@
+#include "ndefrecord.h"
+
+bool parseNdefRecord(const uint8_t* buffer, uint16_t size, NdefRecordView& record) {
+    uint32_t pos = 0;
+    uint32_t messageStart = 0;
+    uint32_t messageLength = 0;
+    bool found = false;
+
+    // Skip NULL, lock control and memory control TLVs
+    while (pos < size) {
+        uint8_t tlvType = buffer[pos];
+        if (tlvType == 0x00) { pos++; continue; }
+        if (tlvType == 0xFE || pos + 1 >= size) break;
+
+        uint32_t tlvLength = buffer[pos + 1];
+        uint32_t valueOffset = pos + 2;
+        if (tlvLength == 0xFF) {
+            if (pos + 3 >= size) break;
+            tlvLength = (buffer[pos + 2] << 8) | buffer[pos + 3];
+            valueOffset = pos + 4;
+        }
+
+        if (tlvType == 0x03) {
+            messageStart = valueOffset;
+            messageLength = tlvLength;
+            found = true;
+            break;
+        }
+        pos = valueOffset + tlvLength;
+    }
+
+    if (!found) {
+        Serial.println("No NDEF TLV found in tag data");
+        return false;
+    }
+    Serial.printf("NDEF TLV at offset %u, message length %u\n", messageStart - 2, messageLength);
+
+    uint32_t messageEnd = messageStart + messageLength;
+    if (messageEnd > size || messageLength < 3) {
+        Serial.println("Invalid NDEF structure - message extends beyond tag data");
+        return false;
+    }
+
+    const uint8_t* ndefRecord = buffer + messageStart;
+    record.header = ndefRecord[0];
+    uint8_t typeLength = ndefRecord[1];
+
+    // Payload length is 1 byte for short records (SR), 4 bytes otherwise
+    uint32_t offset = 2;
+    uint32_t payloadLength = 0;
+    if (record.header & 0x10) {
+        payloadLength = ndefRecord[offset++];
+    } else {
+        if (offset + 4 > messageLength) return false;
+        payloadLength = ((uint32_t)ndefRecord[2] << 24) | ((uint32_t)ndefRecord[3] << 16) |
+                        ((uint32_t)ndefRecord[4] << 8) | ndefRecord[5];
+        offset += 4;
+    }
+
+    // ID length follows when the IL flag is set
+    uint8_t idLength = 0;
+    if (record.header & 0x08) {
+        if (offset >= messageLength) return false;
+        idLength = ndefRecord[offset++];
+    }
+
+    uint32_t payloadOffset = offset + typeLength + idLength;
+    Serial.printf("NDEF record header 0x%02X, type length %u, payload %u bytes at %u\n",
+                  record.header, typeLength, payloadLength, payloadOffset);
+
+    if (payloadOffset > messageLength || payloadLength > messageLength - payloadOffset) {
+        Serial.printf("Invalid NDEF structure - payload extends beyond message (%u > %u)\n",
+                      payloadOffset + payloadLength, messageLength);
+        return false;
+    }
+
+    record.type = { ndefRecord + offset, typeLength };
+    record.payload = { ndefRecord + payloadOffset, payloadLength };
+    return true;
+}
+
+static bool isJsonSpace(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+ByteSpan jsonObjectSpan(const ByteSpan& payload, bool& complete) {
+    uint32_t start = 0;
+    while (start < payload.length && isJsonSpace(payload.data[start])) start++;
+
+    int depth = 0;
+    bool inString = false;
+    bool escape = false;
+    uint32_t end = start;
+    complete = false;
+
+    for (; end < payload.length; end++) {
+        uint8_t c = payload.data[end];
+        if (c == 0x00) break;
+
+        if (inString) {
+            if (escape) escape = false;
+            else if (c == '\\') escape = true;
+            else if (c == '"') inString = false;
+            continue;
+        }
+
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{') {
+            depth++;
+        } else if (c == '}' && --depth == 0) {
+            end++;
+            complete = true;
+            break;
+        }
+    }
+
+    while (end > start && isJsonSpace(payload.data[end - 1])) end--;
+    return { payload.data + start, end - start };
+}
@@ -0,0 +1,26 @@
+#ifndef NDEFRECORD_H
+#define NDEFRECORD_H
+
+#include <Arduino.h>
+
+// Byte range inside the tag buffer; records are parsed in place, not copied
+struct ByteSpan {
+    const uint8_t* data;
+    uint32_t length;
+};
+
+struct NdefRecordView {
+    uint8_t header;
+    ByteSpan type;
+    ByteSpan payload;
+};
+
+// Locate the first record of the NDEF TLV in a buffer starting at page 4.
+// Every offset is checked against size and the TLV length.
+bool parseNdefRecord(const uint8_t* buffer, uint16_t size, NdefRecordView& record);
+
+// The JSON object at the start of a payload. It ends at its closing brace, a
+// NUL byte or the end of the payload; braces inside strings are ignored.
+ByteSpan jsonObjectSpan(const ByteSpan& payload, bool& complete);
+
+#endif
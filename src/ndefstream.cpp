@@ -0,0 +1,381 @@
+#include "ndefstream.h"
+
+#define TLV_NULL        0x00
+#define TLV_NDEF        0x03
+#define TLV_TERMINATOR  0xFE
+
+#define NDEF_FLAG_ME    0x40
+#define NDEF_FLAG_SR    0x10
+#define NDEF_FLAG_IL    0x08
+
+NdefStreamDecoder::NdefStreamDecoder(NdefStreamCallback callback, void* context)
+    : _callback(callback), _context(context) {
+    reset();
+}
+
+void NdefStreamDecoder::reset() {
+    _state = STATE_TLV_TYPE;
+    _offset = 0;
+    _tlvType = 0;
+    _tlvLength = 0;
+    _tlvRemaining = 0;
+    _bytesNeeded = 0;
+    _recordHeader = 0;
+    _typeLength = 0;
+    _idLength = 0;
+    _payloadLength = 0;
+    _fieldRemaining = 0;
+    _lengthBytes = 0;
+    _recordType[0] = '\0';
+    _recordTypeLength = 0;
+    _firstRecord = true;
+    _firstPayloadOffset = 0;
+    _firstPayloadLength = 0;
+    _json = false;
+    _jsonStarted = false;
+    _jsonDepth = 0;
+    _jsonInString = false;
+    _jsonEscape = false;
+    _jsonHaveKey = false;
+    _jsonInValue = false;
+    _jsonTruncated = false;
+    _keyLength = 0;
+    _valueLength = 0;
+}
+
+void NdefStreamDecoder::push(const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length && _state != STATE_DONE && _state != STATE_ERROR; i++) {
+        consume(data[i]);
+        _offset++;
+    }
+}
+
+void NdefStreamDecoder::emit(NdefStreamEvent& event) {
+    if (_callback) _callback(event, _context);
+}
+
+void NdefStreamDecoder::fail(const char* error) {
+    _state = STATE_ERROR;
+    NdefStreamEvent event = {};
+    event.type = NDEF_EVENT_ERROR;
+    event.error = error;
+    emit(event);
+}
+
+static void emitMessageEnd(NdefStreamCallback callback, void* context) {
+    NdefStreamEvent event = {};
+    event.type = NDEF_EVENT_MESSAGE_END;
+    if (callback) callback(event, context);
+}
+
+// ##### TLV level #####
+void NdefStreamDecoder::afterTlvLength() {
+    _tlvRemaining = _tlvLength;
+
+    if (_tlvType != TLV_NDEF) {
+        // Lock / memory control and proprietary TLVs are skipped
+        _state = _tlvLength ? STATE_TLV_SKIP : STATE_TLV_TYPE;
+        return;
+    }
+
+    // Value starts after this byte, plus the terminator TLV behind it
+    _bytesNeeded = _offset + 1 + _tlvLength + 1;
+    if (_tlvLength == 0) {
+        _state = STATE_DONE;
+        emitMessageEnd(_callback, _context);
+        return;
+    }
+    _state = STATE_RECORD_HEADER;
+}
+
+// ##### Record level #####
+// Called once payload length and ID length are known
+void NdefStreamDecoder::afterRecordField() {
+    if ((uint32_t)_typeLength + _idLength > _tlvRemaining) {
+        fail("record header extends beyond message");
+        return;
+    }
+
+    _recordTypeLength = 0;
+    _fieldRemaining = _typeLength;
+    if (_typeLength > 0) {
+        _state = STATE_TYPE;
+        return;
+    }
+    _recordType[0] = '\0';
+    _fieldRemaining = _idLength;
+    if (_idLength > 0) {
+        _state = STATE_ID;
+        return;
+    }
+    startPayload();
+}
+
+void NdefStreamDecoder::startPayload() {
+    if (_payloadLength > _tlvRemaining) {
+        fail("payload extends beyond message");
+        return;
+    }
+
+    NdefStreamEvent event = {};
+    event.type = NDEF_EVENT_RECORD;
+    event.recordType = _recordType;
+    event.payloadLength = _payloadLength;
+    emit(event);
+    if (_state == STATE_ERROR) return;
+
+    if (_firstRecord) {
+        _firstPayloadOffset = _offset + 1;
+        _firstPayloadLength = _payloadLength;
+    }
+
+    _json = strcmp(_recordType, "application/json") == 0;
+    _jsonStarted = false;
+    _jsonDepth = 0;
+    _jsonInString = false;
+    _jsonEscape = false;
+    _jsonHaveKey = false;
+    _jsonInValue = false;
+
+    _fieldRemaining = _payloadLength;
+    if (_payloadLength == 0) {
+        endRecord();
+        return;
+    }
+    _state = STATE_PAYLOAD;
+}
+
+void NdefStreamDecoder::endRecord() {
+    // A scalar value directly before the end of a truncated object
+    if (_json && _jsonInValue && _jsonDepth == 1) jsonEmitValue();
+
+    if ((_recordHeader & NDEF_FLAG_ME) || _tlvRemaining == 0) {
+        _state = STATE_DONE;
+        emitMessageEnd(_callback, _context);
+        return;
+    }
+    _firstRecord = false;
+    _state = STATE_RECORD_HEADER;
+}
+
+void NdefStreamDecoder::consume(uint8_t byte) {
+    switch (_state) {
+        case STATE_TLV_TYPE:
+            if (byte == TLV_NULL) return;
+            if (byte == TLV_TERMINATOR) {
+                // Terminator before any NDEF TLV: empty tag
+                _bytesNeeded = _offset + 1;
+                _state = STATE_DONE;
+                emitMessageEnd(_callback, _context);
+                return;
+            }
+            _tlvType = byte;
+            _state = STATE_TLV_LENGTH;
+            return;
+
+        case STATE_TLV_LENGTH:
+            if (byte == 0xFF) {
+                _state = STATE_TLV_LENGTH_HI;
+                return;
+            }
+            _tlvLength = byte;
+            afterTlvLength();
+            return;
+
+        case STATE_TLV_LENGTH_HI:
+            _tlvLength = byte << 8;
+            _state = STATE_TLV_LENGTH_LO;
+            return;
+
+        case STATE_TLV_LENGTH_LO:
+            _tlvLength |= byte;
+            afterTlvLength();
+            return;
+
+        case STATE_TLV_SKIP:
+            if (--_tlvRemaining == 0) _state = STATE_TLV_TYPE;
+            return;
+
+        case STATE_DONE:
+        case STATE_ERROR:
+            return;
+
+        default:
+            break;
+    }
+
+    // Everything below is part of the NDEF TLV value
+    if (_tlvRemaining == 0) {
+        fail("record extends beyond message");
+        return;
+    }
+    _tlvRemaining--;
+
+    switch (_state) {
+        case STATE_RECORD_HEADER:
+            _recordHeader = byte;
+            _state = STATE_TYPE_LENGTH;
+            break;
+
+        case STATE_TYPE_LENGTH:
+            _typeLength = byte;
+            _lengthBytes = (_recordHeader & NDEF_FLAG_SR) ? 1 : 4;
+            _fieldRemaining = _lengthBytes;
+            _payloadLength = 0;
+            _state = STATE_PAYLOAD_LENGTH;
+            break;
+
+        case STATE_PAYLOAD_LENGTH:
+            _payloadLength = (_payloadLength << 8) | byte;
+            if (--_fieldRemaining == 0) {
+                if (_recordHeader & NDEF_FLAG_IL) {
+                    _state = STATE_ID_LENGTH;
+                } else {
+                    _idLength = 0;
+                    afterRecordField();
+                }
+            }
+            break;
+
+        case STATE_ID_LENGTH:
+            _idLength = byte;
+            afterRecordField();
+            break;
+
+        case STATE_TYPE:
+            if (_recordTypeLength < NDEF_STREAM_MAX_TYPE) {
+                _recordType[_recordTypeLength++] = (char)byte;
+            }
+            if (--_fieldRemaining == 0) {
+                _recordType[_recordTypeLength] = '\0';
+                _fieldRemaining = _idLength;
+                if (_idLength > 0) {
+                    _state = STATE_ID;
+                } else {
+                    startPayload();
+                }
+            }
+            break;
+
+        case STATE_ID:
+            if (--_fieldRemaining == 0) startPayload();
+            break;
+
+        case STATE_PAYLOAD:
+            if (_json) jsonByte((char)byte);
+            if (--_fieldRemaining == 0) endRecord();
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ##### JSON scanner #####
+void NdefStreamDecoder::jsonEmitValue() {
+    _key[_keyLength] = '\0';
+    _value[_valueLength] = '\0';
+    _jsonInValue = false;
+
+    NdefStreamEvent event = {};
+    event.type = NDEF_EVENT_KEY_VALUE;
+    event.key = _key;
+    event.value = _value;
+    event.truncated = _jsonTruncated;
+    emit(event);
+}
+
+void NdefStreamDecoder::jsonByte(char c) {
+    if (!_jsonStarted) {
+        if (c == '{') {
+            _jsonStarted = true;
+            _jsonDepth = 1;
+        } else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            _json = false;
+        }
+        return;
+    }
+    if (_jsonDepth == 0) return;
+
+    if (_jsonInString) {
+        if (_jsonEscape) {
+            _jsonEscape = false;
+        } else if (c == '\\') {
+            _jsonEscape = true;
+            return;
+        } else if (c == '"') {
+            _jsonInString = false;
+            if (_jsonDepth == 1 && _jsonInValue) jsonEmitValue();
+            return;
+        }
+        if (_jsonDepth != 1) return;
+
+        if (!_jsonHaveKey) {
+            if (_keyLength < NDEF_STREAM_MAX_KEY) _key[_keyLength++] = c;
+        } else if (_valueLength < NDEF_STREAM_MAX_VALUE) {
+            _value[_valueLength++] = c;
+        } else {
+            _jsonTruncated = true;
+        }
+        return;
+    }
+
+    switch (c) {
+        case '"':
+            _jsonInString = true;
+            if (_jsonDepth == 1) {
+                if (!_jsonHaveKey) {
+                    _keyLength = 0;
+                } else {
+                    _jsonInValue = true;
+                    _valueLength = 0;
+                    _jsonTruncated = false;
+                }
+            }
+            break;
+
+        case ':':
+            if (_jsonDepth == 1) _jsonHaveKey = true;
+            break;
+
+        case '{':
+        case '[':
+            _jsonDepth++;
+            break;
+
+        case '}':
+        case ']':
+            if (_jsonDepth == 1 && _jsonInValue) jsonEmitValue();
+            _jsonDepth--;
+            break;
+
+        case ',':
+            if (_jsonDepth == 1) {
+                if (_jsonInValue) jsonEmitValue();
+                _jsonHaveKey = false;
+            }
+            break;
+
+        case ' ':
+        case '\n':
+        case '\r':
+        case '\t':
+            break;
+
+        default:
+            // Unquoted scalar: number, true, false, null
+            if (_jsonDepth == 1 && _jsonHaveKey) {
+                if (!_jsonInValue) {
+                    _jsonInValue = true;
+                    _valueLength = 0;
+                    _jsonTruncated = false;
+                }
+                if (_valueLength < NDEF_STREAM_MAX_VALUE) {
+                    _value[_valueLength++] = c;
+                } else {
+                    _jsonTruncated = true;
+                }
+            }
+            break;
+    }
+}
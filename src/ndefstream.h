@@ -0,0 +1,117 @@
+#ifndef NDEFSTREAM_H
+#define NDEFSTREAM_H
+
+#include <Arduino.h>
+
+#define NDEF_STREAM_MAX_TYPE    32
+#define NDEF_STREAM_MAX_KEY     24
+#define NDEF_STREAM_MAX_VALUE   48
+
+typedef enum {
+    NDEF_EVENT_RECORD,          // record header and type parsed
+    NDEF_EVENT_KEY_VALUE,       // top-level JSON key with a string/scalar value
+    NDEF_EVENT_MESSAGE_END,     // NDEF TLV (or terminator) fully consumed
+    NDEF_EVENT_ERROR
+} NdefStreamEventType;
+
+struct NdefStreamEvent {
+    NdefStreamEventType type;
+    const char* recordType;     // NDEF_EVENT_RECORD
+    uint32_t payloadLength;     // NDEF_EVENT_RECORD
+    const char* key;            // NDEF_EVENT_KEY_VALUE
+    const char* value;
+    bool truncated;             // value longer than NDEF_STREAM_MAX_VALUE
+    const char* error;          // NDEF_EVENT_ERROR
+};
+
+typedef void (*NdefStreamCallback)(const NdefStreamEvent& event, void* context);
+
+// Push-style decoder for the NDEF area of a type 2 tag (starting at page 4).
+// Chunks are pushed as they are read; TLV, record header, type and payload
+// are tracked across chunk boundaries and events are emitted as soon as the
+// bytes for them have arrived. JSON payloads are scanned for top-level
+// key/value pairs, nested objects and arrays are skipped.
+class NdefStreamDecoder {
+public:
+    NdefStreamDecoder(NdefStreamCallback callback = nullptr, void* context = nullptr);
+
+    void reset();
+    void push(const uint8_t* data, uint16_t length);
+
+    bool finished() const { return _state == STATE_DONE; }
+    bool failed() const { return _state == STATE_ERROR; }
+    // Bytes from page 4 on that cover the message and its terminator TLV,
+    // 0 while the NDEF TLV length is not known yet
+    uint16_t bytesNeeded() const { return _bytesNeeded; }
+    // Payload position of the first record within the pushed stream
+    bool hasPayload() const { return _firstPayloadOffset != 0; }
+    uint16_t payloadOffset() const { return _firstPayloadOffset; }
+    uint32_t payloadLength() const { return _firstPayloadLength; }
+    bool payloadIsJson() const { return _json; }
+
+private:
+    enum State {
+        STATE_TLV_TYPE,
+        STATE_TLV_LENGTH,
+        STATE_TLV_LENGTH_HI,
+        STATE_TLV_LENGTH_LO,
+        STATE_TLV_SKIP,
+        STATE_RECORD_HEADER,
+        STATE_TYPE_LENGTH,
+        STATE_PAYLOAD_LENGTH,
+        STATE_ID_LENGTH,
+        STATE_TYPE,
+        STATE_ID,
+        STATE_PAYLOAD,
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    void consume(uint8_t byte);
+    void afterTlvLength();
+    void afterRecordField();
+    void startPayload();
+    void endRecord();
+    void fail(const char* error);
+    void emit(NdefStreamEvent& event);
+    void jsonByte(char c);
+    void jsonEmitValue();
+
+    NdefStreamCallback _callback;
+    void* _context;
+
+    State _state;
+    uint16_t _offset;               // bytes consumed since page 4
+    uint8_t _tlvType;
+    uint16_t _tlvLength;
+    uint16_t _tlvRemaining;         // bytes left in the current TLV value
+    uint16_t _bytesNeeded;
+
+    uint8_t _recordHeader;
+    uint8_t _typeLength;
+    uint8_t _idLength;
+    uint32_t _payloadLength;
+    uint32_t _fieldRemaining;       // bytes left in the current record field
+    uint8_t _lengthBytes;
+    char _recordType[NDEF_STREAM_MAX_TYPE + 1];
+    uint8_t _recordTypeLength;
+    bool _firstRecord;
+    uint16_t _firstPayloadOffset;
+    uint32_t _firstPayloadLength;
+
+    // JSON scanner (top level only)
+    bool _json;
+    bool _jsonStarted;
+    uint8_t _jsonDepth;
+    bool _jsonInString;
+    bool _jsonEscape;
+    bool _jsonHaveKey;
+    bool _jsonInValue;
+    bool _jsonTruncated;
+    char _key[NDEF_STREAM_MAX_KEY + 1];
+    uint8_t _keyLength;
+    char _value[NDEF_STREAM_MAX_VALUE + 1];
+    uint8_t _valueLength;
+};
+
+#endif
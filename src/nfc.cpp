@@ -1,6 +1,6 @@
 #include "nfc.h"
 #include <Arduino.h>
-#include <Adafruit_PN532.h>
+#include "pn532.h"
 #include <ArduinoJson.h>
 #include "config.h"
 #include "website.h"
@@ -10,14 +10,30 @@
 #include "bambu.h"
 #include "main.h"
 #include "openprinttag.h"
+#include "taggeometry.h"
+#include "tagcache.h"
+#include "ndefstream.h"
+#include "ndefrecord.h"
+#include "tagdecode.h"
+#include "compacttag.h"
+#include "events.h"
+#include "scantrace.h"
+#include "spoolmirror.h"
+#include <Preferences.h>
+
+// PN532 on the configured transport – initialised in startNfc() with runtime pins
+Pn532 *pNfc = nullptr;
+// Bay reader the RFID task is currently talking to, see BayReaderScope
+static Pn532 *pBayNfc = nullptr;
+TaskHandle_t RfidReaderTask;
 
-//Adafruit_PN532 nfc(PN532_SCK, PN532_MISO, PN532_MOSI, PN532_SS);
-// PN532 in software-SPI mode – initialised in startNfc() with runtime pins
-Adafruit_PN532 *pNfc = nullptr;
-static Adafruit_PN532 &getNfc() {
+static Pn532 &getNfc() {
+  if (pBayNfc != nullptr && xTaskGetCurrentTaskHandle() == RfidReaderTask) {
+    return *pBayNfc;
+  }
   if (pNfc == nullptr) {
-    static Adafruit_PN532 fallbackNfc(DEFAULT_PN532_SCK, DEFAULT_PN532_MISO,
-                                      DEFAULT_PN532_MOSI, DEFAULT_PN532_SS);
+    static Pn532 fallbackNfc(new Pn532SoftSpiTransport(DEFAULT_PN532_SCK, DEFAULT_PN532_MISO,
+                                                       DEFAULT_PN532_MOSI, DEFAULT_PN532_SS));
     Serial.println("WARNING: NFC accessed before initialization");
     return fallbackNfc;
   }
@@ -25,13 +41,10 @@ static Adafruit_PN532 &getNfc() {
 }
 #define nfc getNfc()
 
-TaskHandle_t RfidReaderTask;
-
 JsonDocument rfidData;
 String activeSpoolId = "";
 String lastSpoolId = "";
 String nfcJsonData = "";
-bool tagProcessed = false;
 volatile bool pauseBambuMqttTask = false;
 volatile bool nfcReadingTaskSuspendRequest = false;
 volatile bool nfcReadingTaskSuspendState = false;
@@ -40,9 +53,13 @@ volatile bool nfcWriteInProgress = false; // Prevent any tag operations during w
 struct NfcWriteParameterType {
   bool tagType;
   char* payload;
+  uint8_t* image;     // prebuilt TLV image (OpenPrintTag), written instead of payload
+  uint16_t imageLen;
 };
 
 volatile nfcReaderStateType nfcReaderState = NFC_IDLE;
+NfcBay nfcBays[NFC_MAX_BAYS];
+uint8_t nfcBayCount = 0;
 // 0 = not read
 // 1 = successfully read
 // 2 = error reading
@@ -112,12 +129,142 @@ bool formatNdefTag() {
     }
   
     return success;
-}uint16_t readTagSize()
-{
-  uint8_t buffer[4];
-  memset(buffer, 0, 4);
-  nfc.ntag2xx_ReadPage(3, buffer);
-  return buffer[2]*8;
+}
+
+// UID of the tag currently being processed, used to look up its geometry
+static uint8_t currentTagUid[7];
+static uint8_t currentTagUidLength = 0;
+
+static void setCurrentTag(const uint8_t* uid, uint8_t uidLength) {
+    currentTagUidLength = min(uidLength, (uint8_t)sizeof(currentTagUid));
+    memcpy(currentTagUid, uid, currentTagUidLength);
+}
+
+static NtagGeometry currentTagGeometry() {
+    return getTagGeometry(currentTagUid, currentTagUidLength);
+}
+
+// ##### Dual target mode #####
+// InListPassiveTarget with MaxTg=2 lists a spool tag and a location tag
+// lying on the reader together; both are read in the same cycle.
+bool nfcDualTarget = false;
+
+static Pn532Target detectedTargets[PN532_MAX_TARGETS];
+static uint8_t detectedTargetCount = 0;
+
+void loadNfcDualTarget() {
+    Preferences preferences;
+    preferences.begin(NVS_NAMESPACE_NFC, true);
+    nfcDualTarget = preferences.getBool(NVS_KEY_NFC_DUAL_TARGET, false);
+    preferences.end();
+    Serial.printf("NFC dual target mode: %s\n", nfcDualTarget ? "on" : "off");
+}
+
+void setNfcDualTarget(bool enabled) {
+    Preferences preferences;
+    preferences.begin(NVS_NAMESPACE_NFC, false);
+    preferences.putBool(NVS_KEY_NFC_DUAL_TARGET, enabled);
+    preferences.end();
+
+    nfcDualTarget = enabled;
+    Serial.printf("NFC dual target mode set to %s\n", enabled ? "on" : "off");
+}
+
+static uint8_t detectionMaxTargets() {
+    return nfcDualTarget ? PN532_MAX_TARGETS : 1;
+}
+
+// Keep the listed targets for the scan loop, the first one goes to uid
+static bool takeDetectedTargets(uint8_t count, uint8_t* uid, uint8_t* uidLength) {
+    detectedTargetCount = count;
+    if (count == 0) return false;
+
+    *uidLength = detectedTargets[0].uidLength;
+    memcpy(uid, detectedTargets[0].uid, *uidLength);
+    return true;
+}
+
+// ##### IRQ driven detection #####
+// InListPassiveTarget stays pending on the PN532 (infinite activation retries)
+// and the task sleeps until the IRQ line reports the response, so an idle
+// reader causes no bus traffic at all. Used while waiting for a new tag;
+// removal is still detected by polling.
+#define NFC_IRQ_WAIT_MS           1000
+// Bay readers are polled between two waits, keep their latency low
+#define NFC_IRQ_WAIT_BAYS_MS      100
+
+static SemaphoreHandle_t pn532IrqSemaphore = NULL;
+static volatile bool irqDetectionPending = false;
+
+static void IRAM_ATTR pn532IrqIsr() {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(pn532IrqSemaphore, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+static void setupIrqDetection() {
+    if (!pn532Pins.useIrq) return;
+#ifdef ENABLE_PN532_SIMULATOR
+    Serial.println("NFC: IRQ detection not available with the simulator, polling");
+    return;
+#endif
+
+    if (pn532IrqSemaphore == NULL) {
+        pn532IrqSemaphore = xSemaphoreCreateBinary();
+    }
+    irqDetectionPending = false;
+    pinMode(pn532Pins.irq, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pn532Pins.irq), pn532IrqIsr, FALLING);
+    nfc.setPassiveActivationRetries(0xFF);
+    Serial.printf("NFC: IRQ driven tag detection on GPIO %u\n", pn532Pins.irq);
+}
+
+// The IRQ line is low while a response is waiting to be read
+static bool pn532ResponsePending() {
+    return digitalRead(pn532Pins.irq) == LOW;
+}
+
+static void cancelIrqDetection() {
+    if (!irqDetectionPending) return;
+    nfc.abortCommand();
+    irqDetectionPending = false;
+}
+
+// Wake the RFID task out of its IRQ wait and wait until the pending
+// detection is cancelled, so another task can use the PN532
+static void releaseReaderFromIrqDetection() {
+    if (!irqDetectionPending) return;
+    xSemaphoreGive(pn532IrqSemaphore);
+    for (int i = 0; i < 20 && irqDetectionPending; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static bool irqTagDetection(uint8_t* uid, uint8_t* uidLength) {
+    if (!irqDetectionPending) {
+        if (!nfc.startPassiveTargetIDDetection(PN532_MIFARE_ISO14443A, detectionMaxTargets())) {
+            return false;
+        }
+        irqDetectionPending = true;
+        // Reading the ACK pulsed the IRQ line, drop that edge
+        xSemaphoreTake(pn532IrqSemaphore, 0);
+    }
+
+    if (!pn532ResponsePending()) {
+        xSemaphoreTake(pn532IrqSemaphore, pdMS_TO_TICKS(nfcBayCount ? NFC_IRQ_WAIT_BAYS_MS : NFC_IRQ_WAIT_MS));
+    }
+
+    // Woken up so somebody else can use the reader
+    if (nfcWriteInProgress || nfcReadingTaskSuspendRequest) {
+        cancelIrqDetection();
+        return false;
+    }
+
+    // Timeout, the detection stays pending on the PN532
+    if (!pn532ResponsePending()) return false;
+
+    irqDetectionPending = false;
+    return takeDetectedTargets(nfc.readDetectedPassiveTargets(detectedTargets, detectionMaxTargets()), uid, uidLength);
 }
 
 // Robust page reading with error recovery
@@ -151,120 +298,147 @@ bool robustPageRead(uint8_t page, uint8_t* buffer) {
     return false;
 }
 
-String detectNtagType()
-{
-  // Read capability container from page 3 to determine exact NTAG type
-  uint8_t ccBuffer[4];
-  memset(ccBuffer, 0, 4);
-  
-  if (!nfc.ntag2xx_ReadPage(3, ccBuffer)) {
-    Serial.println("Failed to read capability container");
-    return "UNKNOWN";
-  }
+// ##### Bulk page reads #####
+// NTAG21x READ (0x30) returns 4 pages (16 bytes) per command and FAST_READ (0x3A)
+// returns a whole page range, so a full NTAG215 takes ~12 exchanges instead of ~130.
+#define NTAG_CMD_READ             0x30
+#define NTAG_CMD_FAST_READ        0x3A
+#define NTAG_READ_BLOCK_PAGES     4
+// 12 pages (48 bytes) per FAST_READ keeps every response small enough for the
+// I2C transport's single-transfer reads and cheap to retry.
+#define NTAG_FAST_READ_MAX_PAGES  12
+
+unsigned long lastTagReadTimeMs = 0;
+
+// A NAK (e.g. to an unsupported command) sends the tag back to IDLE,
+// select it again before the next exchange
+bool reselectTag() {
+    Pn532Target targets[PN532_MAX_TARGETS];
+    uint8_t count = nfc.readPassiveTargets(PN532_MIFARE_ISO14443A, targets, detectionMaxTargets(), 100);
+
+    // With two tags on the reader stay on the one being processed
+    for (uint8_t i = 1; i < count; i++) {
+        if (targets[i].uidLength == currentTagUidLength &&
+            memcmp(targets[i].uid, currentTagUid, currentTagUidLength) == 0) {
+            nfc.selectTarget(targets[i].tg);
+        }
+    }
+    return count > 0;
+}
 
-  // Also read configuration pages to get more info
-  uint8_t configBuffer[4];
-  memset(configBuffer, 0, 4);
-  
-  Serial.print("Capability Container: ");
-  for (int i = 0; i < 4; i++) {
-    if (ccBuffer[i] < 0x10) Serial.print("0");
-    Serial.print(ccBuffer[i], HEX);
-    Serial.print(" ");
-  }
-  Serial.println();
+static bool ntagExchange(uint8_t* cmd, uint8_t cmdLength, uint8_t* response, uint8_t expectedLength) {
+    uint8_t responseLength = expectedLength;
+    if (!nfc.inDataExchange(cmd, cmdLength, response, &responseLength)) {
+        return false;
+    }
+    return responseLength == expectedLength;
+}
 
-  // NTAG type detection based on capability container
-  // CC[2] contains the data area size in bytes / 8
-  uint16_t dataAreaSize = ccBuffer[2] * 8;
-  
-  Serial.print("Data area size from CC: ");
-  Serial.println(dataAreaSize);
+// Raw NTAG command exchange with the current tag (e.g. GET_VERSION), passed
+// through as is instead of being interpreted by InDataExchange
+bool ntagTransceive(uint8_t* cmd, uint8_t cmdLength, uint8_t* response, uint8_t* responseLength) {
+    return nfc.inCommunicateThru(cmd, cmdLength, response, responseLength);
+}
 
-  // Try to read different configuration pages to determine exact type
-  String tagType = "UNKNOWN";
-  
-  // Try to read page 41 (NTAG213 ends at page 39, so this should fail)
-  uint8_t testBuffer[4];
-  bool canReadPage41 = nfc.ntag2xx_ReadPage(41, testBuffer);
-  
-  // Try to read page 130 (NTAG215 ends at page 129, so this should fail for NTAG213/215)
-  bool canReadPage130 = nfc.ntag2xx_ReadPage(130, testBuffer);
-
-  if (dataAreaSize <= 180 && !canReadPage41) {
-    tagType = "NTAG213";
-    Serial.println("Detected: NTAG213 (cannot read beyond page 39)");
-  } else if (dataAreaSize <= 540 && canReadPage41 && !canReadPage130) {
-    tagType = "NTAG215";
-    Serial.println("Detected: NTAG215 (can read page 41, cannot read page 130)");
-  } else if (dataAreaSize <= 928 && canReadPage130) {
-    tagType = "NTAG216";
-    Serial.println("Detected: NTAG216 (can read page 130)");
-  } else {
-    // Fallback: use data area size from capability container
-    if (dataAreaSize <= 180) {
-      tagType = "NTAG213";
-      Serial.println("Fallback detection: NTAG213 based on data area size");
-    } else if (dataAreaSize <= 540) {
-      tagType = "NTAG215";
-      Serial.println("Fallback detection: NTAG215 based on data area size");
-    } else {
-      tagType = "NTAG216";
-      Serial.println("Fallback detection: NTAG216 based on data area size");
+static bool ntagFastRead(uint8_t startPage, uint8_t pageCount, uint8_t* buffer) {
+    uint8_t cmd[3] = { NTAG_CMD_FAST_READ, startPage, (uint8_t)(startPage + pageCount - 1) };
+    return ntagExchange(cmd, sizeof(cmd), buffer, pageCount * 4);
+}
+
+static bool ntagReadBlock(uint8_t page, uint8_t* buffer) {
+    uint8_t cmd[2] = { NTAG_CMD_READ, page };
+    return ntagExchange(cmd, sizeof(cmd), buffer, NTAG_READ_BLOCK_PAGES * 4);
+}
+
+// Fallback for a failed chunk: 16-byte READs, then single pages with recovery
+static bool ntagReadChunkSlow(uint8_t startPage, uint8_t pageCount, uint8_t* buffer) {
+    uint8_t block[NTAG_READ_BLOCK_PAGES * 4];
+
+    for (uint8_t done = 0; done < pageCount; ) {
+        uint8_t page = startPage + done;
+        uint8_t remaining = pageCount - done;
+        esp_task_wdt_reset();
+
+        if (remaining >= NTAG_READ_BLOCK_PAGES && ntagReadBlock(page, block)) {
+            memcpy(buffer + done * 4, block, sizeof(block));
+            done += NTAG_READ_BLOCK_PAGES;
+            continue;
+        }
+
+        if (!robustPageRead(page, buffer + done * 4)) {
+            return false;
+        }
+        done++;
     }
-  }
-  
-  return tagType;
+    return true;
 }
 
-uint16_t getAvailableUserDataSize()
-{
-  String tagType = detectNtagType();
-  uint16_t userDataSize = 0;
-  
-  if (tagType == "NTAG213") {
-    // NTAG213: User data from page 4-39 (36 pages * 4 bytes = 144 bytes)
-    userDataSize = 144;
-    Serial.println("NTAG213 confirmed - 144 bytes user data available");
-  } else if (tagType == "NTAG215") {
-    // NTAG215: User data from page 4-129 (126 pages * 4 bytes = 504 bytes)
-    userDataSize = 504;
-    Serial.println("NTAG215 confirmed - 504 bytes user data available");
-  } else if (tagType == "NTAG216") {
-    // NTAG216: User data from page 4-225 (222 pages * 4 bytes = 888 bytes)
-    userDataSize = 888;
-    Serial.println("NTAG216 confirmed - 888 bytes user data available");
-  } else {
-    // Unknown tag type, use conservative estimate
-    uint16_t tagSize = readTagSize();
-    userDataSize = tagSize - 60; // Reserve 60 bytes for headers/config
-    Serial.print("Unknown NTAG type, using conservative estimate: ");
-    Serial.println(userDataSize);
-  }
-  
-  return userDataSize;
+// Read pageCount pages starting at startPage into buffer (pageCount * 4 bytes)
+bool ntagReadPages(uint8_t startPage, uint8_t pageCount, uint8_t* buffer) {
+    for (uint8_t done = 0; done < pageCount; ) {
+        uint8_t chunk = min((uint8_t)(pageCount - done), (uint8_t)NTAG_FAST_READ_MAX_PAGES);
+        uint8_t* dest = buffer + done * 4;
+
+        esp_task_wdt_reset();
+        yield();
+
+        if (!ntagFastRead(startPage + done, chunk, dest)) {
+            Serial.printf("FAST_READ of pages %d-%d failed, falling back\n", startPage + done, startPage + done + chunk - 1);
+            if (!ntagReadChunkSlow(startPage + done, chunk, dest)) {
+                return false;
+            }
+        }
+        done += chunk;
+    }
+    return true;
 }
 
-uint16_t getMaxUserDataPages()
-{
-  String tagType = detectNtagType();
-  uint16_t maxPages = 0;
-  
-  if (tagType == "NTAG213") {
-    maxPages = 39; // Pages 4-39 are user data
-  } else if (tagType == "NTAG215") {
-    maxPages = 129; // Pages 4-129 are user data
-  } else if (tagType == "NTAG216") {
-    maxPages = 225; // Pages 4-225 are user data
-  } else {
-    // Conservative fallback
-    maxPages = 39;
-    Serial.println("Unknown tag type, using NTAG213 page limit as fallback");
-  }
-  
-  Serial.print("Maximum writable page: ");
-  Serial.println(maxPages);
-  return maxPages;
+// Returns the page count of the next chunk, given what the decoder has seen,
+// or 0 when the rest of the message is not needed
+typedef uint8_t (*NdefChunkPolicy)(const NdefStreamDecoder& decoder, uint16_t bytesRead, void* context);
+
+// Read the NDEF area (starting at page 4) chunk by chunk and push every chunk
+// into decoder as it arrives. The first block holds the TLV header; once the
+// decoder knows the message length only the pages covering it are read, the
+// rest of data stays zeroed.
+static bool readNdefStream(uint8_t* data, uint16_t dataSize, NdefStreamDecoder& decoder,
+                           NdefChunkPolicy nextChunk = nullptr, void* context = nullptr) {
+    unsigned long startTime = millis();
+    uint8_t totalPages = dataSize / 4;
+    uint8_t pagesRead = 0;
+    uint8_t chunk = NTAG_READ_BLOCK_PAGES;
+
+    memset(data, 0, dataSize);
+
+    for (;;) {
+        uint8_t pagesNeeded = totalPages;
+        if (decoder.bytesNeeded() > 0) {
+            pagesNeeded = min(totalPages, (uint8_t)((decoder.bytesNeeded() + 3) / 4));
+        }
+        if (pagesRead >= pagesNeeded) break;
+
+        chunk = min(chunk, (uint8_t)(pagesNeeded - pagesRead));
+        if (!ntagReadPages(4 + pagesRead, chunk, data + pagesRead * 4)) {
+            Serial.printf("Failed to read NDEF pages %d-%d\n", 4 + pagesRead, 4 + pagesRead + chunk - 1);
+            return false;
+        }
+        decoder.push(data + pagesRead * 4, chunk * 4);
+        pagesRead += chunk;
+
+        chunk = nextChunk ? nextChunk(decoder, pagesRead * 4, context) : NTAG_FAST_READ_MAX_PAGES;
+        if (chunk == 0) break;
+    }
+
+    lastTagReadTimeMs = millis() - startTime;
+    Serial.printf("Tag read: %d pages in %lu ms\n", pagesRead, lastTagReadTimeMs);
+    return true;
+}
+
+// Read the NDEF area (starting at page 4) of a tag with the given user data size.
+// Only the pages covered by the NDEF TLV are read; the rest of data stays zeroed.
+bool readNdefArea(uint8_t* data, uint16_t dataSize) {
+    NdefStreamDecoder decoder;
+    return readNdefStream(data, dataSize, decoder);
 }
 
 bool initializeNdefStructure() {
@@ -315,26 +489,12 @@ bool initializeNdefStructure() {
 bool clearUserDataArea() {
     // IMPORTANT: Only clear user data pages, NOT configuration pages
     // NTAG layout: Pages 0-3 (header), 4-N (user data), N+1-N+3 (config) - NEVER touch config!
-    String tagType = detectNtagType();
-    
-    // Calculate safe user data page ranges (NEVER touch config pages!)
-    uint16_t firstUserPage = 4;
-    uint16_t lastUserPage = 0;
-    
-    if (tagType == "NTAG213") {
-        lastUserPage = 39;  // Pages 40-42 are config - DO NOT TOUCH!
-        Serial.println("NTAG213: Safe erase pages 4-39");
-    } else if (tagType == "NTAG215") {
-        lastUserPage = 129; // Pages 130-132 are config - DO NOT TOUCH!
-        Serial.println("NTAG215: Safe erase pages 4-129");
-    } else if (tagType == "NTAG216") {
-        lastUserPage = 225; // Pages 226-228 are config - DO NOT TOUCH!
-        Serial.println("NTAG216: Safe erase pages 4-225");
-    } else {
-        // Conservative fallback - only clear a small safe area
-        lastUserPage = 39;
-        Serial.println("UNKNOWN TAG: Conservative erase pages 4-39");
+    NtagGeometry geometry = currentTagGeometry();
+    if (geometry.userDataBytes == 0) {
+        Serial.println("Unknown tag type, not erasing");
+        return false;
     }
+    Serial.printf("%s: Safe erase pages %d-%d\n", geometry.name, geometry.firstUserPage, geometry.lastUserPage);
     
     Serial.println("WARNING: Full erase may damage tag!");
     Serial.println("Using selective NDEF overwrite instead...");
@@ -344,736 +504,483 @@ bool clearUserDataArea() {
     return initializeNdefStructure();
 }
 
-uint8_t ntag2xx_WriteNDEF(const char *payload) {
-  // Determine exact tag type and capabilities first
-  String tagType = detectNtagType();
-  uint16_t tagSize = readTagSize();
-  uint16_t availableUserData = getAvailableUserDataSize();
-  uint16_t maxWritablePage = getMaxUserDataPages();
-  
-  Serial.println("=== NFC TAG ANALYSIS ===");
-  Serial.print("Tag Type: ");Serial.println(tagType);
-  Serial.print("Total Tag Size: ");Serial.println(tagSize);
-  Serial.print("Available User Data: ");Serial.println(availableUserData);
-  Serial.print("Max Writable Page: ");Serial.println(maxWritablePage);
-  Serial.println("========================");
-
-  // Perform additional tag validation by testing write boundaries
-  Serial.println("=== TAG VALIDATION ===");
-  uint8_t testBuffer[4] = {0x00, 0x00, 0x00, 0x00};
-  
-  // Test if we can actually read the max page
-  if (!nfc.ntag2xx_ReadPage(maxWritablePage, testBuffer)) {
-    Serial.print("WARNING: Cannot read declared max page ");
-    Serial.println(maxWritablePage);
-    
-    // Find actual maximum writable page by testing backwards with optimized approach
-    uint16_t actualMaxPage = maxWritablePage;
-    Serial.println("Searching for actual maximum writable page...");
-    
-    // Use binary search approach for faster page limit detection
-    uint16_t lowPage = 4;
-    uint16_t highPage = maxWritablePage;
-    uint16_t testAttempts = 0;
-    const uint16_t maxTestAttempts = 15; // Limit search attempts
-    
-    while (lowPage <= highPage && testAttempts < maxTestAttempts) {
-      uint16_t midPage = (lowPage + highPage) / 2;
-      testAttempts++;
-      
-      Serial.print("Testing page ");
-      Serial.print(midPage);
-      Serial.print(" (attempt ");
-      Serial.print(testAttempts);
-      Serial.print("/");
-      Serial.print(maxTestAttempts);
-      Serial.print(")... ");
-      
-      if (nfc.ntag2xx_ReadPage(midPage, testBuffer)) {
-        Serial.println("✓");
-        actualMaxPage = midPage;
-        lowPage = midPage + 1; // Search higher
-      } else {
-        Serial.println("❌");
-        highPage = midPage - 1; // Search lower
-      }
-      
-      // Small delay to prevent interface overload
-      vTaskDelay(5 / portTICK_PERIOD_MS);
-      yield();
-    }
-    
-    Serial.print("Found actual max readable page: ");
-    Serial.println(actualMaxPage);
-    Serial.print("Search completed in ");
-    Serial.print(testAttempts);
-    Serial.println(" attempts");
-    
-    maxWritablePage = actualMaxPage;
-  } else {
-    Serial.print("✓ Max page ");Serial.print(maxWritablePage);Serial.println(" is readable");
-  }
-  
-  // Calculate maximum available user data based on actual writable pages
-  uint16_t actualUserDataSize = (maxWritablePage - 3) * 4; // -3 because pages 0-3 are header
-  availableUserData = actualUserDataSize;
-  
-  Serial.print("Actual available user data: ");
-  Serial.print(actualUserDataSize);
-  Serial.println(" bytes");
-  Serial.println("========================");
+// ##### Write verification policy #####
+nfcWritePolicyType nfcWritePolicy = NFC_VERIFY_FINAL_CHECKSUM;
+NdefWriteStats lastNdefWriteStats = {};
 
-  uint8_t pageBuffer[4] = {0, 0, 0, 0};
-  Serial.println("Starting to write NDEF message...");
-  
-  // Figure out how long the string is
-  uint16_t payloadLen = strlen(payload);
-  Serial.print("Payload length: ");
-  Serial.println(payloadLen);
-  
-  Serial.print("Payload: ");Serial.println(payload);
+static const char* const nfcWritePolicyNames[] = { "none", "final-checksum", "per-page", "paranoid" };
 
-  // MIME type for JSON
-  const char mimeType[] = "application/json";
-  uint8_t mimeTypeLen = strlen(mimeType);
-  
-  // Calculate NDEF record size
-  uint8_t ndefRecordHeaderSize = 3; // Header byte + Type Length + Payload Length (short record)
-  uint16_t ndefRecordSize = ndefRecordHeaderSize + mimeTypeLen + payloadLen;
-  
-  // Calculate TLV size - need to check if we need extended length format
-  uint8_t tlvHeaderSize;
-  uint16_t totalTlvSize;
-  
-  if (ndefRecordSize <= 254) {
-    // Standard TLV format: Tag (1) + Length (1) + Value (ndefRecordSize)
-    tlvHeaderSize = 2;
-    totalTlvSize = tlvHeaderSize + ndefRecordSize + 1; // +1 for terminator TLV
-  } else {
-    // Extended TLV format: Tag (1) + 0xFF + Length (2) + Value (ndefRecordSize)  
-    tlvHeaderSize = 4;
-    totalTlvSize = tlvHeaderSize + ndefRecordSize + 1; // +1 for terminator TLV
-  }
+const char* nfcWritePolicyToString(nfcWritePolicyType policy) {
+    return (policy <= NFC_VERIFY_PARANOID) ? nfcWritePolicyNames[policy] : "unknown";
+}
 
-  Serial.print("NDEF Record Size: ");
-  Serial.println(ndefRecordSize);
-  Serial.print("Total TLV Size: ");
-  Serial.println(totalTlvSize);
+void loadNfcWritePolicy() {
+    Preferences preferences;
+    preferences.begin(NVS_NAMESPACE_NFC, true);
+    uint8_t stored = preferences.getUChar(NVS_KEY_NFC_WRITE_POLICY, NFC_VERIFY_FINAL_CHECKSUM);
+    preferences.end();
 
-  // Check if the message fits in the available user data space
-  if (totalTlvSize > availableUserData) {
-    Serial.println();
-    Serial.println("!!!!!!!!!!!!!!!!!!!!!!!!");
-    Serial.println("ERROR: Payload too large for this tag type!");
-    Serial.print("Tag-Typ: ");Serial.println(tagType);
-    Serial.print("Required: ");Serial.print(totalTlvSize);Serial.println(" Bytes");
-    Serial.print("Available: ");Serial.print(availableUserData);Serial.println(" Bytes");
-    Serial.print("Excess: ");Serial.print(totalTlvSize - availableUserData);Serial.println(" Bytes");
-    
-    if (tagType == "NTAG213") {
-      Serial.println("RECOMMENDATION: Use an NTAG215 (504 bytes) or NTAG216 (888 bytes) tag!");
-      Serial.println("Or reduce the payload by at least " + String(totalTlvSize - availableUserData) + " Bytes.");
+    nfcWritePolicy = (stored <= NFC_VERIFY_PARANOID) ? (nfcWritePolicyType)stored : NFC_VERIFY_FINAL_CHECKSUM;
+    Serial.printf("NFC write verification policy: %s\n", nfcWritePolicyToString(nfcWritePolicy));
+}
+
+bool setNfcWritePolicy(const String& name) {
+    for (uint8_t i = 0; i <= NFC_VERIFY_PARANOID; i++) {
+        if (name == nfcWritePolicyNames[i]) {
+            Preferences preferences;
+            preferences.begin(NVS_NAMESPACE_NFC, false);
+            preferences.putUChar(NVS_KEY_NFC_WRITE_POLICY, i);
+            preferences.end();
+
+            nfcWritePolicy = (nfcWritePolicyType)i;
+            Serial.printf("NFC write verification policy set to %s\n", name.c_str());
+            return true;
+        }
     }
-    Serial.println("!!!!!!!!!!!!!!!!!!!!!!!!");
-    Serial.println();
-    
-    oledShowMessage("Tag too small for payload");
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    return 0;
-  }
+    return false;
+}
 
-  Serial.println("✓ Payload fits in tag - write operation continues");
+// ##### Tag payload encoding #####
+nfcTagEncodingType nfcTagEncoding = NFC_TAG_ENCODING_JSON;
 
-  // STEP 1: NFC Interface Reset and Reinitialization
-  Serial.println();
-  Serial.println("=== STEP 1: NFC INTERFACE RESET AND REINITIALIZATION ===");
-  
-  // First, check if the NFC interface is working at all
-  Serial.println("Testing current NFC interface state...");
-  
-  // Try to read capability container (which worked during detection)
-  uint8_t ccTest[4];
-  bool ccReadable = nfc.ntag2xx_ReadPage(3, ccTest);
-  Serial.print("Capability Container (page 3) readable: ");
-  Serial.println(ccReadable ? "✓" : "❌");
-  
-  if (!ccReadable) {
-    Serial.println("❌ NFC interface is not functional - performing reset");
-    
-    // Perform NFC interface reset and reinitialization
-    Serial.println("Performing NFC interface reset...");
-    
-    // Step 1: Try to reinitialize the NFC interface completely
-    Serial.println("1. Neuinitialisierung des PN532...");
-    
-    // Reinitialize the PN532
-    nfc.begin();
-    vTaskDelay(500 / portTICK_PERIOD_MS); // Give it time to initialize
-    
-    // Check firmware version to ensure communication is working
-    uint32_t versiondata = nfc.getFirmwareVersion();
-    if (versiondata) {
-      Serial.print("PN532 Firmware Version: 0x");
-      Serial.println(versiondata, HEX);
-      Serial.println("✓ PN532 communication restored");
+static const char* const nfcTagEncodingNames[] = { "json", "compact" };
+
+const char* nfcTagEncodingToString(nfcTagEncodingType encoding) {
+    return (encoding <= NFC_TAG_ENCODING_COMPACT) ? nfcTagEncodingNames[encoding] : "unknown";
+}
+
+void loadNfcTagEncoding() {
+    Preferences preferences;
+    preferences.begin(NVS_NAMESPACE_NFC, true);
+    uint8_t stored = preferences.getUChar(NVS_KEY_NFC_TAG_ENCODING, NFC_TAG_ENCODING_JSON);
+    preferences.end();
+
+    nfcTagEncoding = (stored <= NFC_TAG_ENCODING_COMPACT) ? (nfcTagEncodingType)stored : NFC_TAG_ENCODING_JSON;
+    Serial.printf("NFC tag encoding: %s\n", nfcTagEncodingToString(nfcTagEncoding));
+}
+
+bool setNfcTagEncoding(const String& name) {
+    for (uint8_t i = 0; i <= NFC_TAG_ENCODING_COMPACT; i++) {
+        if (name == nfcTagEncodingNames[i]) {
+            Preferences preferences;
+            preferences.begin(NVS_NAMESPACE_NFC, false);
+            preferences.putUChar(NVS_KEY_NFC_TAG_ENCODING, i);
+            preferences.end();
+
+            nfcTagEncoding = (nfcTagEncodingType)i;
+            Serial.printf("NFC tag encoding set to %s\n", name.c_str());
+            return true;
+        }
+    }
+    return false;
+}
+
+// ##### Differential NDEF writer #####
+// Builds the complete TLV image (NDEF message TLV + terminator) for a single
+// MIME record. Payloads above 255 bytes use a long record (4 byte length).
+uint8_t* buildNdefTlvImage(const char* mimeType, const uint8_t* payload, uint16_t payloadLen, uint16_t& imageLen) {
+    uint8_t mimeTypeLen = strlen(mimeType);
+    bool shortRecord = payloadLen <= 255;
+    uint16_t recordSize = 2 + (shortRecord ? 1 : 4) + mimeTypeLen + payloadLen;
+    uint8_t tlvHeaderSize = (recordSize < 0xFF) ? 2 : 4;
+
+    imageLen = tlvHeaderSize + recordSize + 1; // +1 for terminator TLV
+    uint8_t* image = (uint8_t*)malloc(imageLen);
+    if (!image) return nullptr;
+
+    uint16_t offset = 0;
+    image[offset++] = 0x03;                            // NDEF Message TLV
+    if (tlvHeaderSize == 2) {
+        image[offset++] = (uint8_t)recordSize;
     } else {
-      Serial.println("❌ PN532 communication failed");
-      oledShowMessage("NFC Reset failed");
-      vTaskDelay(3000 / portTICK_PERIOD_MS);
-      return 0;
+        image[offset++] = 0xFF;
+        image[offset++] = (uint8_t)(recordSize >> 8);
+        image[offset++] = (uint8_t)(recordSize & 0xFF);
     }
-    
-    // Step 2: Reconfigure SAM
-    Serial.println("2. SAM-Konfiguration...");
-    nfc.SAMConfig();
-    vTaskDelay(200 / portTICK_PERIOD_MS);
-    
-    // Step 3: Re-detect the tag
-    Serial.println("3. Tag-Wiedererkennung...");
-    uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t uidLength;
-    bool tagRedetected = false;
-    
-    for (int attempts = 0; attempts < 5; attempts++) {
-      Serial.print("Tag-Erkennungsversuch ");
-      Serial.print(attempts + 1);
-      Serial.print("/5... ");
-      
-      if (nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 1000)) {
-        Serial.println("✓");
-        tagRedetected = true;
-        break;
-      } else {
-        Serial.println("❌");
-        vTaskDelay(300 / portTICK_PERIOD_MS);
-      }
+
+    // MB + ME (+ SR), TNF = 0x2 (MIME media)
+    image[offset++] = shortRecord ? 0xD2 : 0xC2;
+    image[offset++] = mimeTypeLen;
+    if (shortRecord) {
+        image[offset++] = (uint8_t)payloadLen;
+    } else {
+        image[offset++] = 0x00;
+        image[offset++] = 0x00;
+        image[offset++] = (uint8_t)(payloadLen >> 8);
+        image[offset++] = (uint8_t)(payloadLen & 0xFF);
     }
-    
-    if (!tagRedetected) {
-      Serial.println("❌ Tag could not be recognized after reset");
-      oledShowMessage("Tag lost after reset");
-      vTaskDelay(3000 / portTICK_PERIOD_MS);
-      return 0;
+    memcpy(&image[offset], mimeType, mimeTypeLen);
+    offset += mimeTypeLen;
+    memcpy(&image[offset], payload, payloadLen);
+    offset += payloadLen;
+    image[offset] = 0xFE;                              // Terminator TLV
+
+    return image;
+}
+
+static bool writePageWithRetry(uint8_t page, const uint8_t* data) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        esp_task_wdt_reset();
+        if (nfc.ntag2xx_WritePage(page, (uint8_t*)data)) {
+            return true;
+        }
+        Serial.printf("Write attempt %d/3 for page %d failed\n", attempt + 1, page);
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
-    
-    Serial.println("✓ Tag successfully recognized");
-    
-    // Step 4: Test basic page reading
-    Serial.println("4. Testing basic functionality...");
-    vTaskDelay(200 / portTICK_PERIOD_MS); // Give interface time to stabilize
-    
-    ccReadable = nfc.ntag2xx_ReadPage(3, ccTest);
-    Serial.print("Capability Container after reset readable: ");
-    Serial.println(ccReadable ? "✓" : "❌");
-    
-    if (!ccReadable) {
-      Serial.println("❌ NFC interface still not working after reset");
-      oledShowMessage("NFC still broken");
-      vTaskDelay(3000 / portTICK_PERIOD_MS);
-      return 0;
+    return false;
+}
+
+// Write a page and read it back, rewriting it up to three times on mismatch
+static bool writePageVerified(uint8_t page, const uint8_t* data, bool settle) {
+    uint8_t readBack[4];
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        if (!writePageWithRetry(page, data)) {
+            return false;
+        }
+        if (settle) {
+            vTaskDelay(20 / portTICK_PERIOD_MS);
+        }
+        if (nfc.ntag2xx_ReadPage(page, readBack) && memcmp(readBack, data, 4) == 0) {
+            return true;
+        }
+        Serial.printf("Verification attempt %d/3 for page %d failed\n", attempt + 1, page);
     }
-    
-    Serial.println("✓ NFC interface successfully restored");
-  } else {
-    Serial.println("✓ NFC interface is functional");
-  }
-  
-  // Display CC content for debugging
-  if (ccReadable) {
-    Serial.print("CC content: ");
-    for (int i = 0; i < 4; i++) {
-      if (ccTest[i] < 0x10) Serial.print("0");
-      Serial.print(ccTest[i], HEX);
-      Serial.print(" ");
+    return false;
+}
+
+// Paranoid mode only: interface test and a test write on page 10 (restored
+// afterwards) before the tag is touched for real
+static bool paranoidPreWriteCheck(const NtagGeometry& geometry) {
+    uint8_t ccTest[4];
+    if (!robustPageRead(3, ccTest)) {
+        Serial.println("❌ Capability container not readable - reinitializing PN532");
+        nfc.begin();
+        vTaskDelay(500 / portTICK_PERIOD_MS);
+        if (!nfc.getFirmwareVersion()) {
+            oledShowMessage("NFC Reset failed");
+            return false;
+        }
+        nfc.SAMConfig();
+        vTaskDelay(200 / portTICK_PERIOD_MS);
+
+        uint8_t uid[7];
+        uint8_t uidLength;
+        if (!nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 1000) || !robustPageRead(3, ccTest)) {
+            oledShowMessage("Tag lost after reset");
+            return false;
+        }
     }
-    Serial.println();
-  }
-  
-  Serial.println("=== SCHRITT 2: INTERFACE-FUNKTIONSTEST ===");
-  
-  // Test a few critical pages to ensure stable operation
-  uint8_t testData[4];
-  bool basicPagesReadable = true;
-  
-  for (uint8_t testPage = 0; testPage <= 6; testPage++) {
-    bool readable = nfc.ntag2xx_ReadPage(testPage, testData);
-    Serial.print("Page ");
-    Serial.print(testPage);
-    Serial.print(": ");
-    if (readable) {
-      Serial.print("✓ - ");
-      for (int i = 0; i < 4; i++) {
-        if (testData[i] < 0x10) Serial.print("0");
-        Serial.print(testData[i], HEX);
-        Serial.print(" ");
-      }
-      Serial.println();
-    } else {
-      Serial.println("❌ - Not readable");
-      if (testPage >= 3 && testPage <= 6) { // Critical pages for NDEF
-        basicPagesReadable = false;
-      }
+
+    // Small type 2 tags have no page 10 in their data area
+    if (geometry.lastUserPage < 10) {
+        Serial.println("Data area ends before page 10, skipping the write test");
+        return true;
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS); // Small delay between reads
-  }
-  
-  if (!basicPagesReadable) {
-    Serial.println("❌ CRITICAL ERROR: Basic NDEF pages not readable!");
-    Serial.println("Tag or interface is defective");
-    oledShowMessage("Tag/Interface defect");
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-  
-  Serial.println("✓ All critical pages are readable");
-  Serial.println("===================================================");
 
-  Serial.println();
-  Serial.println("=== SCHRITT 3: SCHREIBBEREITSCHAFTSTEST ===");
-  
-  // Test write capabilities before attempting the full write
-  Serial.println("Testing tag write capabilities...");
-  
-  uint8_t testPage[4] = {0xAA, 0xBB, 0xCC, 0xDD}; // Test pattern
-  uint8_t originalPage[4]; // Store original content
-  
-  // First, read original content of test page
-  if (!nfc.ntag2xx_ReadPage(10, originalPage)) {
-    Serial.println("ERROR: Cannot read test page for backup");
-    oledShowMessage("Test page read error");
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-  
-  Serial.print("Original content page 10: ");
-  for (int i = 0; i < 4; i++) {
-    if (originalPage[i] < 0x10) Serial.print("0");
-    Serial.print(originalPage[i], HEX);
-    Serial.print(" ");
-  }
-  Serial.println();
-  
-  // Perform write test
-  if (!nfc.ntag2xx_WritePage(10, testPage)) {
-    Serial.println("ERROR: Write test failed!");
-    Serial.println("Tag may be write-protected or defective");
-    
-    // Additional diagnostics
-    Serial.println("=== EXTENDED WRITE TEST DIAGNOSTICS ===");
-    
-    // Check if tag is still present
-    uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t uidLength;
-    bool tagStillPresent = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 1000);
-    Serial.print("Tag still detected: ");
-    Serial.println(tagStillPresent ? "✓" : "❌");
-    
-    if (!tagStillPresent) {
-      Serial.println("CAUSE: Tag was removed during write test!");
-      oledShowMessage("Tag removed");
-    } else {
-      Serial.println("CAUSE: Tag is present but not writable");
-      Serial.println("Possibly: write protection, defect, or interface problem");
-      oledShowMessage("Tag write protected?");
+    const uint8_t testPattern[4] = {0xAA, 0xBB, 0xCC, 0xDD};
+    uint8_t originalPage[4];
+    if (!robustPageRead(10, originalPage)) {
+        oledShowMessage("Test page read error");
+        return false;
     }
-    Serial.println("==========================================");
-    
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-  
-  // Verify test write
-  uint8_t readBack[4];
-  vTaskDelay(20 / portTICK_PERIOD_MS); // Wait for write to complete
-  
-  if (!nfc.ntag2xx_ReadPage(10, readBack)) {
-    Serial.println("ERROR: Cannot read back test data!");
-    oledShowMessage("Test verify failed");
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-  
-  bool testSuccess = true;
-  for (int i = 0; i < 4; i++) {
-    if (readBack[i] != testPage[i]) {
-      testSuccess = false;
-      break;
+    if (!writePageVerified(10, testPattern, true)) {
+        Serial.println("ERROR: Write test failed - tag may be write-protected or defective");
+        oledShowMessage("Tag write protected?");
+        return false;
     }
-  }
-  
-  if (!testSuccess) {
-    Serial.println("ERROR: Write test failed - data does not match!");
-    Serial.print("Written: ");
-    for (int i = 0; i < 4; i++) {
-      Serial.print(testPage[i], HEX); Serial.print(" ");
+    if (!writePageVerified(10, originalPage, true)) {
+        Serial.println("WARNING: Could not restore original content of page 10!");
     }
-    Serial.println();
-    Serial.print("Read: ");
-    for (int i = 0; i < 4; i++) {
-      Serial.print(readBack[i], HEX); Serial.print(" ");
+
+    Serial.println("✓ Write test successful - tag is fully functional");
+    vTaskDelay(200 / portTICK_PERIOD_MS);
+    return true;
+}
+
+// Paranoid mode only: let the tag settle and make sure it still answers
+static void paranoidPostWriteCheck() {
+    vTaskDelay(300 / portTICK_PERIOD_MS);
+
+    uint8_t postWriteTest[4];
+    for (int attempt = 0; attempt < 5; attempt++) {
+        if (nfc.ntag2xx_ReadPage(3, postWriteTest)) {
+            Serial.println("✓ NFC interface is stable after write operation");
+            return;
+        }
+        vTaskDelay(200 / portTICK_PERIOD_MS);
+        uint8_t uid[7];
+        uint8_t uidLength;
+        if (!nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 1000)) {
+            Serial.println("Tag was removed during/after write operation!");
+            return;
+        }
     }
-    Serial.println();
-    return 0;
-  }
-  
-  // Restore original content
-  Serial.println("Restoring original content...");
-  if (!nfc.ntag2xx_WritePage(10, originalPage)) {
-    Serial.println("WARNING: Could not restore original content!");
-  } else {
-    Serial.println("✓ Original content restored");
-  }
-  
-  Serial.println("✓ Write test successful - tag is fully functional");
-  Serial.println("======================================================");
+    Serial.println("WARNING: NFC interface no longer stable after write operation");
+}
 
-  // STEP 4: NDEF initialization with verification
-  Serial.println();
-  Serial.println("=== STEP 4: NDEF INITIALIZATION ===");
-  if (!initializeNdefStructure()) {
-    Serial.println("ERROR: Could not initialize NDEF structure!");
-    oledShowMessage("NDEF init failed");
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-  
-  // Verify NDEF initialization
-  uint8_t ndefCheck[8];
-  bool ndefVerified = true;
-  for (uint8_t page = 4; page < 6; page++) {
-    if (!nfc.ntag2xx_ReadPage(page, &ndefCheck[(page-4)*4])) {
-      ndefVerified = false;
-      break;
+// Write a TLV image starting at page 4, touching only pages whose content
+// differs from what is on the tag. Page 4 carries the TLV length and is written
+// last; while other pages change it declares an empty NDEF message, so a tag
+// removed mid-write is empty instead of half-valid.
+bool ntagWriteTlvImage(const uint8_t* image, uint16_t imageLen, NdefWriteStats& stats) {
+    memset(&stats, 0, sizeof(stats));
+    unsigned long startTime = millis();
+    unsigned long phaseStart = startTime;
+    const nfcWritePolicyType policy = nfcWritePolicy;
+    const bool verifyEachPage = policy == NFC_VERIFY_PER_PAGE || policy == NFC_VERIFY_PARANOID;
+    const bool verifyAtEnd = policy == NFC_VERIFY_FINAL_CHECKSUM || policy == NFC_VERIFY_PARANOID;
+    stats.policy = policy;
+
+    NtagGeometry geometry = currentTagGeometry();
+    if (geometry.userDataBytes == 0) {
+        Serial.println("ERROR: Unknown tag type, refusing to write");
+        oledShowMessage("Unknown tag type");
+        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        return false;
     }
-  }
-  
-  if (ndefVerified) {
-    Serial.print("NDEF header after initialization: ");
-    for (int i = 0; i < 8; i++) {
-      if (ndefCheck[i] < 0x10) Serial.print("0");
-      Serial.print(ndefCheck[i], HEX);
-      Serial.print(" ");
+    if (imageLen > geometry.userDataBytes) {
+        Serial.printf("ERROR: %d bytes do not fit into %s (%d bytes user data)\n", imageLen, geometry.name, geometry.userDataBytes);
+        oledShowMessage("Tag too small for payload");
+        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        return false;
     }
-    Serial.println();
-  }
-  
-  Serial.println("✓ NDEF structure initialized and verified");
-  Serial.println("==========================================");
 
-  // STEP 5: Allow interface to stabilize before major write operation
-  Serial.println();
-  Serial.println("=== SCHRITT 5: NFC-INTERFACE STABILISIERUNG ===");
-  Serial.println("Stabilizing NFC interface before main write operation...");
-  
-  // Give the interface time to fully settle after NDEF initialization
-  vTaskDelay(200 / portTICK_PERIOD_MS);
-  
-  // Test interface stability with a simple read
-  uint8_t stabilityTest[4];
-  bool interfaceStable = false;
-  for (int attempts = 0; attempts < 3; attempts++) {
-    if (nfc.ntag2xx_ReadPage(4, stabilityTest)) {
-      Serial.print("Interface stability test ");
-      Serial.print(attempts + 1);
-      Serial.println("/3: ✓");
-      interfaceStable = true;
-      break;
-    } else {
-      Serial.print("Interface stability test ");
-      Serial.print(attempts + 1);
-      Serial.println("/3: ❌");
-      vTaskDelay(100 / portTICK_PERIOD_MS);
+    if (policy == NFC_VERIFY_PARANOID) {
+        bool ready = paranoidPreWriteCheck(geometry);
+        stats.preCheckMs = millis() - phaseStart;
+        if (!ready) {
+            vTaskDelay(3000 / portTICK_PERIOD_MS);
+            return false;
+        }
+        phaseStart = millis();
     }
-  }
-  
-  if (!interfaceStable) {
-    Serial.println("ERROR: NFC interface is not stable enough for write operation");
-    oledShowMessage("NFC Interface unstable");
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-  
-  Serial.println("✓ NFC interface is stable - write operation can begin");
-  Serial.println("=========================================================");
-
-  // Allocate memory for the complete TLV structure
-  uint8_t* tlvData = (uint8_t*) malloc(totalTlvSize);
-  if (tlvData == NULL) {
-    Serial.println("Error: Not enough memory for TLV data.");
-    oledShowMessage("Memory error");
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
-    return 0;
-  }
-
-  // Build TLV structure
-  uint16_t offset = 0;
-  
-  // TLV Header
-  tlvData[offset++] = 0x03; // NDEF Message TLV Tag
-  
-  if (ndefRecordSize <= 254) {
-    // Standard length format
-    tlvData[offset++] = (uint8_t)ndefRecordSize;
-  } else {
-    // Extended length format
-    tlvData[offset++] = 0xFF;
-    tlvData[offset++] = (uint8_t)(ndefRecordSize >> 8);  // High byte
-    tlvData[offset++] = (uint8_t)(ndefRecordSize & 0xFF); // Low byte
-  }
-
-  // NDEF Record Header
-  tlvData[offset++] = 0xD2; // NDEF Record Header (TNF=0x2:MIME Media + SR + ME + MB)
-  tlvData[offset++] = mimeTypeLen; // Type Length
-  tlvData[offset++] = (uint8_t)payloadLen; // Payload Length (short record format)
-
-  // MIME Type
-  memcpy(&tlvData[offset], mimeType, mimeTypeLen);
-  offset += mimeTypeLen;
 
-  // JSON Payload
-  memcpy(&tlvData[offset], payload, payloadLen);
-  offset += payloadLen;
-
-  // Terminator TLV
-  tlvData[offset] = 0xFE;
-
-  Serial.print("Total TLV length: ");
-  Serial.println(offset + 1);
-
-  // Debug: Print first 64 bytes of TLV data
-  Serial.println("TLV Daten (erste 64 Bytes):");
-  for (int i = 0; i < min((int)(offset + 1), 64); i++) {
-    if (tlvData[i] < 0x10) Serial.print("0");
-    Serial.print(tlvData[i], HEX);
-    Serial.print(" ");
-    if ((i + 1) % 16 == 0) Serial.println();
-  }
-  Serial.println();
+    const uint8_t firstPage = geometry.firstUserPage;
+    uint8_t pageCount = (imageLen + 3) / 4;
+    uint16_t bufferSize = pageCount * 4;
+
+    uint8_t* target = (uint8_t*)malloc(bufferSize);
+    uint8_t* current = (uint8_t*)malloc(bufferSize);
+    bool* dirty = (bool*)malloc(pageCount * sizeof(bool));
+    if (!target || !current || !dirty) {
+        free(target);
+        free(current);
+        free(dirty);
+        Serial.println("Error: Not enough memory for TLV data.");
+        oledShowMessage("Memory error");
+        vTaskDelay(2000 / portTICK_PERIOD_MS);
+        return false;
+    }
+    memset(target, 0, bufferSize);
+    memcpy(target, image, imageLen);
 
-  // Write data to tag pages (starting from page 4)
-  uint16_t bytesWritten = 0;
-  uint8_t pageNumber = 4;
-  uint16_t totalBytes = offset + 1;
+    // Current content of the range; if it can't be read every page gets written
+    bool currentValid = ntagReadPages(firstPage, pageCount, current);
+    if (!currentValid) {
+        Serial.println("Could not read current tag content, rewriting all pages");
+    }
 
-  Serial.println();
-  Serial.println("=== STEP 6: WRITE NEW NDEF DATA ===");
-  Serial.print("Writing ");
-  Serial.print(totalBytes);
-  Serial.print(" bytes in ");
-  Serial.print((totalBytes + 3) / 4); // Round up division
-  Serial.println(" pages...");
-
-  while (bytesWritten < totalBytes && pageNumber <= maxWritablePage) {
-    // Additional safety check before writing each page
-    if (pageNumber > maxWritablePage) {
-      Serial.print("STOP: Reached maximum writable page ");
-      Serial.println(maxWritablePage);
-      break;
+    bool bodyDirty = false;
+    for (uint8_t i = 0; i < pageCount; i++) {
+        dirty[i] = !currentValid || memcmp(target + i * 4, current + i * 4, 4) != 0;
+        if (i > 0 && dirty[i]) bodyDirty = true;
     }
-    
-    // Clear page buffer
-    memset(pageBuffer, 0, 4);
-    
-    // Calculate how many bytes to write to this page
-    uint16_t bytesToWrite = min(4, (int)(totalBytes - bytesWritten));
-    
-    // Copy data to page buffer
-    memcpy(pageBuffer, &tlvData[bytesWritten], bytesToWrite);
-
-    // Write page to tag with retry mechanism
-    bool writeSuccess = false;
-    for (int writeAttempt = 0; writeAttempt < 3; writeAttempt++) {
-      if (nfc.ntag2xx_WritePage(pageNumber, pageBuffer)) {
-        writeSuccess = true;
-        break;
-      } else {
-        Serial.print("Schreibversuch ");
-        Serial.print(writeAttempt + 1);
-        Serial.print("/3 for page ");
-        Serial.print(pageNumber);
-        Serial.println(" failed");
-        
-        if (writeAttempt < 2) {
-          vTaskDelay(50 / portTICK_PERIOD_MS); // Wait before retry
+    stats.readMs = millis() - phaseStart;
+    phaseStart = millis();
+
+    auto writePage = [&](uint8_t page, const uint8_t* data) -> bool {
+        bool ok = verifyEachPage ? writePageVerified(page, data, policy == NFC_VERIFY_PARANOID)
+                                 : writePageWithRetry(page, data);
+        if (ok) {
+            stats.pagesWritten++;
+            if (verifyEachPage) stats.pagesVerified++;
         }
-      }
-    }
+        return ok;
+    };
 
-    if (!writeSuccess) {
-      Serial.print("ERROR writing page ");
-      Serial.println(pageNumber);
-      Serial.print("Possibly reached page limit for ");
-      Serial.println(tagType);
-      Serial.print("Expected maximum: ");
-      Serial.println(maxWritablePage);
-      Serial.print("Actual maximum seems to be lower!");
-      
-      // Update max page for future operations
-      if (pageNumber > 4) {
-        Serial.print("Setting new maximum to page ");
-        Serial.println(pageNumber - 1);
-      }
-      
-      free(tlvData);
-      return 0;
+    bool success = true;
+
+    // Invalidate the message while the body is inconsistent
+    if (bodyDirty) {
+        const uint8_t emptyNdef[4] = { 0x03, 0x00, 0xFE, 0x00 };
+        if (!currentValid || memcmp(current, emptyNdef, 4) != 0) {
+            success = writePage(firstPage, emptyNdef);
+        }
+        dirty[0] = true;
     }
 
-    // IMMEDIATE verification after each write - this is critical!
-    Serial.print("Verifying page ");
-    Serial.print(pageNumber);
-    Serial.print("... ");
-    
-    uint8_t verifyBuffer[4];
-    vTaskDelay(20 / portTICK_PERIOD_MS); // Increased delay before verification
-    
-    // Verification with retry mechanism
-    bool verifySuccess = false;
-    for (int verifyAttempt = 0; verifyAttempt < 3; verifyAttempt++) {
-      if (nfc.ntag2xx_ReadPage(pageNumber, verifyBuffer)) {
-        bool writeMatches = true;
-        for (int i = 0; i < bytesToWrite; i++) {
-          if (verifyBuffer[i] != pageBuffer[i]) {
-            writeMatches = false;
-            Serial.println();
-            Serial.print("VERIFICATION ERROR at byte ");
-            Serial.print(i);
-            Serial.print(" - Expected: 0x");
-            Serial.print(pageBuffer[i], HEX);
-            Serial.print(", Read: 0x");
-            Serial.println(verifyBuffer[i], HEX);
-            break;
-          }
+    for (uint8_t i = 1; success && i < pageCount; i++) {
+        if (!dirty[i]) {
+            stats.pagesSkipped++;
+            continue;
         }
-        
-        if (writeMatches) {
-          verifySuccess = true;
-          break;
-        } else if (verifyAttempt < 2) {
-          Serial.print("Verification attempt ");
-          Serial.print(verifyAttempt + 1);
-          Serial.println("/3 failed, retrying...");
-          vTaskDelay(30 / portTICK_PERIOD_MS);
+        if (!writePage(firstPage + i, target + i * 4)) {
+            Serial.printf("ERROR writing page %d\n", firstPage + i);
+            success = false;
+            break;
         }
-      } else {
-        Serial.print("Verification read attempt ");
-        Serial.print(verifyAttempt + 1);
-        Serial.println("/3 failed");
-        if (verifyAttempt < 2) {
-          vTaskDelay(30 / portTICK_PERIOD_MS);
+        yield();
+    }
+
+    // Header last
+    if (success) {
+        if (dirty[0]) {
+            success = writePage(firstPage, target);
+        } else {
+            stats.pagesSkipped++;
         }
-      }
     }
-    
-    if (!verifySuccess) {
-      Serial.println("❌ WRITE/VERIFICATION FAILED!");
-      free(tlvData);
-      return 0;
-    } else {
-      Serial.println("✓");
+    stats.writeMs = millis() - phaseStart;
+    phaseStart = millis();
+
+    // Read back the whole range once and compare
+    if (success && verifyAtEnd && stats.pagesWritten > 0) {
+        stats.pagesVerified = 0;
+        if (!ntagReadPages(firstPage, pageCount, current)) {
+            Serial.println("ERROR: Could not read back written pages");
+            success = false;
+        } else {
+            for (uint8_t i = 0; i < pageCount; i++) {
+                if (memcmp(target + i * 4, current + i * 4, 4) != 0) {
+                    Serial.printf("VERIFICATION ERROR on page %d\n", firstPage + i);
+                    success = false;
+                    break;
+                }
+                stats.pagesVerified++;
+            }
+        }
     }
+    stats.verifyMs = millis() - phaseStart;
+    phaseStart = millis();
+
+    free(dirty);
+    free(target);
+    free(current);
+
+    // The tag may have been swapped or misidentified, identify it again next time
+    if (!success) invalidateTagGeometry(currentTagUid, currentTagUidLength);
 
-    Serial.print("Page ");
-    Serial.print(pageNumber);
-    Serial.print(" ✓: ");
-    for (int i = 0; i < 4; i++) {
-      if (pageBuffer[i] < 0x10) Serial.print("0");
-      Serial.print(pageBuffer[i], HEX);
-      Serial.print(" ");
+    if (success && policy == NFC_VERIFY_PARANOID) {
+        paranoidPostWriteCheck();
+        stats.postCheckMs = millis() - phaseStart;
     }
-    Serial.println();
 
-    bytesWritten += bytesToWrite;
-    pageNumber++;
-    
-    yield();
-    vTaskDelay(10 / portTICK_PERIOD_MS); // Slightly increased delay between page writes
+    stats.durationMs = millis() - startTime;
+    lastNdefWriteStats = stats;
+    Serial.printf("NDEF write %s (%s): %d pages written, %d skipped, %d verified in %lu ms\n",
+                  success ? "done" : "FAILED", nfcWritePolicyToString(policy), stats.pagesWritten,
+                  stats.pagesSkipped, stats.pagesVerified, stats.durationMs);
+    Serial.printf("  pre-check %lu ms, read %lu ms, write %lu ms, verify %lu ms, post-check %lu ms\n",
+                  stats.preCheckMs, stats.readMs, stats.writeMs, stats.verifyMs, stats.postCheckMs);
+    return success;
+}
+
+// Compact image of a JSON payload, NULL if the payload can't be encoded
+static uint8_t* buildCompactTlvImage(const char* payload, uint16_t& imageLen) {
+  uint8_t compact[255];
+  uint16_t compactLen = 0;
+  if (!compactTagEncode(payload, compact, sizeof(compact), compactLen)) {
+    return NULL;
   }
+  return buildNdefTlvImage(COMPACT_TAG_MIME_TYPE, compact, compactLen, imageLen);
+}
 
-  free(tlvData);
-  
-  if (bytesWritten < totalBytes) {
-    Serial.println("WARNING: Not all data could be written!");
-    Serial.print("Written: ");
-    Serial.print(bytesWritten);
-    Serial.print(" of ");
-    Serial.print(totalBytes);
-    Serial.println(" bytes");
-    Serial.print("Stopped at page: ");
-    Serial.println(pageNumber - 1);
-    return 0;
+uint8_t ntag2xx_WriteNDEF(const char *payload) {
+  uint16_t payloadLen = strlen(payload);
+  Serial.print("Payload length: ");
+  Serial.println(payloadLen);
+  Serial.print("Payload: ");Serial.println(payload);
+
+  uint16_t imageLen = 0;
+  uint8_t* image = NULL;
+
+  if (nfcTagEncoding == NFC_TAG_ENCODING_COMPACT) {
+    image = buildCompactTlvImage(payload, imageLen);
+    if (image == NULL) Serial.println("Payload can't be encoded compactly, writing JSON");
   }
-  
-  Serial.println();
-  Serial.println("✓ NDEF message successfully written!");
-  Serial.print("✓ Tag type: ");Serial.println(tagType);
-  Serial.print("✓ Total ");Serial.print(bytesWritten);Serial.println(" bytes written");
-  Serial.print("✓ Used pages: 4-");Serial.println(pageNumber - 1);
-  Serial.print("✓ Memory usage: ");
-  Serial.print((bytesWritten * 100) / availableUserData);
-  Serial.println("%");
-  Serial.println("✓ Existing data has been overwritten");
-  
-  // CRITICAL: Allow NFC interface to stabilize after write operation
-  Serial.println();
-  Serial.println("=== STEP 7: NFC INTERFACE STABILIZATION AFTER WRITE OPERATION ===");
-  Serial.println("Stabilizing NFC interface after write operation...");
-  
-  // Give the tag and interface time to settle after write operation
-  vTaskDelay(300 / portTICK_PERIOD_MS); // Increased stabilization time
-  
-  // Test if the interface is still responsive
-  uint8_t postWriteTest[4];
-  bool interfaceResponsive = false;
-  
-  for (int stabilityAttempt = 0; stabilityAttempt < 5; stabilityAttempt++) {
-    Serial.print("Post-write interface test ");
-    Serial.print(stabilityAttempt + 1);
-    Serial.print("/5... ");
-    
-    if (nfc.ntag2xx_ReadPage(3, postWriteTest)) { // Read capability container
-      Serial.println("✓");
-      interfaceResponsive = true;
-      break;
-    } else {
-      Serial.println("❌");
-      
-      if (stabilityAttempt < 4) {
-        Serial.println("Waiting and trying to stabilize interface...");
-        vTaskDelay(200 / portTICK_PERIOD_MS);
-        
-        // Try to re-establish communication with a simple tag presence check
-        uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
-        uint8_t uidLength;
-        bool tagStillPresent = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 1000);
-        Serial.print("Tag presence check: ");
-        Serial.println(tagStillPresent ? "✓" : "❌");
-        
-        if (!tagStillPresent) {
-          Serial.println("Tag was removed during/after write operation!");
-          break;
-        }
+
+  if (image == NULL) {
+    image = buildNdefTlvImage("application/json", (const uint8_t*)payload, payloadLen, imageLen);
+
+    // JSON too large for the tag (typically NTAG213): try the compact encoding
+    if (image != NULL && imageLen > currentTagGeometry().userDataBytes) {
+      uint16_t compactImageLen = 0;
+      uint8_t* compactImage = buildCompactTlvImage(payload, compactImageLen);
+      if (compactImage != NULL) {
+        Serial.printf("JSON needs %d bytes, using compact encoding (%d bytes)\n", imageLen, compactImageLen);
+        free(image);
+        image = compactImage;
+        imageLen = compactImageLen;
       }
     }
   }
-  
-  if (!interfaceResponsive) {
-    Serial.println("WARNING: NFC interface no longer stable after write operation");
-    Serial.println("Write operation was successful, but interface may need reset");
-  } else {
-    Serial.println("✓ NFC interface is stable after write operation");
+
+  if (image == NULL) {
+    Serial.println("Error: Not enough memory for TLV data.");
+    oledShowMessage("Memory error");
+    vTaskDelay(2000 / portTICK_PERIOD_MS);
+    return 0;
   }
-  
-  Serial.println("==================================================================");
-  
-  return 1;
+
+  NdefWriteStats stats;
+  bool success = ntagWriteTlvImage(image, imageLen, stats);
+  free(image);
+
+  return success ? 1 : 0;
+}
+
+// Publish decoded OpenPrintTag data and hand it to Spoolman
+static void processOpenPrintTag(const OpenPrintTagData& optData, const String& optJson, const String& uidString) {
+  nfcJsonData = optJson;
+  Serial.println("OpenPrintTag JSON for web UI:");
+  Serial.println(nfcJsonData);
+
+  // Also generate OpenSpool-compatible JSON for Spoolman matching
+  String openSpoolCompat = openPrintTagToOpenSpoolJson(optData);
+  Serial.println("OpenSpool-compatible JSON:");
+  Serial.println(openSpoolCompat);
+
+  // Send to web UI via WebSocket
+  String wsMsg = "{\"type\":\"nfcData\",\"format\":\"openprinttag\",\"payload\":" + nfcJsonData + "}";
+  ws.textAll(wsMsg);
+
+  // For Spoolman integration, attempt to create spool from OpenPrintTag data
+  if (spoolmanConnected) {
+    oledShowProgressBar(2, octoEnabled ? 5 : 4, "OpenPrintTag", optData.materialName.c_str());
+    // Create a new spool in Spoolman from the rich OpenPrintTag metadata
+    if (!createSpoolFromOpenPrintTag(optData, uidString)) {
+      Serial.println("Note: Could not auto-create Spoolman spool from OpenPrintTag");
+      // Not a fatal error — tag data is still displayed in web UI
+    }
+  }
+}
+
+// ##### NDEF decoding #####
+// Cache fingerprint of a message read from page 4 on; false when the block
+// holding sm_id lies outside of it
+static bool tagCacheFingerprintOf(const byte* data, uint16_t size, uint32_t& fingerprint) {
+  if (size < NTAG_READ_BLOCK_PAGES * 4) return false;
+
+  uint8_t page = tagCacheIdentityPage(data);
+  if (page == 0) {
+    fingerprint = tagCacheFingerprint(data, nullptr);
+    return true;
+  }
+
+  uint16_t offset = (page - 4) * 4;
+  if (offset + NTAG_READ_BLOCK_PAGES * 4 > size) return false;
+  fingerprint = tagCacheFingerprint(data, data + offset);
+  return true;
 }
 
-bool decodeNdefAndReturnJson(const byte* encodedMessage, String uidString) {
+bool decodeNdefAndReturnJson(const byte* encodedMessage, uint16_t messageSize, String uidString) {
   oledShowProgressBar(1, octoEnabled?5:4, "Reading", "Decoding data");
+  uint32_t decodeStart = micros();
 
   // Debug: Print first 32 bytes of the raw data
   Serial.println("Raw NDEF data (first 32 bytes):");
-  for (int i = 0; i < 32; i++) {
+  for (int i = 0; i < 32 && i < messageSize; i++) {
     if (encodedMessage[i] < 0x10) Serial.print("0");
     Serial.print(encodedMessage[i], HEX);
     Serial.print(" ");
@@ -1081,126 +988,26 @@ bool decodeNdefAndReturnJson(const byte* encodedMessage, String uidString) {
   }
   Serial.println();
 
-  // Look for the NDEF TLV structure starting from the beginning
-  int tlvOffset = 0;
-  bool foundNdefTlv = false;
-  
-  // Search for NDEF TLV (0x03) in the first few bytes
-  for (int i = 0; i < 16; i++) {
-    if (encodedMessage[i] == 0x03) {
-      tlvOffset = i;
-      foundNdefTlv = true;
-      Serial.print("Found NDEF TLV at offset: ");
-      Serial.println(tlvOffset);
-      break;
-    }
-  }
-
-  if (!foundNdefTlv) {
-    Serial.println("No NDEF TLV found in tag data");
+  TagDecodeResult result;
+  TagDecodeStatus status = decodeTagBuffer(encodedMessage, messageSize, result);
+  if (status == TAG_DECODE_NO_RECORD) {
     return false;
   }
 
-  // Get the NDEF message length from TLV
-  uint16_t ndefMessageLength = 0;
-  int ndefRecordOffset = 0;
-  
-  if (encodedMessage[tlvOffset + 1] == 0xFF) {
-    // Extended length format: next 2 bytes contain the actual length
-    ndefMessageLength = (encodedMessage[tlvOffset + 2] << 8) | encodedMessage[tlvOffset + 3];
-    ndefRecordOffset = tlvOffset + 4; // Skip TLV tag + 0xFF + 2 length bytes
-    Serial.print("NDEF Message Length (extended): ");
-  } else {
-    // Standard length format: single byte contains the length
-    ndefMessageLength = encodedMessage[tlvOffset + 1];
-    ndefRecordOffset = tlvOffset + 2; // Skip TLV tag + 1 length byte
-    Serial.print("NDEF Message Length (standard): ");
-  }
-  Serial.println(ndefMessageLength);
-
-  // Get pointer to NDEF record
-  const byte* ndefRecord = &encodedMessage[ndefRecordOffset];
-  
-  // Parse NDEF record header
-  byte recordHeader = ndefRecord[0];
-  byte typeLength = ndefRecord[1];
-  
-  Serial.print("NDEF Record Header: 0x");
-  Serial.println(recordHeader, HEX);
-  Serial.print("Type Length: ");
-  Serial.println(typeLength);
-
-  // Determine payload length (can be 1 or 4 bytes depending on SR flag)
-  uint32_t payloadLength = 0;
-  byte payloadLengthBytes = 1;
-  byte payloadLengthOffset = 2;
-  
-  // Check if Short Record (SR) flag is set (bit 4)
-  if (recordHeader & 0x10) { // SR flag
-    payloadLength = ndefRecord[2];
-    payloadLengthBytes = 1;
-    payloadLengthOffset = 2;
-  } else {
-    // Long record format (4 bytes for payload length)
-    payloadLength = (ndefRecord[2] << 24) | (ndefRecord[3] << 16) | 
-                   (ndefRecord[4] << 8) | ndefRecord[5];
-    payloadLengthBytes = 4;
-    payloadLengthOffset = 2;
-  }
-
-  Serial.print("Payload Length: ");
-  Serial.println(payloadLength);
-  Serial.print("Payload Length Bytes: ");
-  Serial.println(payloadLengthBytes);
-
-  // Check for ID field (if IL flag is set)
-  byte idLength = 0;
-  if (recordHeader & 0x08) { // IL flag
-    idLength = ndefRecord[payloadLengthOffset + payloadLengthBytes];
-    Serial.print("ID Length: ");
-    Serial.println(idLength);
-  }
-
-  // Calculate offset to payload
-  byte payloadOffset = 1 + 1 + payloadLengthBytes + typeLength + idLength;
-  
-  Serial.print("Calculated payload offset: ");
-  Serial.println(payloadOffset);
-
-  // Verify we have enough data
-  if (payloadOffset + payloadLength > ndefMessageLength) {
-    Serial.println("Invalid NDEF structure - payload extends beyond message");
-    Serial.print("Payload offset + length: ");
-    Serial.print(payloadOffset + payloadLength);
-    Serial.print(", NDEF message length: ");
-    Serial.println(ndefMessageLength);
-    return false;
-  }
-
-  // Print the record type for debugging
-  const uint8_t* recordTypePtr = &ndefRecord[1 + 1 + payloadLengthBytes];
-  Serial.print("Record Type: ");
-  for (int i = 0; i < typeLength; i++) {
-    Serial.print((char)recordTypePtr[i]);
-  }
-  Serial.println();
-
-  // --- Auto-detect tag format ---
-  const uint8_t* payloadPtr = &ndefRecord[payloadOffset];
-  NfcTagFormat tagFormat = detectTagFormat(payloadPtr, payloadLength, typeLength, recordTypePtr);
+  NfcTagFormat tagFormat = result.format;
   Serial.print("Detected tag format: ");
   switch (tagFormat) {
     case TAG_FORMAT_OPENSPOOL:    Serial.println("OpenSpool (JSON)"); break;
     case TAG_FORMAT_OPENPRINTTAG: Serial.println("OpenPrintTag (binary TLV)"); break;
     case TAG_FORMAT_RAW_SPOOL_ID: Serial.println("Raw Spool ID"); break;
+    case TAG_FORMAT_COMPACT:      Serial.println("Compact (fm/s)"); break;
     default:                      Serial.println("Unknown"); break;
   }
 
   // --- Handle OpenPrintTag binary TLV format ---
   if (tagFormat == TAG_FORMAT_OPENPRINTTAG) {
-    Serial.println("=== Parsing OpenPrintTag data ===");
-    OpenPrintTagData optData;
-    if (parseOpenPrintTag(payloadPtr, payloadLength, optData)) {
+    const OpenPrintTagData& optData = result.optData;
+    if (status == TAG_DECODE_OK) {
       Serial.println("OpenPrintTag parsed successfully:");
       Serial.printf("  Material: %s (%s)\n", optData.materialName.c_str(),
                      optMaterialTypeToString(optData.materialType));
@@ -1210,29 +1017,10 @@ bool decodeNdefAndReturnJson(const byte* encodedMessage, String uidString) {
       if (optData.minPrintTemp >= 0)
         Serial.printf("  Print Temp: %d-%d°C\n", optData.minPrintTemp, optData.maxPrintTemp);
 
-      // Convert to JSON for web UI display
-      nfcJsonData = openPrintTagToJson(optData);
-      Serial.println("OpenPrintTag JSON for web UI:");
-      Serial.println(nfcJsonData);
-
-      // Also generate OpenSpool-compatible JSON for Spoolman matching
-      String openSpoolCompat = openPrintTagToOpenSpoolJson(optData);
-      Serial.println("OpenSpool-compatible JSON:");
-      Serial.println(openSpoolCompat);
-
-      // Send to web UI via WebSocket
-      String wsMsg = "{\"type\":\"nfcData\",\"format\":\"openprinttag\",\"payload\":" + nfcJsonData + "}";
-      ws.textAll(wsMsg);
-
-      // For Spoolman integration, attempt to create spool from OpenPrintTag data
-      if (spoolmanConnected) {
-        oledShowProgressBar(2, octoEnabled ? 5 : 4, "OpenPrintTag", optData.materialName.c_str());
-        // Create a new spool in Spoolman from the rich OpenPrintTag metadata
-        if (!createSpoolFromOpenPrintTag(optData, uidString)) {
-          Serial.println("Note: Could not auto-create Spoolman spool from OpenPrintTag");
-          // Not a fatal error — tag data is still displayed in web UI
-        }
-      }
+      uint32_t fingerprint;
+      if (tagCacheFingerprintOf(encodedMessage, messageSize, fingerprint))
+        tagCacheStoreOpenPrintTag(currentTagUid, currentTagUidLength, fingerprint, result.json, optData);
+      processOpenPrintTag(optData, result.json, uidString);
     } else {
       Serial.printf("OpenPrintTag parse error: %s\n", optData.parseError.c_str());
       oledShowProgressBar(1, 1, "Failure", "Bad OpenPrintTag");
@@ -1243,91 +1031,43 @@ bool decodeNdefAndReturnJson(const byte* encodedMessage, String uidString) {
 
   nfcJsonData = "";
 
-  // Extract JSON payload with validation (OpenSpool / FilaMan JSON format)
-  uint32_t actualJsonLength = 0;
-  for (uint32_t i = 0; i < payloadLength; i++) {
-    byte currentByte = ndefRecord[payloadOffset + i];
-    
-    // Stop at null terminator or if we find the end of JSON
-    if (currentByte == 0x00) {
-      Serial.print("Found null terminator at position: ");
-      Serial.println(i);
-      break;
-    }
-    
-    // Only add printable characters and common JSON characters
-    if (currentByte >= 32 && currentByte <= 126) {
-      nfcJsonData += (char)currentByte;
-      actualJsonLength++;
-    } else {
-      Serial.print("Skipping non-printable byte at position ");
-      Serial.print(i);
-      Serial.print(": 0x");
-      Serial.println(currentByte, HEX);
-    }
-    
-    // Check if we've reached the end of a JSON object
-    if (currentByte == '}') {
-      // Count opening and closing braces to detect complete JSON
-      int braceCount = 0;
-      for (uint32_t j = 0; j <= i; j++) {
-        if (ndefRecord[payloadOffset + j] == '{') braceCount++;
-        else if (ndefRecord[payloadOffset + j] == '}') braceCount--;
-      }
-      
-      if (braceCount == 0) {
-        Serial.print("Found complete JSON object at position: ");
-        Serial.println(i);
-        actualJsonLength = i + 1;
-        break;
-      }
-    }
+  // JSON payload (OpenSpool / FilaMan format) or compact tag expanded to JSON
+  if (status == TAG_DECODE_BAD_COMPACT) {
+    Serial.println("Invalid compact tag payload");
+    return false;
   }
-
-  Serial.print("Actual JSON length extracted: ");
-  Serial.println(actualJsonLength);
-  Serial.print("Total nfcJsonData length: ");
-  Serial.println(nfcJsonData.length());
-  Serial.println("=== DECODED JSON DATA START ===");
-  Serial.println(nfcJsonData);
-  Serial.println("=== DECODED JSON DATA END ===");
-  
-  // Check if JSON was truncated
-  if (nfcJsonData.length() < payloadLength && !nfcJsonData.endsWith("}")) {
-    Serial.println("WARNING: JSON payload appears to be truncated!");
-    Serial.print("Expected payload length: ");
-    Serial.println(payloadLength);
-    Serial.print("Actual extracted length: ");
-    Serial.println(nfcJsonData.length());
+  if (result.truncated) {
+    Serial.printf("WARNING: JSON payload appears to be truncated! (%u bytes)\n", result.payloadLength);
   }
-  
-  // Trim any trailing whitespace or invalid characters
-  nfcJsonData.trim();
 
-  // Process JSON document
-  JsonDocument doc;
-  DeserializationError error = deserializeJson(doc, nfcJsonData);
-  if (error) 
+  JsonDocument& doc = result.doc;
+  Serial.printf("NDEF decode: %u byte payload in %lu us\n", result.payloadLength, (unsigned long)(micros() - decodeStart));
+  if (status == TAG_DECODE_BAD_JSON) 
   {
-    nfcJsonData = "";
     Serial.println("Error processing JSON document");
     Serial.print("deserializeJson() failed: ");
-    Serial.println(error.f_str());
+    Serial.println(result.jsonError.f_str());
     return false;
   } 
   else 
   {
+    nfcJsonData = std::move(result.json);
+
     // If spoolman is unavailable, there is no point in continuing
     if(spoolmanConnected){
       // Send updated AMS data to all WebSocket clients
       Serial.println("JSON document successfully processed");
-      Serial.println(doc.as<String>());
+      serializeJson(doc, Serial);
+      Serial.println();
       if (doc["sm_id"].is<String>() && doc["sm_id"] != "" && doc["sm_id"] != "0")
       {
         oledShowProgressBar(2, octoEnabled?5:4, "Spool Tag", "Weighing");
         Serial.println("SPOOL-ID found: " + doc["sm_id"].as<String>());
         activeSpoolId = doc["sm_id"].as<String>();
         lastSpoolId = activeSpoolId;
+        uint32_t fingerprint;
+        if (tagCacheFingerprintOf(encodedMessage, messageSize, fingerprint))
+          tagCacheStoreSpool(currentTagUid, currentTagUidLength, fingerprint, nfcJsonData, activeSpoolId);
       }
       else if(doc["location"].is<String>() && doc["location"] != "")
       {
@@ -1359,7 +1099,18 @@ bool decodeNdefAndReturnJson(const byte* encodedMessage, String uidString) {
         oledShowProgressBar(1, 1, "Failure", "Unkown tag");
       }
     }else{
-      oledShowProgressBar(octoEnabled?5:4, octoEnabled?5:4, "Failure!", "Spoolman unavailable");
+      // Known spools are still shown from the local mirror
+      SpoolMirrorEntry spool;
+      uint16_t spoolId = doc["sm_id"].is<String>() ? doc["sm_id"].as<String>().toInt() : 0;
+      if (spoolId != 0 && spoolMirrorFind(spoolId, spool)) {
+        Serial.printf("Spoolman offline, spool %u from mirror: %s %s\n", spoolId, spool.brand, spool.material);
+        oledShowProgressBar(1, 1, "Offline", (String(spool.brand) + " " + spool.material).c_str());
+        // The weight goes to the journal and is sent once Spoolman is back
+        activeSpoolId = doc["sm_id"].as<String>();
+        lastSpoolId = activeSpoolId;
+      } else {
+        oledShowProgressBar(octoEnabled?5:4, octoEnabled?5:4, "Failure!", "Spoolman unavailable");
+      }
     }
   }
 
@@ -1368,298 +1119,252 @@ bool decodeNdefAndReturnJson(const byte* encodedMessage, String uidString) {
   return true;
 }
 
-// Read complete JSON data for fast-path to enable web interface display
-bool readCompleteJsonForFastPath() {
-    Serial.println("=== FAST-PATH: Reading complete JSON for web interface ===");
-    
-    // Read tag size first
-    uint16_t tagSize = readTagSize();
-    if (tagSize == 0) {
-        Serial.println("FAST-PATH: Could not determine tag size");
+// Tag seen before: confirm it is unchanged with one 16-byte READ of pages 4-7
+// and replay the decoded result instead of reading and decoding the message
+static bool processCachedTag(const String& uidString) {
+    const TagCacheEntry* entry = tagCacheFind(currentTagUid, currentTagUidLength);
+    if (!entry) return false;
+
+    uint8_t firstBlock[NTAG_READ_BLOCK_PAGES * 4];
+    uint8_t identityBlock[NTAG_READ_BLOCK_PAGES * 4];
+    if (!ntagReadBlock(4, firstBlock)) {
         return false;
     }
-    
-    // Create buffer for complete data
-    uint8_t* data = (uint8_t*)malloc(tagSize);
-    if (!data) {
-        Serial.println("FAST-PATH: Could not allocate memory for complete read");
+    // The block holding sm_id must match too, an unreadable one is a miss
+    uint8_t identityPage = tagCacheIdentityPage(firstBlock);
+    if (identityPage != 0 && !ntagReadBlock(identityPage, identityBlock)) {
         return false;
     }
-    memset(data, 0, tagSize);
-    
-    // Read all pages
-    uint8_t numPages = tagSize / 4;
-    for (uint8_t i = 4; i < 4 + numPages; i++) {
-        if (!robustPageRead(i, data + (i - 4) * 4)) {
-            Serial.printf("FAST-PATH: Failed to read page %d\n", i);
-            free(data);
-            return false;
-        }
-        
-        // Check for NDEF message end
-        if (data[(i - 4) * 4] == 0xFE) {
-            Serial.println("FAST-PATH: Found NDEF message end marker");
-            break;
-        }
-        
-        yield();
-        esp_task_wdt_reset();
-        vTaskDelay(pdMS_TO_TICKS(2));
+    if (tagCacheFingerprint(firstBlock, identityPage != 0 ? identityBlock : nullptr) != entry->fingerprint) {
+        Serial.println("TAG-CACHE: tag content changed, reading again");
+        tagCacheInvalidate(currentTagUid, currentTagUidLength);
+        return false;
     }
-    
-    // Decode NDEF and extract JSON
-    bool success = decodeNdefAndReturnJson(data, ""); // Empty UID string for fast-path
-    
-    free(data);
-    
-    if (success) {
-        Serial.println("✓ FAST-PATH: Complete JSON data successfully loaded");
-        Serial.print("nfcJsonData length: ");
-        Serial.println(nfcJsonData.length());
-    } else {
-        Serial.println("✗ FAST-PATH: Failed to decode complete JSON data");
+
+    Serial.println("✓ TAG-CACHE: known tag, skipping read");
+    if (entry->openPrintTag) {
+        processOpenPrintTag(entry->optData, entry->json, uidString);
+        return true;
     }
-    
-    return success;
+
+    nfcJsonData = entry->json;
+    activeSpoolId = entry->spoolId;
+    lastSpoolId = activeSpoolId;
+    oledShowProgressBar(2, octoEnabled?5:4, "Known Spool", "Cached");
+    return true;
 }
 
-bool quickSpoolIdCheck(String uidString) {
-    // Fast-path: Read NDEF structure to quickly locate and check JSON payload
-    // This dramatically speeds up known spool recognition
-    
-    // CRITICAL: Do not execute during write operations!
-    if (nfcWriteInProgress) {
-        Serial.println("FAST-PATH: Skipped during write operation");
-        return false;
+// Hand a read spool to the main loop, which sends the weight once it is stable
+static void postActiveSpool() {
+    if (activeSpoolId == "") {
+        scanTraceAbort();
+        return;
     }
-    
-    Serial.println("=== FAST-PATH: Quick sm_id Check ===");
-    
-    // Read enough pages to cover NDEF header + beginning of payload (pages 4-8 = 20 bytes)
-    uint8_t ndefData[20];
-    memset(ndefData, 0, 20);
-    
-    for (uint8_t page = 4; page < 9; page++) {
-        if (!robustPageRead(page, ndefData + (page - 4) * 4)) {
-            Serial.print("FAST-PATH: Failed to read page ");
-            Serial.print(page);
-            Serial.println(" - falling back to full read");
-            return false; // Fall back to full read if any page read fails
-        }
+    scanTraceMark(SCAN_PHASE_READ);
+    scanTraceMark(SCAN_PHASE_DECODE);
+    postTagRead(activeSpoolId.toInt());
+}
+
+// ##### Streaming tag read #####
+// optimizeJsonForFastPath() writes sm_id as the first key and compact tags keep
+// it on page 7, so the start of the payload is read in 16-byte blocks until
+// sm_id shows up. Everything after that is read in full FAST_READ chunks.
+#define STREAM_READ_SMALL_CHUNK_BYTES  64
+
+struct StreamReadState {
+    const uint8_t* data;
+    bool compact;
+    bool smIdSeen;
+    bool knownSpool;
+    bool announced;
+    String spoolId;
+};
+
+static void streamReadEvent(const NdefStreamEvent& event, void* context) {
+    StreamReadState* state = (StreamReadState*)context;
+
+    switch (event.type) {
+        case NDEF_EVENT_RECORD:
+            Serial.printf("NDEF record: %s, %u bytes\n", event.recordType, event.payloadLength);
+            state->compact = strcmp(event.recordType, COMPACT_TAG_MIME_TYPE) == 0;
+            break;
+        case NDEF_EVENT_KEY_VALUE:
+            if (!state->smIdSeen && strcmp(event.key, "sm_id") == 0) {
+                state->smIdSeen = true;
+                state->spoolId = event.value;
+                state->knownSpool = !event.truncated && state->spoolId != "" && state->spoolId != "0";
+            }
+            break;
+        case NDEF_EVENT_ERROR:
+            Serial.printf("NDEF stream error: %s\n", event.error);
+            break;
+        default:
+            break;
     }
-    
-    // Parse NDEF structure to find JSON payload start
-    Serial.print("Raw NDEF data (first 20 bytes): ");
-    for (int i = 0; i < 20; i++) {
-        if (ndefData[i] < 0x10) Serial.print("0");
-        Serial.print(ndefData[i], HEX);
-        Serial.print(" ");
+}
+
+static uint8_t streamReadChunkPages(const NdefStreamDecoder& decoder, uint16_t bytesRead, void* context) {
+    StreamReadState* state = (StreamReadState*)context;
+
+    // Compact tags carry sm_id at a fixed payload offset
+    uint32_t compactSpoolId;
+    if (state->compact && !state->smIdSeen && decoder.hasPayload() &&
+        bytesRead >= decoder.payloadOffset() + COMPACT_TAG_HEADER_SIZE &&
+        compactTagSpoolId(state->data + decoder.payloadOffset(), COMPACT_TAG_HEADER_SIZE, compactSpoolId)) {
+        state->smIdSeen = true;
+        state->spoolId = String(compactSpoolId);
+        state->knownSpool = compactSpoolId != 0;
+    }
+
+    // Act on a known spool right away, the rest of the message is only
+    // needed for the web interface
+    if (state->knownSpool && !state->announced) {
+        state->announced = true;
+        Serial.println("✓ FAST-PATH: Known spool detected, sm_id " + state->spoolId);
+        activeSpoolId = state->spoolId;
+        lastSpoolId = activeSpoolId;
+        nfcReaderState = NFC_READ_SUCCESS;
+        postActiveSpool();
+        oledShowProgressBar(2, octoEnabled?5:4, "Known Spool", "Quick mode");
+    }
+
+    if (!state->smIdSeen && (!decoder.hasPayload() || decoder.payloadIsJson() || state->compact) &&
+        bytesRead < STREAM_READ_SMALL_CHUNK_BYTES) {
+        return NTAG_READ_BLOCK_PAGES;
+    }
+    return NTAG_FAST_READ_MAX_PAGES;
+}
+
+// Single pass over the tag: sm_id is acted on as soon as its pages are in,
+// the remaining pages land in the same buffer for the full decode.
+// quick is set for known spools, which are already posted by the time this
+// returns and skip the slower spool processing.
+static bool streamReadTag(const String& uidString, uint8_t* data, uint16_t dataSize, bool& quick) {
+    StreamReadState state = { data, false, false, false, false, "" };
+    NdefStreamDecoder decoder(streamReadEvent, &state);
+
+    quick = false;
+    // Bulk read of the NDEF message; decoding a partial read still
+    // reports a proper error further down
+    if (!readNdefStream(data, dataSize, decoder, streamReadChunkPages, &state)) {
+        Serial.println("Failed to read NDEF data after retries");
     }
-    Serial.println();
-    
-    // Look for NDEF TLV (0x03) at the beginning
-    int tlvOffset = -1;
-    for (int i = 0; i < 8; i++) {
-        if (ndefData[i] == 0x03) {
-            tlvOffset = i;
-            Serial.print("Found NDEF TLV at offset: ");
-            Serial.println(tlvOffset);
-            break;
+
+    if (state.knownSpool) {
+        // Fill nfcJsonData for the web interface from the pages already read
+        if (!decodeNdefAndReturnJson(data, dataSize, uidString)) {
+            Serial.println("⚠ FAST-PATH: Could not decode complete JSON, web interface may show limited data");
         }
+        activeSpoolId = state.spoolId;
+        lastSpoolId = activeSpoolId;
+        oledShowProgressBar(2, octoEnabled?5:4, "Known Spool", "Quick mode");
+        Serial.println("✓ FAST-PATH SUCCESS: Known spool processed quickly");
+        quick = true;
+        return true;
     }
-    
-    if (tlvOffset == -1) {
-        Serial.println("✗ FAST-PATH: No NDEF TLV found");
-        return false;
+
+    Serial.println("Tag reading completed, starting NDEF decode...");
+    return decodeNdefAndReturnJson(data, dataSize, uidString);
+}
+
+// ##### Spool and location tag pair #####
+static String uidToString(const uint8_t* uid, uint8_t uidLength) {
+    String uidString = "";
+    for (uint8_t i = 0; i < uidLength; i++) {
+        uidString += String(uid[i], HEX);
+        if (i < uidLength - 1) uidString += ":";
     }
-    
-    // Parse NDEF record to find JSON payload
-    int ndefRecordStart;
-    if (ndefData[tlvOffset + 1] == 0xFF) {
-        // Extended length format
-        ndefRecordStart = tlvOffset + 4;
+    return uidString;
+}
+
+static void selectDetectedTarget(uint8_t index) {
+    nfc.selectTarget(detectedTargets[index].tg);
+    setCurrentTag(detectedTargets[index].uid, detectedTargets[index].uidLength);
+}
+
+// sm_id and location of a JSON or compact tag, without acting on them
+static void readTagIdentity(const uint8_t* data, uint16_t size, String& spoolId, String& location) {
+    NdefRecordView record;
+    if (!parseNdefRecord(data, size, record)) return;
+
+    NfcTagFormat tagFormat = detectTagFormat(record.payload.data, record.payload.length,
+                                             record.type.length, record.type.data);
+    JsonDocument doc;
+    if (tagFormat == TAG_FORMAT_COMPACT) {
+        String json;
+        if (!compactTagDecode(record.payload.data, record.payload.length, json) || deserializeJson(doc, json)) return;
+    } else if (tagFormat == TAG_FORMAT_OPENSPOOL) {
+        bool complete;
+        ByteSpan json = jsonObjectSpan(record.payload, complete);
+        if (deserializeJson(doc, (const char*)json.data, json.length)) return;
     } else {
-        // Standard length format
-        ndefRecordStart = tlvOffset + 2;
-    }
-    
-    if (ndefRecordStart >= 20) {
-        Serial.println("✗ FAST-PATH: NDEF record starts beyond read data");
-        return false;
-    }
-    
-    // Parse NDEF record header
-    uint8_t recordHeader = ndefData[ndefRecordStart];
-    uint8_t typeLength = ndefData[ndefRecordStart + 1];
-    
-    // Calculate payload offset
-    uint8_t payloadLengthBytes = (recordHeader & 0x10) ? 1 : 4; // SR flag check
-    uint8_t idLength = (recordHeader & 0x08) ? ndefData[ndefRecordStart + 2 + payloadLengthBytes + typeLength] : 0; // IL flag check
-    
-    int payloadOffset = ndefRecordStart + 1 + 1 + payloadLengthBytes + typeLength + idLength;
-    
-    Serial.print("NDEF Record Header: 0x");
-    Serial.print(recordHeader, HEX);
-    Serial.print(", Type Length: ");
-    Serial.print(typeLength);
-    Serial.print(", Payload offset: ");
-    Serial.println(payloadOffset);
-    
-    // Check if payload starts within our read data
-    if (payloadOffset >= 20) {
-        Serial.println("✗ FAST-PATH: JSON payload starts beyond quick read data - need more pages");
-        
-        // Read additional pages to get to JSON payload
-        uint8_t extraData[16]; // Read 4 more pages
-        memset(extraData, 0, 16);
-        
-        for (uint8_t page = 9; page < 13; page++) {
-            if (!robustPageRead(page, extraData + (page - 9) * 4)) {
-                Serial.print("FAST-PATH: Failed to read additional page ");
-                Serial.print(page);
-                Serial.println(" - falling back to full read");
-                return false; // Fall back to full read if extended read fails
-            }
-        }
-        
-        // Combine data
-        uint8_t combinedData[36];
-        memcpy(combinedData, ndefData, 20);
-        memcpy(combinedData + 20, extraData, 16);
-        
-        // Extract JSON from combined data
-        String jsonStart = "";
-        int jsonStartPos = payloadOffset;
-        for (int i = 0; i < 36 - payloadOffset && i < 30; i++) {
-            uint8_t currentByte = combinedData[payloadOffset + i];
-            if (currentByte >= 32 && currentByte <= 126) {
-                jsonStart += (char)currentByte;
-            }
-            // Stop at first brace to get just the beginning
-            if (currentByte == '{' && i > 0) break;
-        }
-        
-        Serial.print("JSON start from extended read: ");
-        Serial.println(jsonStart);
-        
-        // Check for sm_id pattern - look for non-zero sm_id values
-        if (jsonStart.indexOf("\"sm_id\":\"") >= 0) {
-            int smIdStart = jsonStart.indexOf("\"sm_id\":\"") + 9;
-            int smIdEnd = jsonStart.indexOf("\"", smIdStart);
-            
-            if (smIdEnd > smIdStart && smIdEnd < jsonStart.length()) {
-                String quickSpoolId = jsonStart.substring(smIdStart, smIdEnd);
-                Serial.print("Found sm_id in extended read: ");
-                Serial.println(quickSpoolId);
-                
-                // Only process if sm_id is not "0" (known spool)
-                if (quickSpoolId != "0" && quickSpoolId.length() > 0) {
-                    Serial.println("✓ FAST-PATH: Known spool detected!");
-                    
-                    // Set as active spool immediately
-                    activeSpoolId = quickSpoolId;
-                    lastSpoolId = activeSpoolId;
-                    
-                    // Read complete JSON data for web interface display
-                    Serial.println("FAST-PATH: Reading complete JSON data for web interface...");
-                    if (readCompleteJsonForFastPath()) {
-                        Serial.println("✓ FAST-PATH: Complete JSON data loaded for web interface");
-                    } else {
-                        Serial.println("⚠ FAST-PATH: Could not read complete JSON, web interface may show limited data");
-                    }
-                    
-                    oledShowProgressBar(2, octoEnabled?5:4, "Known Spool", "Quick mode");
-                    Serial.println("✓ FAST-PATH SUCCESS: Known spool processed quickly");
-                    return true;
-                } else {
-                    Serial.println("✗ FAST-PATH: sm_id is 0 - new brand filament, need full read");
-                    return false;
-                }
-            }
-        }
-        
-        Serial.println("✗ FAST-PATH: No sm_id pattern in extended read");
-        return false;
+        return;
     }
-    
-    // Extract JSON payload from the available data
-    String quickJson = "";
-    for (int i = payloadOffset; i < 20 && i < payloadOffset + 15; i++) {
-        uint8_t currentByte = ndefData[i];
-        if (currentByte >= 32 && currentByte <= 126) {
-            quickJson += (char)currentByte;
+
+    spoolId = doc["sm_id"] | "";
+    location = doc["location"] | "";
+}
+
+// Both targets of a dual target detection are read. A spool tag next to a
+// location tag is processed like a spool and moved to the location with one
+// Spoolman update. Anything else leaves the first target selected and returns
+// false for the normal single tag path.
+static bool processTagPair() {
+    uint8_t* data[PN532_MAX_TARGETS] = { nullptr, nullptr };
+    uint16_t size[PN532_MAX_TARGETS] = { 0, 0 };
+    String spoolId[PN532_MAX_TARGETS];
+    String location[PN532_MAX_TARGETS];
+    int8_t spool = -1;
+    int8_t place = -1;
+
+    oledShowProgressBar(0, octoEnabled?5:4, "Reading", "Two tags");
+    for (uint8_t i = 0; i < PN532_MAX_TARGETS; i++) {
+        selectDetectedTarget(i);
+        size[i] = currentTagGeometry().userDataBytes;
+        if (detectedTargets[i].uidLength != 7 || size[i] == 0) continue;
+
+        data[i] = (uint8_t*)malloc(size[i]);
+        if (data[i] && readNdefArea(data[i], size[i])) {
+            readTagIdentity(data[i], size[i], spoolId[i], location[i]);
         }
+
+        if (spoolId[i] != "" && spoolId[i] != "0") spool = i;
+        else if (location[i] != "") place = i;
     }
-    
-    Serial.print("Quick JSON data: ");
-    Serial.println(quickJson);
-    
-    // Look for sm_id pattern in the beginning of JSON - check for known vs new spools
-    if (quickJson.indexOf("\"sm_id\":\"") >= 0) {
-        Serial.println("✓ FAST-PATH: sm_id field found");
-        
-        // Extract sm_id from quick data
-        int smIdStart = quickJson.indexOf("\"sm_id\":\"") + 9;
-        int smIdEnd = quickJson.indexOf("\"", smIdStart);
-        
-        if (smIdEnd > smIdStart && smIdEnd < quickJson.length()) {
-            String quickSpoolId = quickJson.substring(smIdStart, smIdEnd);
-            Serial.print("✓ Quick extracted sm_id: ");
-            Serial.println(quickSpoolId);
-            
-            // Only process known spools (sm_id != "0") via fast path
-            if (quickSpoolId != "0" && quickSpoolId.length() > 0) {
-                Serial.println("✓ FAST-PATH: Known spool detected!");
-                
-                // Set as active spool immediately
-                activeSpoolId = quickSpoolId;
-                lastSpoolId = activeSpoolId;
-                
-                // Read complete JSON data for web interface display
-                Serial.println("FAST-PATH: Reading complete JSON data for web interface...");
-                if (readCompleteJsonForFastPath()) {
-                    Serial.println("✓ FAST-PATH: Complete JSON data loaded for web interface");
-                } else {
-                    Serial.println("⚠ FAST-PATH: Could not read complete JSON, web interface may show limited data");
-                }
-                
-                oledShowProgressBar(2, octoEnabled?5:4, "Known Spool", "Quick mode");
-                Serial.println("✓ FAST-PATH SUCCESS: Known spool processed quickly");
-                return true;
-            } else {
-                Serial.println("✗ FAST-PATH: sm_id is 0 - new brand filament, need full read");
-                return false; // sm_id="0" means new brand filament, needs full processing
-            }
-        } else {
-            Serial.println("✗ FAST-PATH: Could not extract complete sm_id value");
-            return false; // Need full read to get complete sm_id
+
+    bool paired = false;
+    if (spool >= 0 && place >= 0) {
+        Serial.printf("✓ DUAL-TARGET: spool %s on location \"%s\"\n", spoolId[spool].c_str(), location[place].c_str());
+        selectDetectedTarget(spool);
+        String uidString = uidToString(detectedTargets[spool].uid, detectedTargets[spool].uidLength);
+        paired = decodeNdefAndReturnJson(data[spool], size[spool], uidString);
+        if (paired) {
+            updateSpoolLocation(spoolId[spool], location[place]);
         }
+    } else {
+        Serial.println("DUAL-TARGET: no spool and location tag pair, reading the first tag");
     }
-    
-    // Check for other patterns that require full read
-    if (quickJson.indexOf("\"location\":\"") >= 0) {
-        Serial.println("✓ FAST-PATH: Location tag detected");
-        return false; // Need full read for location processing
-    }
-    
-    if (quickJson.indexOf("\"brand\":\"") >= 0) {
-        Serial.println("✓ FAST-PATH: Brand filament detected - may need full processing");
-        return false; // Need full read for brand filament creation
-    }
-    
-    Serial.println("✗ FAST-PATH: No recognizable pattern - falling back to full read");
-    return false; // Fall back to full tag reading
+
+    if (!paired) selectDetectedTarget(0);
+    free(data[0]);
+    free(data[1]);
+    return paired;
 }
 
 void writeJsonToTag(void *parameter) {
   NfcWriteParameterType* params = (NfcWriteParameterType*)parameter;
 
   // Output the created NDEF message
-  Serial.println("Creating NDEF message...");
-  Serial.println(params->payload);
+  if (params->image != nullptr) {
+    Serial.printf("Writing prebuilt NDEF message (%d bytes)...\n", params->imageLen);
+  } else {
+    Serial.println("Creating NDEF message...");
+    Serial.println(params->payload);
+  }
 
   nfcReaderState = NFC_WRITING;
   nfcWriteInProgress = true; // Block high-level tag operations during write
+  releaseReaderFromIrqDetection();
 
   // Do NOT suspend the reading task - we need NFC interface for verification
   // Just use nfcWriteInProgress to prevent scanning and fast-path operations
@@ -1684,6 +1389,8 @@ void writeJsonToTag(void *parameter) {
     esp_task_wdt_reset();
     success = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 400);
     if (success) {
+      setCurrentTag(uid, uidLength);
+      tagCacheInvalidate(uid, uidLength);
       for (uint8_t i = 0; i < uidLength; i++) {
         //TBD: Rework to remove all the string operations
         uidString += String(uid[i], HEX);
@@ -1705,7 +1412,12 @@ void writeJsonToTag(void *parameter) {
     oledShowProgressBar(1, 3, "Write Tag", "Writing");
 
     // Write the NDEF message to the tag
-    success = ntag2xx_WriteNDEF(params->payload);
+    if (params->image != nullptr) {
+      NdefWriteStats stats;
+      success = ntagWriteTlvImage(params->image, params->imageLen, stats);
+    } else {
+      success = ntag2xx_WriteNDEF(params->payload);
+    }
     if (success) 
     {
         Serial.println("NDEF message successfully written to tag");
@@ -1717,34 +1429,16 @@ void writeJsonToTag(void *parameter) {
         pauseBambuMqttTask = false;
         
         if(params->tagType){
-          // TBD: should this be simplified?
-          if (updateSpoolTagId(uidString, params->payload) && params->tagType) {
-            // Check if weight is over 20g and send to Spoolman
-            if (weight > 20) {
-              Serial.println("Tag successfully written and weight > 20g - sending weight to Spoolman");
-              
-              // Extract spool ID from payload for weight update
-              JsonDocument payloadDoc;
-              DeserializationError error = deserializeJson(payloadDoc, params->payload);
-              
-              if (!error && payloadDoc["sm_id"].is<String>()) {
-                String spoolId = payloadDoc["sm_id"].as<String>();
-                if (spoolId != "") {
-                  Serial.printf("Updating spool %s with weight %dg\n", spoolId.c_str(), weight);
-                  updateSpoolWeight(spoolId, weight);
-                } else {
-                  Serial.println("No valid spool ID found for weight update");
-                }
-              } else {
-                Serial.println("Error parsing payload for spool ID extraction");
-              }
-              
-              payloadDoc.clear();
-            } else {
-              Serial.printf("Weight %dg is not above 20g threshold - skipping weight update\n", weight);
-            }
-          }else{
-            // Potentially handle errors
+          // The tag id update carries the current weight as its follow-up
+          // request, so the written spool needs no separate weight update
+          if (!updateSpoolTagId(uidString, params->payload, weight > 0 ? weight : 0)) {
+            Serial.println("Spoolman tag id update not sent");
+          }
+
+          JsonDocument payloadDoc;
+          if (!deserializeJson(payloadDoc, params->payload)) {
+            uint32_t spoolId = payloadDoc["sm_id"].as<String>().toInt();
+            if (spoolId != 0) postTagWritten(spoolId);
           }
         }else{
           oledShowProgressBar(1, 1, "Write Tag", "Done!");
@@ -1850,6 +1544,7 @@ void writeJsonToTag(void *parameter) {
   pauseBambuMqttTask = false;
 
   free(params->payload);
+  free(params->image);
   delete params;
 
   vTaskDelete(NULL);
@@ -1902,14 +1597,9 @@ String optimizeJsonForFastPath(const char* payload) {
     return optimizedJson;
 }
 
-void startWriteJsonToTag(const bool isSpoolTag, const char* payload) {
-  // Optimize JSON to ensure sm_id is first key for fast-path detection
-  String optimizedPayload = optimizeJsonForFastPath(payload);
-  
-  NfcWriteParameterType* parameters = new NfcWriteParameterType();
-  parameters->tagType = isSpoolTag;
-  parameters->payload = strdup(optimizedPayload.c_str()); // Use optimized payload
-  
+// Hands the write to the write task, which waits for the tag and writes it
+// off the caller's (usually the web server's) task
+static void startWriteTask(NfcWriteParameterType* parameters) {
   // Do not start task multiple times
   if (nfcReaderState == NFC_IDLE || nfcReaderState == NFC_READ_ERROR || nfcReaderState == NFC_READ_SUCCESS) {
     oledShowProgressBar(0, 1, "Write Tag", "Place tag now");
@@ -1924,10 +1614,26 @@ void startWriteJsonToTag(const bool isSpoolTag, const char* payload) {
     );
   }else{
     oledShowProgressBar(0, 1, "FAILURE", "NFC busy!");
-    // TBD: Add proper error handling (website)
+    sendWriteResult(nullptr, 0);
+    free(parameters->payload);
+    free(parameters->image);
+    delete parameters;
   }
 }
 
+void startWriteJsonToTag(const bool isSpoolTag, const char* payload) {
+  // Optimize JSON to ensure sm_id is first key for fast-path detection
+  String optimizedPayload = optimizeJsonForFastPath(payload);
+  
+  NfcWriteParameterType* parameters = new NfcWriteParameterType();
+  parameters->tagType = isSpoolTag;
+  parameters->payload = strdup(optimizedPayload.c_str()); // Use optimized payload
+  parameters->image = nullptr;
+  parameters->imageLen = 0;
+
+  startWriteTask(parameters);
+}
+
 // Write OpenPrintTag binary TLV format to NFC tag
 // jsonConfig is a JSON string with field values to encode
 void startWriteOpenPrintTagToTag(const char* jsonConfig) {
@@ -1983,53 +1689,258 @@ void startWriteOpenPrintTagToTag(const char* jsonConfig) {
 
   Serial.printf("OpenPrintTag NDEF message: %d bytes\n", ndefLen);
 
-  // Write the raw NDEF pages to tag (starting at page 4)
-  if (nfcReaderState == NFC_IDLE || nfcReaderState == NFC_READ_ERROR || nfcReaderState == NFC_READ_SUCCESS) {
-    nfcReaderState = NFC_WRITING;
-    nfcWriteInProgress = true;
-    oledShowProgressBar(0, 1, "Writing", "OpenPrintTag");
-
-    // Pad to 4-byte page boundary
-    uint16_t paddedLen = ((ndefLen + 3) / 4) * 4;
-    uint8_t* padded = (uint8_t*)malloc(paddedLen);
-    memset(padded, 0, paddedLen);
-    memcpy(padded, ndefMsg, ndefLen);
-
-    bool writeSuccess = true;
-    uint16_t numPages = paddedLen / 4;
-    for (uint16_t i = 0; i < numPages; i++) {
-      if (!nfc.ntag2xx_WritePage(4 + i, padded + i * 4)) {
-        Serial.printf("Failed to write page %d\n", 4 + i);
-        writeSuccess = false;
-        break;
+  // Same write task as JSON tags: capacity check, changed pages only and
+  // the configured verification
+  NfcWriteParameterType* parameters = new NfcWriteParameterType();
+  parameters->tagType = false;
+  parameters->payload = nullptr;
+  parameters->image = ndefMsg;
+  parameters->imageLen = ndefLen;
+
+  startWriteTask(parameters);
+}
+
+// ##### Batch programming #####
+// The batch task writes one payload per presented tag and hands the Spoolman
+// update to the update task, so the operator can swap tags while the PATCH
+// and weight requests run.
+#define NFC_BATCH_IDLE_TIMEOUT_MS   300000  // batch ends after 5 min without a tag
+#define NFC_BATCH_REMOVAL_MISSES    2       // polls without a tag before it counts as removed
+#define NFC_BATCH_UPDATE_QUEUE      8
+
+struct NfcBatchUpdate {
+  char uid[21];
+  char* payload;
+  uint16_t weight;
+};
+
+static char** batchPayloads = nullptr;
+static volatile bool batchCancelRequest = false;
+static QueueHandle_t batchUpdateQueue = NULL;
+static NfcBatchStatus batchStatus = {};
+// UIDs written in this batch, index = order written
+static uint8_t batchWrittenUids[NFC_BATCH_MAX_TAGS][7];
+
+void nfcBatchToJson(JsonObject batch) {
+  batch["active"] = batchStatus.active;
+  batch["total"] = batchStatus.total;
+  batch["written"] = batchStatus.written;
+  batch["failed"] = batchStatus.failed;
+  batch["pendingUpdates"] = batchStatus.written - batchStatus.updatesSent;
+  batch["nextSpoolId"] = batchStatus.nextSpoolId;
+
+  // Throughput between the first and the last tag written
+  float tagsPerMinute = 0.0f;
+  if (batchStatus.written > 1 && batchStatus.lastWriteMs > batchStatus.firstWriteMs) {
+    tagsPerMinute = (batchStatus.written - 1) * 60000.0f / (batchStatus.lastWriteMs - batchStatus.firstWriteMs);
+  }
+  batch["tagsPerMinute"] = serialized(String(tagsPerMinute, 1));
+}
+
+static void setBatchNextSpoolId() {
+  batchStatus.nextSpoolId[0] = '\0';
+  if (batchStatus.written >= batchStatus.total) return;
+
+  JsonDocument doc;
+  if (!deserializeJson(doc, batchPayloads[batchStatus.written])) {
+    strlcpy(batchStatus.nextSpoolId, doc["sm_id"] | "", sizeof(batchStatus.nextSpoolId));
+  }
+}
+
+static bool batchTagWritten(const uint8_t* uid) {
+  for (uint16_t i = 0; i < batchStatus.written; i++) {
+    if (memcmp(batchWrittenUids[i], uid, sizeof(batchWrittenUids[i])) == 0) return true;
+  }
+  return false;
+}
+
+static void batchUpdateDone(SpoolmanApiRequestType requestType, bool success, void* context) {
+  xTaskNotifyGive((TaskHandle_t)context);
+}
+
+// Sends the queued updates one at a time at low priority, so scans placed
+// on the scale meanwhile go to Spoolman first.
+static void nfcBatchUpdateTask(void *parameter) {
+  NfcBatchUpdate update = {};
+  while (xQueueReceive(batchUpdateQueue, &update, pdMS_TO_TICKS(1000)) == pdTRUE || batchStatus.active) {
+    if (update.payload == nullptr) continue;
+
+    if (updateSpoolTagId(update.uid, update.payload, update.weight, API_PRIORITY_LOW,
+                         batchUpdateDone, xTaskGetCurrentTaskHandle())) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else {
+      Serial.printf("Batch: Spoolman update for tag %s not sent\n", update.uid);
+    }
+
+    free(update.payload);
+    update.payload = nullptr;
+    batchStatus.updatesSent++;
+    sendNfcBatch(nullptr);
+  }
+
+  vQueueDelete(batchUpdateQueue);
+  batchUpdateQueue = NULL;
+  Serial.println("Batch: all Spoolman updates sent");
+  vTaskDelete(NULL);
+}
+
+static void nfcBatchTask(void *parameter) {
+  nfcReaderState = NFC_WRITING;
+  nfcWriteInProgress = true;
+  releaseReaderFromIrqDetection();
+  sendNfcData();
+
+  uint8_t lastUid[7] = { 0 };
+  uint8_t lastUidLength = 0;
+  uint8_t misses = 0;
+  unsigned long lastActivity = millis();
+
+  Serial.printf("Batch: writing %d tags\n", batchStatus.total);
+  while (!batchCancelRequest && batchStatus.written < batchStatus.total &&
+         millis() - lastActivity < NFC_BATCH_IDLE_TIMEOUT_MS) {
+    esp_task_wdt_reset();
+    yield();
+
+    uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
+    uint8_t uidLength;
+    if (!nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 200)) {
+      if (lastUidLength > 0 && ++misses >= NFC_BATCH_REMOVAL_MISSES) {
+        lastUidLength = 0;
+        oledShowProgressBar(batchStatus.written, batchStatus.total, "Batch", "Place next tag");
       }
-      yield();
-      esp_task_wdt_reset();
-      vTaskDelay(pdMS_TO_TICKS(5));
+      continue;
     }
+    misses = 0;
 
-    free(padded);
+    // The tag just handled is still on the reader
+    if (uidLength == lastUidLength && memcmp(uid, lastUid, uidLength) == 0) {
+      vTaskDelay(pdMS_TO_TICKS(50));
+      continue;
+    }
+    memcpy(lastUid, uid, uidLength);
+    lastUidLength = uidLength;
+    lastActivity = millis();
+
+    // A tag from this batch put back on the reader keeps its spool
+    if (batchTagWritten(uid)) {
+      Serial.printf("Batch: tag %s already written\n", uidToString(uid, uidLength).c_str());
+      oledShowProgressBar(batchStatus.written, batchStatus.total, "Batch", "Already written");
+      continue;
+    }
 
-    if (writeSuccess) {
-      Serial.println("OpenPrintTag write successful!");
-      nfcReaderState = NFC_WRITE_SUCCESS;
-      oledShowProgressBar(1, 1, "Success", "Tag written");
-      ws.textAll("{\"type\":\"writeNfcTag\",\"success\":1,\"format\":\"openprinttag\"}");
-    } else {
-      Serial.println("OpenPrintTag write failed!");
-      nfcReaderState = NFC_WRITE_ERROR;
-      oledShowProgressBar(1, 1, "Failure", "Write error");
-      ws.textAll("{\"type\":\"writeNfcTag\",\"success\":0,\"format\":\"openprinttag\"}");
+    setCurrentTag(uid, uidLength);
+    tagCacheInvalidate(uid, uidLength);
+    String uidString = uidToString(uid, uidLength);
+
+    const char* payload = batchPayloads[batchStatus.written];
+    oledShowProgressBar(batchStatus.written, batchStatus.total, "Batch", "Writing");
+    if (!ntag2xx_WriteNDEF(payload)) {
+      Serial.printf("Batch: writing tag %s failed, present a tag again\n", uidString.c_str());
+      batchStatus.failed++;
+      oledShowProgressBar(batchStatus.written, batchStatus.total, "Batch", "Failed, retry");
+      sendNfcBatch(nullptr);
+      continue;
     }
 
-    nfcWriteInProgress = false;
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
-    nfcReaderState = NFC_IDLE;
-  } else {
+    NfcBatchUpdate update;
+    strlcpy(update.uid, uidString.c_str(), sizeof(update.uid));
+    update.payload = strdup(payload);
+    update.weight = weight > 0 ? weight : 0;
+    // Queue full: the next write waits for Spoolman to catch up
+    xQueueSend(batchUpdateQueue, &update, portMAX_DELAY);
+
+    memcpy(batchWrittenUids[batchStatus.written], uid, sizeof(batchWrittenUids[0]));
+    batchStatus.lastWriteMs = millis();
+    if (batchStatus.written == 0) batchStatus.firstWriteMs = batchStatus.lastWriteMs;
+    batchStatus.written++;
+    setBatchNextSpoolId();
+    Serial.printf("Batch: tag %s written (%d/%d)\n", uidString.c_str(), batchStatus.written, batchStatus.total);
+    oledShowProgressBar(batchStatus.written, batchStatus.total, "Batch", "Remove tag");
+    sendNfcBatch(nullptr);
+  }
+
+  Serial.printf("Batch finished: %d/%d written, %d failed attempts\n",
+                batchStatus.written, batchStatus.total, batchStatus.failed);
+  oledShowProgressBar(1, 1, "Batch", (String(batchStatus.written) + "/" + String(batchStatus.total) + " written").c_str());
+
+  for (uint16_t i = 0; i < batchStatus.total; i++) {
+    free(batchPayloads[i]);
+  }
+  free(batchPayloads);
+  batchPayloads = nullptr;
+
+  batchStatus.active = false;
+  batchStatus.nextSpoolId[0] = '\0';
+  sendNfcBatch(nullptr);
+
+  nfcReaderState = NFC_IDLE;
+  nfcWriteInProgress = false;
+  pauseBambuMqttTask = false;
+  sendNfcData();
+
+  vTaskDelete(NULL);
+}
+
+bool startNfcBatch(JsonArrayConst payloads) {
+  if (batchStatus.active || batchUpdateQueue != NULL) {
+    Serial.println("Batch: already running");
+    return false;
+  }
+  if (payloads.size() == 0 || payloads.size() > NFC_BATCH_MAX_TAGS) {
+    Serial.println("Batch: invalid number of tags");
+    return false;
+  }
+  if (!(nfcReaderState == NFC_IDLE || nfcReaderState == NFC_READ_ERROR || nfcReaderState == NFC_READ_SUCCESS)) {
     oledShowProgressBar(0, 1, "FAILURE", "NFC busy!");
+    return false;
+  }
+
+  batchPayloads = (char**)calloc(payloads.size(), sizeof(char*));
+  if (batchPayloads == nullptr) return false;
+
+  uint16_t count = 0;
+  for (JsonVariantConst payload : payloads) {
+    String payloadString;
+    serializeJson(payload, payloadString);
+    // sm_id first for the fast path, as in single writes
+    batchPayloads[count] = strdup(optimizeJsonForFastPath(payloadString.c_str()).c_str());
+    if (batchPayloads[count] == nullptr) {
+      Serial.println("Batch: not enough memory for the payloads");
+      for (uint16_t i = 0; i < count; i++) free(batchPayloads[i]);
+      free(batchPayloads);
+      batchPayloads = nullptr;
+      return false;
+    }
+    count++;
+  }
+
+  batchStatus = {};
+  batchStatus.active = true;
+  batchStatus.total = count;
+  setBatchNextSpoolId();
+  batchCancelRequest = false;
+
+  batchUpdateQueue = xQueueCreate(NFC_BATCH_UPDATE_QUEUE, sizeof(NfcBatchUpdate));
+  if (batchUpdateQueue == NULL) {
+    for (uint16_t i = 0; i < count; i++) free(batchPayloads[i]);
+    free(batchPayloads);
+    batchPayloads = nullptr;
+    batchStatus.active = false;
+    return false;
   }
+  xTaskCreate(nfcBatchUpdateTask, "NfcBatchUpdateTask", 4096, NULL, 0, NULL);
+  xTaskCreate(nfcBatchTask, "NfcBatchTask", 6144, NULL, rfidWriteTaskPrio, NULL);
 
-  free(ndefMsg);
+  oledShowProgressBar(0, count, "Batch", "Place first tag");
+  sendNfcBatch(nullptr);
+  return true;
+}
+
+void cancelNfcBatch() {
+  if (batchStatus.active) {
+    Serial.println("Batch: cancel requested");
+    batchCancelRequest = true;
+  }
 }
 
 // Safe tag detection with manual retry logic and short timeouts
@@ -2043,7 +1954,9 @@ bool safeTagDetection(uint8_t* uid, uint8_t* uidLength) {
         yield();
         
         // Use short timeout to avoid blocking
-        bool success = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, uidLength, SHORT_TIMEOUT);
+        bool success = takeDetectedTargets(nfc.readPassiveTargets(PN532_MIFARE_ISO14443A, detectedTargets,
+                                                                  detectionMaxTargets(), SHORT_TIMEOUT),
+                                           uid, uidLength);
         
         if (success) {
             Serial.printf("✓ Tag detected on attempt %d with %dms timeout\n", attempt + 1, SHORT_TIMEOUT);
@@ -2063,6 +1976,272 @@ bool safeTagDetection(uint8_t* uid, uint8_t* uidLength) {
     return false;
 }
 
+// ##### Bay readers #####
+// Additional PN532s on the primary's SPI bus, each selected by its own SS
+// line. The RFID task polls them round-robin whenever it would otherwise
+// sleep: every bay gets one short detection, and for a new tag only the pages
+// up to sm_id are read. A round stops after NFC_BAY_ROUND_BUDGET_MS and the
+// next one continues with the bay that was skipped.
+#define NFC_BAY_DETECT_TIMEOUT_MS   30
+#define NFC_BAY_ROUND_BUDGET_MS     150
+#define NFC_BAY_ROUND_INTERVAL_MS   20
+#define NFC_BAY_MISSES_TO_REMOVE    2
+
+static uint8_t nextBay = 0;
+
+// Routes nfc to the bay reader for the lifetime of the scope, so the NTAG
+// helpers work unchanged. Only the RFID task is affected.
+struct BayReaderScope {
+    uint8_t savedUid[7];
+    uint8_t savedUidLength;
+
+    BayReaderScope(NfcBay& bay) {
+        memcpy(savedUid, currentTagUid, sizeof(savedUid));
+        savedUidLength = currentTagUidLength;
+        pBayNfc = bay.reader;
+    }
+    ~BayReaderScope() {
+        pBayNfc = nullptr;
+        setCurrentTag(savedUid, savedUidLength);
+    }
+};
+
+static const char* bayStateToString(nfcReaderStateType state) {
+    switch (state) {
+        case NFC_READING:      return "reading";
+        case NFC_READ_SUCCESS: return "spool";
+        case NFC_READ_ERROR:   return "error";
+        default:               return "idle";
+    }
+}
+
+void nfcBaysToJson(JsonArray bays) {
+    for (uint8_t i = 0; i < nfcBayCount; i++) {
+        const NfcBay& bay = nfcBays[i];
+        JsonObject entry = bays.add<JsonObject>();
+        entry["ss"] = bay.ss;
+        entry["location"] = bay.location;
+        entry["online"] = bay.reader != nullptr;
+        entry["state"] = bayStateToString(bay.state);
+        entry["spoolId"] = bay.activeSpoolId;
+        entry["readMs"] = bay.lastReadMs;
+    }
+}
+
+// Parse and validate a bay list, SS lines must be free GPIOs
+static bool parseNfcBays(JsonArrayConst bays, NfcBay* parsed, uint8_t& count) {
+    if (bays.size() > NFC_MAX_BAYS) return false;
+
+    count = 0;
+    for (JsonObjectConst entry : bays) {
+        if (!entry["ss"].is<uint8_t>()) return false;
+        uint8_t ss = entry["ss"].as<uint8_t>();
+        if (ss > 48 || ss == pn532Pins.sck || ss == pn532Pins.miso || ss == pn532Pins.mosi ||
+            ss == pn532Pins.ss || ss == pn532Pins.irq || ss == pn532Pins.reset) {
+            return false;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            if (parsed[i].ss == ss) return false;
+        }
+
+        NfcBay& bay = parsed[count++];
+        bay = NfcBay();
+        bay.ss = ss;
+        bay.location = entry["location"] | "";
+        bay.state = NFC_IDLE;
+    }
+    return true;
+}
+
+void loadNfcBays() {
+    for (uint8_t i = 0; i < nfcBayCount; i++) {
+        delete nfcBays[i].reader;
+        nfcBays[i].reader = nullptr;
+    }
+
+    Preferences preferences;
+    preferences.begin(NVS_NAMESPACE_NFC, true);
+    String stored = preferences.getString(NVS_KEY_NFC_BAYS, "[]");
+    preferences.end();
+
+    JsonDocument doc;
+    if (deserializeJson(doc, stored) || !parseNfcBays(doc.as<JsonArrayConst>(), nfcBays, nfcBayCount)) {
+        Serial.println("⚠ Invalid bay reader config in NVS, ignoring it");
+        nfcBayCount = 0;
+    }
+    Serial.printf("NFC bay readers: %u\n", nfcBayCount);
+}
+
+bool setNfcBays(const String& json) {
+    JsonDocument doc;
+    NfcBay parsed[NFC_MAX_BAYS];
+    uint8_t count;
+    if (deserializeJson(doc, json) || !doc.is<JsonArray>() ||
+        !parseNfcBays(doc.as<JsonArrayConst>(), parsed, count)) {
+        return false;
+    }
+
+    // Store the normalised list, readers are created on the next start
+    JsonDocument normalised;
+    JsonArray bays = normalised.to<JsonArray>();
+    for (uint8_t i = 0; i < count; i++) {
+        JsonObject entry = bays.add<JsonObject>();
+        entry["ss"] = parsed[i].ss;
+        entry["location"] = parsed[i].location;
+    }
+    String value;
+    serializeJson(normalised, value);
+
+    Preferences preferences;
+    preferences.begin(NVS_NAMESPACE_NFC, false);
+    preferences.putString(NVS_KEY_NFC_BAYS, value);
+    preferences.end();
+    Serial.println("NFC bay readers saved: " + value);
+    return true;
+}
+
+static void startBayReaders() {
+    for (uint8_t i = 0; i < nfcBayCount; i++) {
+        NfcBay& bay = nfcBays[i];
+#ifdef ENABLE_PN532_SIMULATOR
+        Serial.printf("⚠ Bay %u: not available with the simulator\n", bay.ss);
+        continue;
+#endif
+        if (pn532Pins.bus != PN532_BUS_SOFT_SPI && pn532Pins.bus != PN532_BUS_SPI) {
+            Serial.printf("⚠ Bay %u: bay readers need an SPI bus, %s is not supported\n",
+                          bay.ss, pn532BusToString(pn532Pins.bus));
+            continue;
+        }
+
+        // Same bus and clock as the primary reader, only the SS line differs
+        Pn532Pins bayPins = pn532Pins;
+        bayPins.ss = bay.ss;
+        Pn532* reader = new Pn532(createPn532Transport(bayPins));
+        reader->begin();
+        if (!reader->getFirmwareVersion()) {
+            Serial.printf("❌ Bay %u: no PN532 found\n", bay.ss);
+            delete reader;
+            continue;
+        }
+        reader->SAMConfig();
+        // A few activation retries instead of the default endless loop, so
+        // an empty bay answers within its detection budget
+        reader->setPassiveActivationRetries(0x02);
+        bay.reader = reader;
+        Serial.printf("✓ Bay %u: PN532 ready, location \"%s\"\n", bay.ss, bay.location.c_str());
+    }
+}
+
+// Bays only need sm_id, stop reading once it is known
+static uint8_t bayReadChunkPages(const NdefStreamDecoder& decoder, uint16_t bytesRead, void* context) {
+    uint8_t pages = streamReadChunkPages(decoder, bytesRead, context);
+    return ((StreamReadState*)context)->smIdSeen ? 0 : pages;
+}
+
+static bool readBaySpoolId(NfcBay& bay) {
+    uint16_t tagSize = currentTagGeometry().userDataBytes;
+    if (bay.uidLength != 7 || tagSize == 0) return false;
+
+    uint8_t* data = (uint8_t*)malloc(tagSize);
+    if (data == nullptr) return false;
+
+    // announced is preset so the primary's activeSpoolId and display stay untouched
+    StreamReadState state = { data, false, false, false, true, "" };
+    NdefStreamDecoder decoder(streamReadEvent, &state);
+    readNdefStream(data, tagSize, decoder, bayReadChunkPages, &state);
+    free(data);
+
+    if (!state.knownSpool) return false;
+    bay.activeSpoolId = state.spoolId;
+    return true;
+}
+
+static void pollBay(NfcBay& bay) {
+    BayReaderScope scope(bay);
+
+    uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
+    uint8_t uidLength = 0;
+    bool present = bay.reader->readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, NFC_BAY_DETECT_TIMEOUT_MS);
+
+    if (!present) {
+        if (bay.state != NFC_IDLE && ++bay.misses >= NFC_BAY_MISSES_TO_REMOVE) {
+            Serial.printf("Bay %u: tag removed\n", bay.ss);
+            bay.state = NFC_IDLE;
+            bay.activeSpoolId = "";
+            bay.uidLength = 0;
+            sendNfcBays(nullptr);
+        }
+        return;
+    }
+
+    bay.misses = 0;
+    // Same tag as before, nothing to do
+    if (bay.state != NFC_IDLE && uidLength == bay.uidLength && memcmp(uid, bay.uid, uidLength) == 0) {
+        return;
+    }
+
+    bay.uidLength = min(uidLength, (uint8_t)sizeof(bay.uid));
+    memcpy(bay.uid, uid, bay.uidLength);
+    setCurrentTag(uid, uidLength);
+    bay.state = NFC_READING;
+
+    unsigned long startTime = millis();
+    if (readBaySpoolId(bay)) {
+        bay.state = NFC_READ_SUCCESS;
+        bay.lastReadMs = millis() - startTime;
+        Serial.printf("✓ Bay %u: spool %s in %lu ms\n", bay.ss, bay.activeSpoolId.c_str(), bay.lastReadMs);
+        if (bay.location.length() > 0) {
+            updateSpoolLocation(bay.activeSpoolId, bay.location);
+        }
+    } else {
+        bay.state = NFC_READ_ERROR;
+        bay.activeSpoolId = "";
+        Serial.printf("❌ Bay %u: no spool tag\n", bay.ss);
+    }
+    sendNfcBays(nullptr);
+}
+
+// One round-robin pass over the bay readers, bounded by NFC_BAY_ROUND_BUDGET_MS
+static void pollBayReaders() {
+    unsigned long startTime = millis();
+
+    for (uint8_t polled = 0; polled < nfcBayCount; polled++) {
+        if (nfcWriteInProgress || nfcReadingTaskSuspendRequest) return;
+        if (polled > 0 && millis() - startTime >= NFC_BAY_ROUND_BUDGET_MS) return;
+
+        NfcBay& bay = nfcBays[nextBay];
+        nextBay = (nextBay + 1) % nfcBayCount;
+        if (bay.reader == nullptr) continue;
+
+        esp_task_wdt_reset();
+        pollBay(bay);
+    }
+}
+
+// Idle time of the RFID task, spent on the bay readers when there are any
+static void scanDelay(uint32_t ms) {
+    if (nfcBayCount == 0) {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+        return;
+    }
+
+    unsigned long startTime = millis();
+    do {
+        pollBayReaders();
+        vTaskDelay(pdMS_TO_TICKS(NFC_BAY_ROUND_INTERVAL_MS));
+    } while (millis() - startTime < ms && !nfcWriteInProgress && !nfcReadingTaskSuspendRequest);
+}
+
+// ##### PN532 self-test #####
+// Runs on the RFID task between scans so it never interleaves with tag traffic
+static volatile bool pn532SelfTestRequested = false;
+Pn532SelfTestResult lastPn532SelfTest = {};
+
+void requestPn532SelfTest() {
+    pn532SelfTestRequested = true;
+    if (pn532IrqSemaphore != NULL) xSemaphoreGive(pn532IrqSemaphore);
+}
+
 void scanRfidTask(void * parameter) {
   Serial.println("RFID task started");
   for(;;) {
@@ -2076,12 +2255,23 @@ void scanRfidTask(void * parameter) {
       nfcReadingTaskSuspendState = false;
       yield();
 
+      if (pn532SelfTestRequested) {
+        pn532SelfTestRequested = false;
+        cancelIrqDetection();
+        nfc.runSelfTest(lastPn532SelfTest);
+      }
+
       uint8_t success;
       uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };  // Buffer to store the returned UID
       uint8_t uidLength;
 
-      // Use safe tag detection instead of blocking readPassiveTargetID
-      success = safeTagDetection(uid, &uidLength);
+      // Waiting for a new tag: sleep on the IRQ line if enabled, otherwise poll
+      if (pn532IrqSemaphore != NULL && nfcReaderState == NFC_IDLE) {
+        success = irqTagDetection(uid, &uidLength);
+      } else {
+        // Use safe tag detection instead of blocking readPassiveTargetID
+        success = safeTagDetection(uid, &uidLength);
+      }
 
       foundNfcTag(nullptr, success);
       
@@ -2093,8 +2283,8 @@ void scanRfidTask(void * parameter) {
       // As long as there is still a tag on the reader, do not try to read it again
       if (success && nfcReaderState == NFC_IDLE)
       {
-        // Set the current tag as not processed
-        tagProcessed = false;
+        setCurrentTag(uid, uidLength);
+        scanTraceBegin();
 
         // Display some basic information about the card
         Serial.println("Found an ISO14443A card");
@@ -2106,6 +2296,7 @@ void scanRfidTask(void * parameter) {
         // Reduced stabilization time for better responsiveness
         Serial.println("Tag detected, minimal stabilization...");
         vTaskDelay(200 / portTICK_PERIOD_MS); // Reduced from 1000ms to 200ms
+        scanTraceMark(SCAN_PHASE_STABILIZE);
 
         // create Tag UID string
         String uidString = "";
@@ -2117,74 +2308,64 @@ void scanRfidTask(void * parameter) {
           }
         }
         
+        // Spool and location tag placed together
+        if (detectedTargetCount > 1 && processTagPair()) {
+          pauseBambuMqttTask = false;
+          nfcReaderState = NFC_READ_SUCCESS;
+          postActiveSpool();
+          scanDelay(500);
+          continue;
+        }
+
         if (uidLength == 7)
         {
-          // Try fast-path detection first for known spools
-          if (quickSpoolIdCheck(uidString)) {
-              Serial.println("✓ FAST-PATH: Tag processed quickly, skipping full read");
+          // Spool that was just scanned and put back
+          if (processCachedTag(uidString)) {
               pauseBambuMqttTask = false;
-              // Set reader back to idle for next scan
               nfcReaderState = NFC_READ_SUCCESS;
-              delay(500); // Small delay before next scan
-              continue; // Skip full tag reading and continue scan loop
+              postActiveSpool();
+              scanDelay(500);
+              continue;
           }
 
-          Serial.println("Continuing with full tag read after fast-path check");
-
-          uint16_t tagSize = readTagSize();
+          uint16_t tagSize = currentTagGeometry().userDataBytes;
           if(tagSize > 0)
           {
             // Create a buffer depending on the size of the tag
             uint8_t* data = (uint8_t*)malloc(tagSize);
-            memset(data, 0, tagSize);
 
             // We probably have an NTAG2xx card (though it could be Ultralight as well)
             Serial.println("Seems to be an NTAG2xx tag (7 byte UID)");
             Serial.print("Tag size: ");
             Serial.print(tagSize);
             Serial.println(" bytes");
-            
-            uint8_t numPages = readTagSize()/4;
-            
-            for (uint8_t i = 4; i < 4+numPages; i++) {
-              
-              if (!robustPageRead(i, data+(i-4) * 4))
-              {
-                Serial.printf("Failed to read page %d after retries, stopping\n", i);
-                break; // Stop if reading fails after retries
-              }
-             
-              // Check for NDEF message end
-              if (data[(i - 4) * 4] == 0xFE) 
-              {
-                Serial.println("Found NDEF message end marker");
-                break; // End of NDEF message
-              }
-
-              yield();
-              esp_task_wdt_reset();
-              // Reduced delay for faster reading
-              vTaskDelay(pdMS_TO_TICKS(2)); // Reduced from 5ms to 2ms
-            }
-            
-            Serial.println("Tag reading completed, starting NDEF decode...");
-            
-            if (!decodeNdefAndReturnJson(data, uidString)) 
+
+            bool quick = false;
+            if (!streamReadTag(uidString, data, tagSize, quick)) 
             {
               oledShowProgressBar(1, 1, "Failure", "Unknown tag");
               nfcReaderState = NFC_READ_ERROR;
+              scanTraceAbort();
             }
-            else 
+            else if (!quick)
             {
               nfcReaderState = NFC_READ_SUCCESS;
+              postActiveSpool();
             }
 
             free(data);
+
+            if (quick) {
+              pauseBambuMqttTask = false;
+              scanDelay(500); // Small delay before next scan
+              continue;
+            }
           }
           else
           {
             oledShowProgressBar(1, 1, "Failure", "Tag read error");
             nfcReaderState = NFC_READ_ERROR;
+            scanTraceAbort();
             // Reset activeSpoolId when tag reading fails to prevent autoSet
             activeSpoolId = "";
             Serial.println("Tag read failed - activeSpoolId reset to prevent autoSet");
@@ -2195,6 +2376,7 @@ void scanRfidTask(void * parameter) {
           //TBD: Show error here?!
           oledShowProgressBar(1, 1, "Failure", "Unkown tag type");
           Serial.println("This doesn't seem to be an NTAG2xx tag (UUID length != 7 bytes)!");
+          scanTraceAbort();
           // Reset activeSpoolId when tag type is unknown to prevent autoSet
           activeSpoolId = "";
           Serial.println("Unknown tag type - activeSpoolId reset to prevent autoSet");
@@ -2207,6 +2389,8 @@ void scanRfidTask(void * parameter) {
         //uidString = "";
         nfcJsonData = "";
         activeSpoolId = "";
+        scanTraceAbort();
+        postTagRemoved();
         Serial.println("Tag removed");
         if (!bambuCredentials.autosend_enable) oledShowWeight(weight);
       }
@@ -2220,10 +2404,12 @@ void scanRfidTask(void * parameter) {
       // Add a pause after successful reading to prevent immediate re-reading
       if (nfcReaderState == NFC_READ_SUCCESS) {
         Serial.println("Tag successfully read - waiting 3 seconds before next scan");
-        vTaskDelay(3000 / portTICK_PERIOD_MS); // Reduced from 5 seconds to 3 seconds
-      } else {
+        scanDelay(3000); // Reduced from 5 seconds to 3 seconds
+      } else if (!irqDetectionPending) {
         // Faster scanning when no tag or idle state
-        vTaskDelay(150 / portTICK_PERIOD_MS); // Faster scan interval
+        scanDelay(150); // Faster scan interval
+      } else if (nfcBayCount > 0) {
+        pollBayReaders();
       }
 
       // Update the website when status changes
@@ -2231,6 +2417,7 @@ void scanRfidTask(void * parameter) {
     }
     else
     {
+      cancelIrqDetection();
       nfcReadingTaskSuspendState = true;
       
       // Different behavior for write protection vs. full suspension
@@ -2257,10 +2444,15 @@ void startNfc() {
     RfidReaderTask = NULL;
   }
 
-  // Allocate PN532 in software-SPI mode using the configured pins
+  loadNfcWritePolicy();
+  loadNfcTagEncoding();
+  loadNfcDualTarget();
+  loadNfcBays();
+
+  // Allocate PN532 on the configured bus and pins
   if (pNfc) { delete pNfc; pNfc = nullptr; }
-  pNfc = new Adafruit_PN532(pn532Pins.sck, pn532Pins.miso,
-                             pn532Pins.mosi, pn532Pins.ss);
+  pNfc = new Pn532(createPn532Transport(pn532Pins));
+  Serial.printf("PN532 transport: %s (%u)\n", nfc.transport().name(), nfc.transport().clock());
 
   nfc.begin();                                           // Start communication with RFID reader
   delay(1000);
@@ -2276,6 +2468,8 @@ void startNfc() {
     Serial.print('.'); Serial.println((versiondata >> 8) & 0xFF, DEC);                  // 
 
     nfc.SAMConfig();
+    setupIrqDetection();
+    startBayReaders();
     // Set the max number of retry attempts to read from a card
     // This prevents us from waiting forever for a card, which is
     // the default behaviour of the PN532.
@@ -2,6 +2,8 @@
 #define NFC_H
 
 #include <Arduino.h>
+#include <ArduinoJson.h>
+#include "pn532.h"
 
 typedef enum{
     NFC_IDLE,
@@ -13,12 +15,90 @@ typedef enum{
     NFC_WRITE_ERROR
 } nfcReaderStateType;
 
+// Verification applied by the NDEF writer, stored in NVS
+typedef enum{
+    NFC_VERIFY_NONE,            // trust the write ACKs
+    NFC_VERIFY_FINAL_CHECKSUM,  // one bulk read-back of the written range
+    NFC_VERIFY_PER_PAGE,        // read back every page right after writing it
+    NFC_VERIFY_PARANOID         // per-page + final + pre/post write checks
+} nfcWritePolicyType;
+
+// Payload encoding of spool and location tags, stored in NVS
+typedef enum{
+    NFC_TAG_ENCODING_JSON,      // application/json, compact when JSON does not fit
+    NFC_TAG_ENCODING_COMPACT    // "fm/s" key-dictionary format, see compacttag.h
+} nfcTagEncodingType;
+
+// Additional reader on the primary's SPI bus with its own SS line, e.g. one
+// per dryer bay. Bays only track which spool sits on them and move it to
+// their Spoolman location.
+#define NFC_MAX_BAYS 6
+
+struct NfcBay {
+    Pn532* reader;
+    uint8_t ss;
+    String location;            // Spoolman location, empty = no location update
+    nfcReaderStateType state;
+    String activeSpoolId;
+    uint8_t uid[7];
+    uint8_t uidLength;
+    uint8_t misses;             // polls without a tag since it was seen
+    unsigned long lastReadMs;   // detection to sm_id of the last tag
+};
+
+// Batch programming: spool tags are written back to back as they are
+// presented, their Spoolman nfc_id/weight updates run in the background.
+#define NFC_BATCH_MAX_TAGS 100
+
+struct NfcBatchStatus {
+    bool active;
+    uint16_t total;
+    uint16_t written;
+    uint16_t failed;            // write attempts that failed, the spool is retried on the next tag
+    uint16_t updatesSent;       // Spoolman updates done, the rest is queued
+    char nextSpoolId[12];       // sm_id of the spool waiting for a tag
+    unsigned long firstWriteMs;
+    unsigned long lastWriteMs;
+};
+
+struct NdefWriteStats {
+    nfcWritePolicyType policy;
+    uint16_t pagesSkipped;
+    uint16_t pagesWritten;
+    uint16_t pagesVerified;
+    unsigned long preCheckMs;
+    unsigned long readMs;
+    unsigned long writeMs;
+    unsigned long verifyMs;
+    unsigned long postCheckMs;
+    unsigned long durationMs;
+};
+
 void startNfc();
 void scanRfidTask(void * parameter);
 void startWriteJsonToTag(const bool isSpoolTag, const char* payload);
 void startWriteOpenPrintTagToTag(const char* jsonConfig);
-bool quickSpoolIdCheck(String uidString);
-bool readCompleteJsonForFastPath(); // Read complete JSON data for fast-path web interface display
+bool startNfcBatch(JsonArrayConst payloads); // JSON spool payloads, written in order
+void cancelNfcBatch();
+void nfcBatchToJson(JsonObject batch);
+bool ntagReadPages(uint8_t startPage, uint8_t pageCount, uint8_t* buffer); // Bulk READ/FAST_READ with page-read fallback
+bool readNdefArea(uint8_t* data, uint16_t dataSize);
+bool ntagTransceive(uint8_t* cmd, uint8_t cmdLength, uint8_t* response, uint8_t* responseLength);
+bool reselectTag();
+uint8_t* buildNdefTlvImage(const char* mimeType, const uint8_t* payload, uint16_t payloadLen, uint16_t& imageLen);
+bool ntagWriteTlvImage(const uint8_t* image, uint16_t imageLen, NdefWriteStats& stats); // Writes only changed pages, header last
+void loadNfcWritePolicy();
+bool setNfcWritePolicy(const String& name);
+const char* nfcWritePolicyToString(nfcWritePolicyType policy);
+void loadNfcTagEncoding();
+bool setNfcTagEncoding(const String& name);
+const char* nfcTagEncodingToString(nfcTagEncodingType encoding);
+void requestPn532SelfTest(); // Runs on the RFID task, result in lastPn532SelfTest
+void loadNfcDualTarget();
+void setNfcDualTarget(bool enabled);
+void loadNfcBays();
+bool setNfcBays(const String& json); // JSON array of {ss, location}, applied after reboot
+void nfcBaysToJson(JsonArray bays);
 
 extern TaskHandle_t RfidReaderTask;
 extern String nfcJsonData;
@@ -27,7 +107,14 @@ extern String lastSpoolId;
 extern volatile nfcReaderStateType nfcReaderState;
 extern volatile bool pauseBambuMqttTask;
 extern volatile bool nfcWriteInProgress;
-extern bool tagProcessed;
+extern unsigned long lastTagReadTimeMs;
+extern nfcWritePolicyType nfcWritePolicy;
+extern nfcTagEncodingType nfcTagEncoding;
+extern bool nfcDualTarget;
+extern NdefWriteStats lastNdefWriteStats;
+extern Pn532SelfTestResult lastPn532SelfTest;
+extern NfcBay nfcBays[NFC_MAX_BAYS];
+extern uint8_t nfcBayCount;
 
 
 
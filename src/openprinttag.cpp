@@ -1,4 +1,5 @@
 #include "openprinttag.h"
+#include "compacttag.h"
 
 // ============================================================================
 // OpenPrintTag Binary TLV Parser/Encoder
@@ -137,6 +138,13 @@ static uint32_t readUint32BE(const uint8_t* data) {
            ((uint32_t)data[2] << 8) | data[3];
 }
 
+// Read a 1 or 2 byte integer field (temperatures, times); empty fields keep
+// the current value instead of reading past the field
+static int16_t readTlvInt(const uint8_t* data, uint16_t len, int16_t current) {
+    if (len == 0) return current;
+    return (len >= 2) ? (int16_t)readUint16BE(data) : data[0];
+}
+
 // Read a float encoded as fixed-point or IEEE 754
 static float readFixedFloat(const uint8_t* data, uint16_t len) {
     if (len == 2) {
@@ -154,39 +162,39 @@ static float readFixedFloat(const uint8_t* data, uint16_t len) {
 
 // --- Format Detection ---
 
+// Compare a record type span without building a String
+static bool spanEquals(const uint8_t* data, uint16_t length, const char* text) {
+    size_t textLength = strlen(text);
+    return length == textLength && memcmp(data, text, textLength) == 0;
+}
+
+static bool spanContains(const uint8_t* data, uint16_t length, const char* text) {
+    size_t textLength = strlen(text);
+    for (uint16_t i = 0; i + textLength <= length; i++) {
+        if (memcmp(data + i, text, textLength) == 0) return true;
+    }
+    return false;
+}
+
 NfcTagFormat detectTagFormat(const uint8_t* ndefPayload, uint16_t payloadLength,
                              uint8_t typeLength, const uint8_t* recordType) {
     if (!ndefPayload || payloadLength == 0) return TAG_FORMAT_UNKNOWN;
 
     // Check NDEF record type for JSON MIME type
     if (typeLength > 0 && recordType) {
-        String type = "";
-        for (uint8_t i = 0; i < typeLength; i++) {
-            type += (char)recordType[i];
+        // OpenSpool uses "application/json" MIME type; JSON without the
+        // openspool protocol field is FilaMan format, handled the same way
+        if (spanEquals(recordType, typeLength, "application/json")) {
+            return TAG_FORMAT_OPENSPOOL;
         }
 
-        // OpenSpool uses "application/json" MIME type
-        if (type == "application/json") {
-            // Quick check for openspool protocol field
-            if (payloadLength >= 20) {
-                String preview = "";
-                for (uint16_t i = 0; i < min((uint16_t)100, payloadLength); i++) {
-                    if (ndefPayload[i] >= 32 && ndefPayload[i] <= 126) {
-                        preview += (char)ndefPayload[i];
-                    }
-                }
-                if (preview.indexOf("\"protocol\"") >= 0 &&
-                    preview.indexOf("openspool") >= 0) {
-                    return TAG_FORMAT_OPENSPOOL;
-                }
-            }
-            // JSON but not openspool — could still be FilaMan format
-            return TAG_FORMAT_OPENSPOOL;
+        if (spanEquals(recordType, typeLength, COMPACT_TAG_MIME_TYPE)) {
+            return TAG_FORMAT_COMPACT;
         }
 
         // OpenPrintTag uses a specific MIME or external type
         // The spec may use "application/vnd.openprinttag" or similar
-        if (type.indexOf("openprinttag") >= 0 || type.indexOf("opt") >= 0) {
+        if (spanContains(recordType, typeLength, "openprinttag") || spanContains(recordType, typeLength, "opt")) {
             return TAG_FORMAT_OPENPRINTTAG;
         }
     }
@@ -356,23 +364,23 @@ bool parseOpenPrintTag(const uint8_t* payload, uint16_t payloadLength, OpenPrint
                 break;
 
             case OPT_MIN_PRINT_TEMP:
-                data.minPrintTemp = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.minPrintTemp = readTlvInt(fieldData, fieldLen, data.minPrintTemp);
                 break;
 
             case OPT_MAX_PRINT_TEMP:
-                data.maxPrintTemp = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.maxPrintTemp = readTlvInt(fieldData, fieldLen, data.maxPrintTemp);
                 break;
 
             case OPT_PREHEAT_TEMP:
-                data.preheatTemp = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.preheatTemp = readTlvInt(fieldData, fieldLen, data.preheatTemp);
                 break;
 
             case OPT_MIN_BED_TEMP:
-                data.minBedTemp = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.minBedTemp = readTlvInt(fieldData, fieldLen, data.minBedTemp);
                 break;
 
             case OPT_MAX_BED_TEMP:
-                data.maxBedTemp = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.maxBedTemp = readTlvInt(fieldData, fieldLen, data.maxBedTemp);
                 break;
 
             case OPT_DENSITY:
@@ -391,11 +399,11 @@ bool parseOpenPrintTag(const uint8_t* payload, uint16_t payloadLength, OpenPrint
                 break;
 
             case OPT_DRYING_TEMPERATURE:
-                data.dryingTemperature = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.dryingTemperature = readTlvInt(fieldData, fieldLen, data.dryingTemperature);
                 break;
 
             case OPT_DRYING_TIME:
-                data.dryingTime = (fieldLen >= 2) ? (int16_t)readUint16BE(fieldData) : fieldData[0];
+                data.dryingTime = readTlvInt(fieldData, fieldLen, data.dryingTime);
                 break;
 
             default:
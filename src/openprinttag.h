@@ -153,6 +153,7 @@ enum NfcTagFormat {
     TAG_FORMAT_OPENSPOOL,      // JSON NDEF with "protocol":"openspool"
     TAG_FORMAT_OPENPRINTTAG,   // Binary TLV NDEF (OpenPrintTag)
     TAG_FORMAT_RAW_SPOOL_ID,   // Raw ASCII digits on pages 5-8 (Tool-Aware-NFC-Reader)
+    TAG_FORMAT_COMPACT,        // Compact key-dictionary NDEF ("fm/s", see compacttag.h)
 };
 
 // Detect NFC tag format from NDEF payload
@@ -0,0 +1,360 @@
+#include "pn532.h"
+
+#define PN532_PREAMBLE              0x00
+#define PN532_STARTCODE1            0x00
+#define PN532_STARTCODE2            0xFF
+#define PN532_POSTAMBLE             0x00
+#define PN532_HOSTTOPN532           0xD4
+#define PN532_PN532TOHOST           0xD5
+
+#define NTAG_CMD_READ               0x30
+#define NTAG_CMD_WRITE              0xA2
+
+#define PN532_SELFTEST_ECHO_BYTES   200
+
+Pn532::Pn532(Pn532Transport* transport) : _transport(transport), _target(0) {}
+
+Pn532::~Pn532() {
+    delete _transport;
+}
+
+bool Pn532::begin() {
+    _target = 0;
+    if (!_transport->begin()) return false;
+    // The first command after a wakeup is often lost, sync with a throwaway one
+    getFirmwareVersion();
+    return true;
+}
+
+// ##### Framing #####
+bool Pn532::writeFrame(const uint8_t* cmd, uint8_t cmdLength) {
+    if (cmdLength >= PN532_PACKET_BUFFER_SIZE) return false;
+
+    uint8_t length = cmdLength + 1;     // TFI + command
+    uint8_t checksum = PN532_HOSTTOPN532;
+    uint16_t pos = 0;
+
+    _packet[pos++] = PN532_PREAMBLE;
+    _packet[pos++] = PN532_STARTCODE1;
+    _packet[pos++] = PN532_STARTCODE2;
+    _packet[pos++] = length;
+    _packet[pos++] = (uint8_t)(~length + 1);
+    _packet[pos++] = PN532_HOSTTOPN532;
+    for (uint8_t i = 0; i < cmdLength; i++) {
+        _packet[pos++] = cmd[i];
+        checksum += cmd[i];
+    }
+    _packet[pos++] = (uint8_t)(~checksum + 1);
+    _packet[pos++] = PN532_POSTAMBLE;
+
+    return _transport->write(_packet, pos);
+}
+
+// Reads one frame into buffer (TFI and data). Returns the frame length,
+// 0 for an ACK frame or -1 for NACK, checksum errors and oversized frames.
+int16_t Pn532::readFrame(uint8_t* buffer, uint16_t bufferSize) {
+    if (!_transport->beginRead(bufferSize + 8)) {
+        _transport->endRead();
+        return -1;
+    }
+
+    // Skip the preamble up to the 00 FF start code
+    uint8_t previous = 0xFF;
+    uint8_t current = 0;
+    bool started = false;
+    for (uint8_t i = 0; i < 8 && _transport->read(&current, 1); i++) {
+        if (previous == PN532_STARTCODE1 && current == PN532_STARTCODE2) {
+            started = true;
+            break;
+        }
+        previous = current;
+    }
+
+    int16_t result = -1;
+    uint8_t header[2];
+    if (started && _transport->read(header, sizeof(header))) {
+        uint8_t length = header[0];
+        if (length == 0x00 && header[1] == 0xFF) {
+            result = 0;
+        } else if (length > 0 && length <= bufferSize && (uint8_t)(length + header[1]) == 0) {
+            uint8_t dcs;
+            if (_transport->read(buffer, length) && _transport->read(&dcs, 1)) {
+                uint8_t sum = dcs;
+                for (uint8_t i = 0; i < length; i++) sum += buffer[i];
+                if (sum == 0) result = length;
+            }
+        }
+    }
+
+    _transport->endRead();
+    return result;
+}
+
+// timeout 0 waits forever
+bool Pn532::waitReady(uint16_t timeout) {
+    unsigned long start = millis();
+    uint8_t polls = 0;
+
+    while (!_transport->isReady()) {
+        if (timeout != 0 && millis() - start >= timeout) return false;
+        // Most responses arrive within a millisecond, poll those closely
+        if (polls < 10) {
+            polls++;
+            delayMicroseconds(100);
+        } else {
+            vTaskDelay(1);
+        }
+    }
+    return true;
+}
+
+// ##### Command interface #####
+bool Pn532::sendCommand(const uint8_t* cmd, uint8_t cmdLength, uint16_t ackTimeout) {
+    if (!writeFrame(cmd, cmdLength)) return false;
+    if (!waitReady(ackTimeout)) return false;
+    return readFrame(_packet, 0) == 0;
+}
+
+int16_t Pn532::readResponse(uint8_t command, uint8_t* buffer, uint16_t bufferSize, uint16_t timeout) {
+    if (!waitReady(timeout)) return -1;
+
+    uint16_t frameSize = min((uint16_t)(bufferSize + 2), (uint16_t)PN532_PACKET_BUFFER_SIZE);
+    int16_t length = readFrame(_packet, frameSize);
+    if (length < 2 || _packet[0] != PN532_PN532TOHOST || _packet[1] != command + 1) {
+        return -1;
+    }
+
+    length -= 2;
+    memcpy(buffer, _packet + 2, length);
+    return length;
+}
+
+int16_t Pn532::command(const uint8_t* cmd, uint8_t cmdLength, uint8_t* response, uint16_t responseSize, uint16_t timeout) {
+    if (!sendCommand(cmd, cmdLength)) return -1;
+    return readResponse(cmd[0], response, responseSize, timeout);
+}
+
+// An ACK frame from the host cancels the command in progress
+void Pn532::abortCommand() {
+    const uint8_t ack[] = { 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00 };
+    _transport->write(ack, sizeof(ack));
+    delay(1);
+}
+
+// ##### Chip commands #####
+uint32_t Pn532::getFirmwareVersion() {
+    const uint8_t cmd[] = { PN532_COMMAND_GETFIRMWAREVERSION };
+    uint8_t response[4];
+
+    if (command(cmd, sizeof(cmd), response, sizeof(response)) != sizeof(response)) return 0;
+    return ((uint32_t)response[0] << 24) | ((uint32_t)response[1] << 16) |
+           ((uint32_t)response[2] << 8) | response[3];
+}
+
+// Normal mode, 1 s virtual card timeout, IRQ pin enabled
+bool Pn532::SAMConfig() {
+    const uint8_t cmd[] = { PN532_COMMAND_SAMCONFIGURATION, 0x01, 0x14, 0x01 };
+    uint8_t response[1];
+    return command(cmd, sizeof(cmd), response, sizeof(response)) >= 0;
+}
+
+bool Pn532::setPassiveActivationRetries(uint8_t maxRetries) {
+    const uint8_t cmd[] = { PN532_COMMAND_RFCONFIGURATION, 0x05, 0xFF, 0x01, maxRetries };
+    uint8_t response[1];
+    return command(cmd, sizeof(cmd), response, sizeof(response)) >= 0;
+}
+
+bool Pn532::readPassiveTargetID(uint8_t cardBaudRate, uint8_t* uid, uint8_t* uidLength, uint16_t timeout) {
+    if (!startPassiveTargetIDDetection(cardBaudRate)) return false;
+
+    if (!readDetectedPassiveTargetID(uid, uidLength, timeout)) {
+        // No tag within the timeout, don't leave the PN532 searching
+        abortCommand();
+        return false;
+    }
+    return true;
+}
+
+bool Pn532::startPassiveTargetIDDetection(uint8_t cardBaudRate, uint8_t maxTargets) {
+    const uint8_t cmd[] = { PN532_COMMAND_INLISTPASSIVETARGET, maxTargets, cardBaudRate };
+
+    _target = 0;
+    return sendCommand(cmd, sizeof(cmd));
+}
+
+bool Pn532::readDetectedPassiveTargetID(uint8_t* uid, uint8_t* uidLength, uint16_t timeout) {
+    Pn532Target target;
+
+    if (readDetectedPassiveTargets(&target, 1, timeout) == 0) {
+        return false;
+    }
+
+    *uidLength = target.uidLength;
+    memcpy(uid, target.uid, target.uidLength);
+    return true;
+}
+
+uint8_t Pn532::readPassiveTargets(uint8_t cardBaudRate, Pn532Target* targets, uint8_t maxTargets, uint16_t timeout) {
+    if (!startPassiveTargetIDDetection(cardBaudRate, maxTargets)) return 0;
+
+    uint8_t count = readDetectedPassiveTargets(targets, maxTargets, timeout);
+    if (count == 0) {
+        // No tag within the timeout, don't leave the PN532 searching
+        abortCommand();
+    }
+    return count;
+}
+
+uint8_t Pn532::readDetectedPassiveTargets(Pn532Target* targets, uint8_t maxTargets, uint16_t timeout) {
+    uint8_t response[64];
+
+    int16_t length = readResponse(PN532_COMMAND_INLISTPASSIVETARGET, response, sizeof(response), timeout);
+    if (length < 1) return 0;
+
+    // NbTg, then per target: Tg, SENS_RES (2), SEL_RES, NFCIDLength, NFCID
+    // and, for ISO14443-4 targets (SEL_RES bit 5), the ATS with its length byte.
+    // Callers use 7 byte UID buffers, triple size UIDs are not supported
+    uint8_t count = 0;
+    int16_t pos = 1;
+    for (uint8_t i = 0; i < response[0] && count < maxTargets; i++) {
+        if (pos + 5 > length) break;
+        uint8_t selRes = response[pos + 3];
+        uint8_t uidLength = response[pos + 4];
+        if (uidLength > 7 || pos + 5 + uidLength > length) break;
+
+        Pn532Target& target = targets[count++];
+        target.tg = response[pos];
+        target.uidLength = uidLength;
+        memcpy(target.uid, response + pos + 5, uidLength);
+        pos += 5 + uidLength;
+
+        if (selRes & 0x20) {
+            if (pos >= length) break;
+            pos += response[pos];
+        }
+    }
+
+    if (count > 0) _target = targets[0].tg;
+    return count;
+}
+
+bool Pn532::inDataExchange(uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t* responseLength) {
+    uint8_t cmd[64];
+    uint8_t rx[PN532_PACKET_BUFFER_SIZE];
+
+    if (_target == 0 || sendLength > sizeof(cmd) - 2) return false;
+
+    cmd[0] = PN532_COMMAND_INDATAEXCHANGE;
+    cmd[1] = _target;
+    memcpy(cmd + 2, send, sendLength);
+
+    int16_t length = command(cmd, sendLength + 2, rx, *responseLength + 1);
+    // First byte is the status, error code in the lower 6 bits
+    if (length < 1 || (rx[0] & 0x3F) != 0) return false;
+
+    length = min((int16_t)(length - 1), (int16_t)*responseLength);
+    memcpy(response, rx + 1, length);
+    *responseLength = length;
+    return true;
+}
+
+bool Pn532::inCommunicateThru(const uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t* responseLength) {
+    uint8_t cmd[64];
+    uint8_t rx[PN532_PACKET_BUFFER_SIZE];
+
+    if (_target == 0 || sendLength > sizeof(cmd) - 1) return false;
+
+    cmd[0] = PN532_COMMAND_INCOMMUNICATETHRU;
+    memcpy(cmd + 1, send, sendLength);
+
+    int16_t length = command(cmd, sendLength + 1, rx, *responseLength + 1);
+    if (length < 1 || (rx[0] & 0x3F) != 0) return false;
+
+    length = min((int16_t)(length - 1), (int16_t)*responseLength);
+    memcpy(response, rx + 1, length);
+    *responseLength = length;
+    return true;
+}
+
+// READ returns 4 pages, only the first one is used
+uint8_t Pn532::ntag2xx_ReadPage(uint8_t page, uint8_t* buffer) {
+    uint8_t cmd[2] = { NTAG_CMD_READ, page };
+    uint8_t response[16];
+    uint8_t responseLength = sizeof(response);
+
+    if (!inDataExchange(cmd, sizeof(cmd), response, &responseLength) || responseLength != sizeof(response)) {
+        return 0;
+    }
+    memcpy(buffer, response, 4);
+    return 1;
+}
+
+uint8_t Pn532::ntag2xx_WritePage(uint8_t page, uint8_t* data) {
+    uint8_t cmd[6] = { NTAG_CMD_WRITE, page, data[0], data[1], data[2], data[3] };
+    uint8_t response[1];
+    uint8_t responseLength = 0;
+
+    return inDataExchange(cmd, sizeof(cmd), response, &responseLength) ? 1 : 0;
+}
+
+// ##### Self-test #####
+// Command latency from GetFirmwareVersion round trips, throughput from the
+// Diagnose communication line test, which echoes its payload back.
+bool Pn532::runSelfTest(Pn532SelfTestResult& result, uint16_t iterations) {
+    memset(&result, 0, sizeof(result));
+    result.valid = true;
+    result.transport = _transport->name();
+    result.clock = _transport->clock();
+    result.iterations = iterations;
+    result.latencyMinUs = UINT32_MAX;
+
+    unsigned long testStart = millis();
+    uint64_t latencyTotal = 0;
+    result.ok = iterations > 0;
+
+    for (uint16_t i = 0; i < iterations && result.ok; i++) {
+        uint32_t start = micros();
+        if (!getFirmwareVersion()) {
+            result.ok = false;
+            break;
+        }
+        uint32_t elapsed = micros() - start;
+        latencyTotal += elapsed;
+        result.latencyMinUs = min(result.latencyMinUs, elapsed);
+        result.latencyMaxUs = max(result.latencyMaxUs, elapsed);
+    }
+    if (result.ok) {
+        result.latencyAvgUs = latencyTotal / iterations;
+    } else {
+        result.latencyMinUs = 0;
+    }
+
+    // Echo frame: TFI, response code, NumTst and payload plus 7 bytes framing
+    uint8_t tx[PN532_PACKET_BUFFER_SIZE];
+    uint8_t rx[PN532_PACKET_BUFFER_SIZE];
+    uint16_t echoBytes = min((uint16_t)PN532_SELFTEST_ECHO_BYTES, (uint16_t)(_transport->maxReadLength() - 12));
+    result.echoBytes = echoBytes;
+
+    tx[0] = PN532_COMMAND_DIAGNOSE;
+    tx[1] = 0x00;                       // Communication line test
+    for (uint16_t i = 0; i < echoBytes; i++) tx[2 + i] = (uint8_t)(i * 7 + 1);
+
+    uint32_t echoStart = micros();
+    for (uint16_t i = 0; i < iterations && result.ok; i++) {
+        int16_t length = command(tx, echoBytes + 2, rx, echoBytes + 1);
+        if (length != echoBytes + 1 || memcmp(rx, tx + 1, echoBytes + 1) != 0) {
+            result.ok = false;
+        }
+    }
+    uint32_t echoElapsed = micros() - echoStart;
+
+    if (result.ok && echoElapsed > 0) {
+        result.bytesPerSecond = (uint64_t)2 * echoBytes * iterations * 1000000ULL / echoElapsed;
+    }
+    result.durationMs = millis() - testStart;
+
+    Serial.printf("PN532 self-test (%s @ %u): %s, latency %u/%u/%u us, %u bytes/s\n",
+        result.transport, result.clock, result.ok ? "OK" : "FAILED",
+        result.latencyMinUs, result.latencyAvgUs, result.latencyMaxUs, result.bytesPerSecond);
+    return result.ok;
+}
@@ -0,0 +1,96 @@
+#ifndef PN532_H
+#define PN532_H
+
+#include <Arduino.h>
+#include "pn532transport.h"
+
+#define PN532_MIFARE_ISO14443A              0x00
+
+#define PN532_COMMAND_DIAGNOSE              0x00
+#define PN532_COMMAND_GETFIRMWAREVERSION    0x02
+#define PN532_COMMAND_SAMCONFIGURATION      0x14
+#define PN532_COMMAND_RFCONFIGURATION       0x32
+#define PN532_COMMAND_INDATAEXCHANGE        0x40
+#define PN532_COMMAND_INCOMMUNICATETHRU     0x42
+#define PN532_COMMAND_INLISTPASSIVETARGET   0x4A
+
+#define PN532_ACK_TIMEOUT_MS                50
+#define PN532_DEFAULT_TIMEOUT_MS            1000
+// Largest normal information frame: TFI + 254 bytes
+#define PN532_PACKET_BUFFER_SIZE            255
+// InListPassiveTarget handles at most two targets at once
+#define PN532_MAX_TARGETS                   2
+
+struct Pn532Target {
+    uint8_t tg;                     // target number for InDataExchange
+    uint8_t uid[7];
+    uint8_t uidLength;
+};
+
+struct Pn532SelfTestResult {
+    bool valid;
+    bool ok;
+    const char* transport;
+    uint32_t clock;                 // Hz (SPI/I2C) or baud (HSU), 0 for soft SPI
+    uint16_t iterations;
+    uint32_t latencyMinUs;          // GetFirmwareVersion round trip
+    uint32_t latencyAvgUs;
+    uint32_t latencyMaxUs;
+    uint16_t echoBytes;             // Diagnose echo payload per iteration
+    uint32_t bytesPerSecond;        // payload bytes sent + received
+    unsigned long durationMs;
+};
+
+// PN532 driver on top of a Pn532Transport. Keeps the Adafruit_PN532 method
+// names used throughout nfc.cpp and remembers the target number (Tg) of the
+// last listed tag so InDataExchange always addresses the right target.
+class Pn532 {
+public:
+    explicit Pn532(Pn532Transport* transport);
+    ~Pn532();
+
+    bool begin();
+    uint32_t getFirmwareVersion();
+    bool SAMConfig();
+    bool setPassiveActivationRetries(uint8_t maxRetries);
+    bool readPassiveTargetID(uint8_t cardBaudRate, uint8_t* uid, uint8_t* uidLength, uint16_t timeout = 0);
+    // Split detection: start InListPassiveTarget, fetch the target once the
+    // PN532 reports a response (IRQ low / ready). Abort with abortCommand().
+    bool startPassiveTargetIDDetection(uint8_t cardBaudRate, uint8_t maxTargets = 1);
+    bool readDetectedPassiveTargetID(uint8_t* uid, uint8_t* uidLength, uint16_t timeout = PN532_ACK_TIMEOUT_MS);
+    // Up to PN532_MAX_TARGETS tags in one InListPassiveTarget, returns the
+    // number found. The first one is selected, switch with selectTarget().
+    uint8_t readPassiveTargets(uint8_t cardBaudRate, Pn532Target* targets, uint8_t maxTargets, uint16_t timeout = 0);
+    uint8_t readDetectedPassiveTargets(Pn532Target* targets, uint8_t maxTargets, uint16_t timeout = PN532_ACK_TIMEOUT_MS);
+    void selectTarget(uint8_t tg) { _target = tg; }
+    bool inDataExchange(uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t* responseLength);
+    // Raw frame to the selected tag. InDataExchange interprets some command
+    // codes itself (0x60 GET_VERSION is MIFARE AUTH_A there).
+    bool inCommunicateThru(const uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t* responseLength);
+    uint8_t ntag2xx_ReadPage(uint8_t page, uint8_t* buffer);
+    uint8_t ntag2xx_WritePage(uint8_t page, uint8_t* data);
+
+    // Generic command interface. Returns the response data length (without
+    // TFI and response code) or -1 on timeout / error.
+    bool sendCommand(const uint8_t* cmd, uint8_t cmdLength, uint16_t ackTimeout = PN532_ACK_TIMEOUT_MS);
+    int16_t readResponse(uint8_t command, uint8_t* buffer, uint16_t bufferSize, uint16_t timeout = PN532_DEFAULT_TIMEOUT_MS);
+    int16_t command(const uint8_t* cmd, uint8_t cmdLength, uint8_t* response, uint16_t responseSize,
+                    uint16_t timeout = PN532_DEFAULT_TIMEOUT_MS);
+    void abortCommand();
+
+    bool runSelfTest(Pn532SelfTestResult& result, uint16_t iterations = 20);
+
+    Pn532Transport& transport() { return *_transport; }
+    uint8_t selectedTarget() const { return _target; }
+
+private:
+    bool writeFrame(const uint8_t* cmd, uint8_t cmdLength);
+    int16_t readFrame(uint8_t* buffer, uint16_t bufferSize);
+    bool waitReady(uint16_t timeout);
+
+    Pn532Transport* _transport;
+    uint8_t _target;
+    uint8_t _packet[PN532_PACKET_BUFFER_SIZE + 8];
+};
+
+#endif
@@ -0,0 +1,505 @@
+#include "pn532sim.h"
+
+#ifdef ENABLE_PN532_SIMULATOR
+
+#include <LittleFS.h>
+#include "nfc.h"
+#include "compacttag.h"
+
+#define SIM_STATUS_OK               0x00
+#define SIM_STATUS_TIMEOUT          0x01    // no answer from the target (removed, NAK)
+#define SIM_STATUS_CRC_ERROR        0x02
+#define SIM_STATUS_AUTH_ERROR       0x14    // MIFARE authentication failed
+
+#define NTAG_CMD_GET_VERSION        0x60
+#define NTAG_CMD_READ               0x30
+#define NTAG_CMD_FAST_READ          0x3A
+#define NTAG_CMD_WRITE              0xA2
+
+// Three tag types, each read and removed, then a write on the NTAG216
+static const char* const defaultScenario = R"({
+  "latencyUs": 2000,
+  "byteTimeUs": 10,
+  "repeat": true,
+  "steps": [
+    { "delay": 3000, "action": "place", "tag": "ntag213", "uid": "04A1B2C3D4E513", "encoding": "compact",
+      "payload": "{\"sm_id\":\"1\",\"color_hex\":\"FF0000\",\"type\":\"PLA\",\"min_temp\":\"190\",\"max_temp\":\"220\",\"brand\":\"Generic\"}" },
+    { "delay": 5000, "action": "remove" },
+    { "delay": 2000, "action": "place", "tag": "ntag215", "uid": "04A1B2C3D4E515",
+      "payload": "{\"sm_id\":\"2\",\"color_hex\":\"00FF00\",\"type\":\"PETG\",\"min_temp\":\"220\",\"max_temp\":\"250\",\"brand\":\"Generic\"}" },
+    { "delay": 5000, "action": "remove" },
+    { "delay": 2000, "action": "place", "tag": "ntag216", "uid": "04A1B2C3D4E516",
+      "payload": "{\"sm_id\":\"3\",\"color_hex\":\"0000FF\",\"type\":\"ABS\",\"min_temp\":\"240\",\"max_temp\":\"260\",\"brand\":\"Generic\"}" },
+    { "delay": 4000, "action": "write",
+      "payload": "{\"sm_id\":\"4\",\"color_hex\":\"FFFFFF\",\"type\":\"ASA\",\"min_temp\":\"240\",\"max_temp\":\"260\",\"brand\":\"Generic\"}" },
+    { "delay": 8000, "action": "remove" }
+  ]
+})";
+
+static const char* hostScenario = nullptr;
+static Pn532SimResultCallback resultCallback = nullptr;
+
+void pn532SimSetScenario(const char* json) {
+    hostScenario = json;
+}
+
+void pn532SimSetResultCallback(Pn532SimResultCallback callback) {
+    resultCallback = callback;
+}
+
+Pn532SimTransport::Pn532SimTransport()
+    : _stepCount(0), _nextStep(0), _repeat(false), _lastStepMs(0), _latencyUs(2000), _byteTimeUs(10),
+      _placedMs(0), _waitingForSpool(false), _spoolSet(false), _spoolSetMs(0), _waitingForWrite(false), _writeRequestedMs(0),
+      _ackPending(false), _listPending(false), _responseQueued(false), _responseAtUs(0),
+      _responseLength(0), _readFrame(nullptr), _readLength(0), _readPos(0) {
+    memset(&_tag, 0, sizeof(_tag));
+}
+
+bool Pn532SimTransport::begin() {
+    loadScenario();
+    _lastStepMs = millis();
+    return true;
+}
+
+// ##### Scenario #####
+void Pn532SimTransport::loadScenario() {
+    JsonDocument doc;
+    const char* source = nullptr;
+
+    if (hostScenario != nullptr) {
+        DeserializationError error = deserializeJson(doc, hostScenario);
+        if (error) {
+            Serial.printf("SIM: host scenario invalid (%s), using the default scenario\n", error.c_str());
+        } else {
+            source = "host";
+        }
+    } else {
+        File file = LittleFS.open(PN532_SIM_SCENARIO_FILE, "r");
+        if (file) {
+            DeserializationError error = deserializeJson(doc, file);
+            file.close();
+            if (error) {
+                Serial.printf("SIM: %s invalid (%s), using the default scenario\n", PN532_SIM_SCENARIO_FILE, error.c_str());
+            } else {
+                source = PN532_SIM_SCENARIO_FILE;
+            }
+        }
+    }
+    if (source == nullptr) {
+        doc.clear();
+        deserializeJson(doc, defaultScenario);
+        source = "default";
+    }
+
+    _latencyUs = doc["latencyUs"] | 2000;
+    _byteTimeUs = doc["byteTimeUs"] | 10;
+    _repeat = doc["repeat"] | false;
+    _stepCount = 0;
+    _nextStep = 0;
+
+    for (JsonObjectConst json : doc["steps"].as<JsonArrayConst>()) {
+        if (_stepCount >= PN532_SIM_MAX_STEPS) break;
+        if (parseStep(json, _steps[_stepCount])) {
+            _stepCount++;
+        }
+    }
+
+    Serial.printf("SIM: %s scenario, %u steps, %u us per command\n", source, _stepCount, _latencyUs);
+}
+
+bool Pn532SimTransport::parseStep(JsonObjectConst json, Step& step) {
+    String action = json["action"] | "";
+    if (action == "place") step.action = STEP_PLACE;
+    else if (action == "remove") step.action = STEP_REMOVE;
+    else if (action == "write") step.action = STEP_WRITE;
+    else {
+        Serial.printf("SIM: unknown step action '%s'\n", action.c_str());
+        return false;
+    }
+
+    step.delayMs = json["delay"] | 0;
+    String tag = json["tag"] | "ntag215";
+    step.tagType = (tag == "ntag213") ? 213 : (tag == "ntag216") ? 216 : 215;
+    step.payload = json["payload"] | "";
+    step.compact = String(json["encoding"] | "json") == "compact";
+    step.writeProtected = json["writeProtected"] | false;
+    step.failReads = json["failReads"] | 1;
+    step.removeAfterExchanges = json["removeAfterExchanges"] | 0;
+
+    // Default UID: 04 followed by the step number
+    memset(step.uid, 0, sizeof(step.uid));
+    step.uid[0] = 0x04;
+    step.uid[6] = _stepCount;
+    String uid = json["uid"] | "";
+    if (uid.length() == 14) {
+        for (uint8_t i = 0; i < 7; i++) {
+            step.uid[i] = strtoul(uid.substring(i * 2, i * 2 + 2).c_str(), nullptr, 16);
+        }
+    }
+
+    step.failPageCount = 0;
+    for (JsonVariantConst page : json["failPages"].as<JsonArrayConst>()) {
+        if (step.failPageCount >= PN532_SIM_MAX_FAIL_PAGES) break;
+        step.failPages[step.failPageCount++] = page.as<uint8_t>();
+    }
+    return true;
+}
+
+void Pn532SimTransport::update() {
+    if (_stepCount > 0 && _nextStep < _stepCount) {
+        const Step& step = _steps[_nextStep];
+        if (millis() - _lastStepMs >= step.delayMs) {
+            _lastStepMs = millis();
+            _nextStep++;
+            runStep(step);
+            if (_nextStep >= _stepCount && _repeat) _nextStep = 0;
+        }
+    }
+    report();
+}
+
+void Pn532SimTransport::runStep(const Step& step) {
+    switch (step.action) {
+        case STEP_PLACE:
+            placeTag(step);
+            break;
+        case STEP_REMOVE:
+            if (_waitingForSpool && !_spoolSet) {
+                Serial.println("SIM: tag removed before activeSpoolId was set");
+                _waitingForSpool = false;
+            }
+            _tag.present = false;
+            Serial.println("SIM: tag removed");
+            report();
+            break;
+        case STEP_WRITE:
+            Serial.println("SIM: requesting tag write");
+            _writeRequestedMs = millis();
+            _waitingForWrite = true;
+            startWriteJsonToTag(true, step.payload.c_str());
+            break;
+    }
+}
+
+void Pn532SimTransport::placeTag(const Step& step) {
+    memset(&_tag, 0, sizeof(_tag));
+    _tag.type = step.tagType;
+    uint8_t ccSize;
+    switch (step.tagType) {
+        case 213: _tag.pageCount = 45;  _tag.userEndPage = 39;  _tag.versionStorage = 0x0F; ccSize = 0x12; break;
+        case 216: _tag.pageCount = 231; _tag.userEndPage = 225; _tag.versionStorage = 0x13; ccSize = 0x6D; break;
+        default:  _tag.pageCount = 135; _tag.userEndPage = 129; _tag.versionStorage = 0x11; ccSize = 0x3E; break;
+    }
+    _tag.writeProtected = step.writeProtected;
+    _tag.removeAfterExchanges = step.removeAfterExchanges;
+    _tag.failPageCount = step.failPageCount;
+    memcpy(_tag.failPages, step.failPages, step.failPageCount);
+    memset(_tag.failCounts, step.failReads, sizeof(_tag.failCounts));
+
+    // UID with check bytes, then the capability container
+    const uint8_t* uid = step.uid;
+    uint8_t* pages = _tag.pages;
+    pages[0] = uid[0]; pages[1] = uid[1]; pages[2] = uid[2];
+    pages[3] = 0x88 ^ uid[0] ^ uid[1] ^ uid[2];
+    memcpy(pages + 4, uid + 3, 4);
+    pages[8] = uid[3] ^ uid[4] ^ uid[5] ^ uid[6];
+    pages[9] = 0x48;
+    pages[12] = 0xE1;
+    pages[13] = 0x10;
+    pages[14] = ccSize;
+    pages[15] = 0x00;
+
+    uint16_t imageLen = 0;
+    uint8_t* image = nullptr;
+    if (step.payload.length() > 0) {
+        if (step.compact) {
+            uint8_t compact[255];
+            uint16_t compactLen = 0;
+            if (compactTagEncode(step.payload.c_str(), compact, sizeof(compact), compactLen)) {
+                image = buildNdefTlvImage(COMPACT_TAG_MIME_TYPE, compact, compactLen, imageLen);
+            }
+        } else {
+            image = buildNdefTlvImage("application/json", (const uint8_t*)step.payload.c_str(),
+                                      step.payload.length(), imageLen);
+        }
+    }
+
+    uint16_t userBytes = (_tag.userEndPage - 3) * 4;
+    if (image && imageLen <= userBytes) {
+        memcpy(pages + 16, image, imageLen);
+    } else {
+        // Empty NDEF message
+        pages[16] = 0x03;
+        pages[17] = 0x00;
+        pages[18] = 0xFE;
+        if (image) Serial.printf("SIM: payload does not fit NTAG%u, tag left empty\n", _tag.type);
+    }
+    free(image);
+
+    _tag.present = true;
+    _placedMs = millis();
+    _waitingForSpool = true;
+    _spoolSet = false;
+    // readNdefStream() sets it again once this tag is read
+    lastTagReadTimeMs = 0;
+    Serial.printf("SIM: NTAG%u placed (%s, %u bytes)%s\n", _tag.type, step.compact ? "compact" : "json",
+                  imageLen, _tag.writeProtected ? ", write protected" : "");
+}
+
+// Benchmark output: placement to activeSpoolId, write request to result
+void Pn532SimTransport::report() {
+    // activeSpoolId is set while the rest of the tag still streams in; the
+    // result waits for the read time, which a cache hit never produces
+    if (_waitingForSpool && !_spoolSet && activeSpoolId != "") {
+        _spoolSet = true;
+        _spoolSetMs = millis();
+    }
+    if (_waitingForSpool && _spoolSet &&
+        (lastTagReadTimeMs != 0 || !_tag.present || millis() - _spoolSetMs >= PN532_SIM_READ_TIME_WAIT_MS)) {
+        _waitingForSpool = false;
+        Pn532SimResult result = {};
+        result.write = false;
+        result.success = true;
+        result.tagType = _tag.type;
+        result.elapsedMs = _spoolSetMs - _placedMs;
+        result.tagReadMs = lastTagReadTimeMs;
+        Serial.printf("SIM RESULT: NTAG%u placement -> activeSpoolId %s in %lu ms (tag read %lu ms)\n",
+                      _tag.type, activeSpoolId.c_str(), result.elapsedMs, result.tagReadMs);
+        if (resultCallback) resultCallback(result);
+    }
+    if (_waitingForWrite && (nfcReaderState == NFC_WRITE_SUCCESS || nfcReaderState == NFC_WRITE_ERROR)) {
+        _waitingForWrite = false;
+        Pn532SimResult result = {};
+        result.write = true;
+        result.success = nfcReaderState == NFC_WRITE_SUCCESS;
+        result.tagType = _tag.type;
+        result.elapsedMs = millis() - _writeRequestedMs;
+        result.ntagWriteMs = lastNdefWriteStats.durationMs;
+        result.pagesWritten = lastNdefWriteStats.pagesWritten;
+        result.pagesSkipped = lastNdefWriteStats.pagesSkipped;
+        Serial.printf("SIM RESULT: NTAG%u write %s in %lu ms (ntag write %lu ms, %u pages written, %u skipped)\n",
+                      _tag.type, result.success ? "ok" : "FAILED", result.elapsedMs, result.ntagWriteMs,
+                      result.pagesWritten, result.pagesSkipped);
+        if (resultCallback) resultCallback(result);
+    }
+}
+
+// ##### PN532 frame level #####
+bool Pn532SimTransport::write(const uint8_t* data, uint16_t length) {
+    delayMicroseconds(_byteTimeUs * length);
+    update();
+
+    // An ACK from the host aborts the command in progress
+    if (length == 6 && data[3] == 0x00 && data[4] == 0xFF) {
+        _listPending = false;
+        _responseQueued = false;
+        _ackPending = false;
+        return true;
+    }
+
+    if (length < 8 || data[0] != 0x00 || data[1] != 0x00 || data[2] != 0xFF || data[5] != 0xD4) {
+        return false;
+    }
+    uint8_t frameLength = data[3];
+    if (frameLength < 2 || 5 + frameLength > length) return false;
+
+    _ackPending = true;
+    _listPending = false;
+    _responseQueued = false;
+    handleCommand(data + 6, frameLength - 1);
+    return true;
+}
+
+bool Pn532SimTransport::isReady() {
+    update();
+    if (_ackPending) return true;
+    if (_listPending && _tag.present) respondPassiveTarget();
+    return _responseQueued && (int32_t)(micros() - _responseAtUs) >= 0;
+}
+
+bool Pn532SimTransport::beginRead(uint16_t maxLength) {
+    static const uint8_t ack[] = { 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00 };
+
+    _readPos = 0;
+    if (_ackPending) {
+        _readFrame = ack;
+        _readLength = sizeof(ack);
+    } else if (_responseQueued) {
+        _readFrame = _response;
+        _readLength = _responseLength;
+    } else {
+        _readFrame = nullptr;
+        _readLength = 0;
+        return false;
+    }
+    return true;
+}
+
+bool Pn532SimTransport::read(uint8_t* data, uint16_t length) {
+    if (!_readFrame || _readPos + length > _readLength) return false;
+    delayMicroseconds(_byteTimeUs * length);
+    memcpy(data, _readFrame + _readPos, length);
+    _readPos += length;
+    return true;
+}
+
+void Pn532SimTransport::endRead() {
+    if (_readFrame == _response) {
+        _responseQueued = false;
+    } else if (_readFrame) {
+        _ackPending = false;
+    }
+    _readFrame = nullptr;
+}
+
+void Pn532SimTransport::queueResponse(uint8_t command, const uint8_t* data, uint16_t length) {
+    uint8_t frameLength = length + 2;
+    uint8_t checksum = 0xD5 + command + 1;
+    uint16_t pos = 0;
+
+    _response[pos++] = 0x00;
+    _response[pos++] = 0x00;
+    _response[pos++] = 0xFF;
+    _response[pos++] = frameLength;
+    _response[pos++] = (uint8_t)(~frameLength + 1);
+    _response[pos++] = 0xD5;
+    _response[pos++] = command + 1;
+    for (uint16_t i = 0; i < length; i++) {
+        _response[pos++] = data[i];
+        checksum += data[i];
+    }
+    _response[pos++] = (uint8_t)(~checksum + 1);
+    _response[pos++] = 0x00;
+
+    _responseLength = pos;
+    _responseQueued = true;
+    _responseAtUs = micros() + _latencyUs;
+}
+
+void Pn532SimTransport::handleCommand(const uint8_t* cmd, uint8_t length) {
+    switch (cmd[0]) {
+        case PN532_COMMAND_GETFIRMWAREVERSION: {
+            const uint8_t version[] = { 0x32, 0x01, 0x06, 0x07 };
+            queueResponse(cmd[0], version, sizeof(version));
+            break;
+        }
+        case PN532_COMMAND_DIAGNOSE:
+            // Communication line test echoes NumTst and the data
+            queueResponse(cmd[0], cmd + 1, length - 1);
+            break;
+        case PN532_COMMAND_INLISTPASSIVETARGET:
+            _listPending = true;
+            if (_tag.present) respondPassiveTarget();
+            break;
+        case PN532_COMMAND_INDATAEXCHANGE:
+            if (length < 3) {
+                const uint8_t status = SIM_STATUS_TIMEOUT;
+                queueResponse(cmd[0], &status, 1);
+            } else {
+                handleDataExchange(cmd[0], cmd + 2, length - 2);
+            }
+            break;
+        case PN532_COMMAND_INCOMMUNICATETHRU:
+            if (length < 2) {
+                const uint8_t status = SIM_STATUS_TIMEOUT;
+                queueResponse(cmd[0], &status, 1);
+            } else {
+                handleDataExchange(cmd[0], cmd + 1, length - 1);
+            }
+            break;
+        default:
+            // SAMConfiguration, RFConfiguration and anything else: plain success
+            queueResponse(cmd[0], nullptr, 0);
+            break;
+    }
+}
+
+bool Pn532SimTransport::respondPassiveTarget() {
+    // NbTg, Tg, SENS_RES, SEL_RES, NFCIDLength, NFCID
+    uint8_t response[13] = { 1, 1, 0x00, 0x44, 0x00, 7 };
+    memcpy(response + 6, _tag.pages, 3);
+    memcpy(response + 9, _tag.pages + 4, 4);
+    _listPending = false;
+    _tag.exchanges = 0;
+    queueResponse(PN532_COMMAND_INLISTPASSIVETARGET, response, sizeof(response));
+    return true;
+}
+
+bool Pn532SimTransport::pageFails(uint8_t page) {
+    for (uint8_t i = 0; i < _tag.failPageCount; i++) {
+        if (_tag.failPages[i] == page && _tag.failCounts[i] > 0) {
+            _tag.failCounts[i]--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// InDataExchange and InCommunicateThru share the tag side. Only the latter
+// passes GET_VERSION through, InDataExchange takes 0x60 for MIFARE AUTH_A.
+void Pn532SimTransport::handleDataExchange(uint8_t command, const uint8_t* data, uint8_t length) {
+    uint8_t response[PN532_PACKET_BUFFER_SIZE];
+    uint16_t responseLength = 1;
+    response[0] = SIM_STATUS_TIMEOUT;
+
+    if (_tag.present && _tag.removeAfterExchanges > 0 && ++_tag.exchanges > _tag.removeAfterExchanges) {
+        Serial.printf("SIM: tag removed after %u exchanges\n", _tag.removeAfterExchanges);
+        _tag.present = false;
+    }
+
+    if (_tag.present) {
+        switch (data[0]) {
+            case NTAG_CMD_GET_VERSION: {
+                if (command != PN532_COMMAND_INCOMMUNICATETHRU) {
+                    response[0] = SIM_STATUS_AUTH_ERROR;
+                    break;
+                }
+                const uint8_t version[] = { 0x00, 0x04, 0x04, 0x02, 0x01, 0x00, _tag.versionStorage, 0x03 };
+                memcpy(response + 1, version, sizeof(version));
+                responseLength += sizeof(version);
+                response[0] = SIM_STATUS_OK;
+                break;
+            }
+            case NTAG_CMD_READ: {
+                if (length < 2 || data[1] >= _tag.pageCount) break;
+                // READ returns 4 pages and wraps around at the end of memory
+                response[0] = SIM_STATUS_OK;
+                for (uint8_t i = 0; i < 4; i++) {
+                    uint8_t page = (data[1] + i) % _tag.pageCount;
+                    if (pageFails(page)) response[0] = SIM_STATUS_CRC_ERROR;
+                    memcpy(response + 1 + i * 4, _tag.pages + page * 4, 4);
+                }
+                if (response[0] == SIM_STATUS_OK) responseLength += 16;
+                break;
+            }
+            case NTAG_CMD_FAST_READ: {
+                if (length < 3 || data[1] > data[2] || data[2] >= _tag.pageCount) break;
+                uint8_t pageCount = data[2] - data[1] + 1;
+                // Response has to fit one PN532 frame
+                if (1 + pageCount * 4 > PN532_PACKET_BUFFER_SIZE - 2) break;
+                response[0] = SIM_STATUS_OK;
+                for (uint8_t page = data[1]; page <= data[2]; page++) {
+                    if (pageFails(page)) response[0] = SIM_STATUS_CRC_ERROR;
+                }
+                if (response[0] == SIM_STATUS_OK) {
+                    memcpy(response + 1, _tag.pages + data[1] * 4, pageCount * 4);
+                    responseLength += pageCount * 4;
+                }
+                break;
+            }
+            case NTAG_CMD_WRITE: {
+                // NAK for locked tags and pages outside the user area
+                if (length < 6 || _tag.writeProtected || data[1] < 4 || data[1] > _tag.userEndPage) break;
+                memcpy(_tag.pages + data[1] * 4, data + 2, 4);
+                response[0] = SIM_STATUS_OK;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    queueResponse(command, response, responseLength);
+}
+
+#endif // ENABLE_PN532_SIMULATOR
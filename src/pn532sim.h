@@ -0,0 +1,133 @@
+#ifndef PN532SIM_H
+#define PN532SIM_H
+
+#ifdef ENABLE_PN532_SIMULATOR
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "pn532.h"
+
+#define PN532_SIM_SCENARIO_FILE     "/pn532sim.json"
+#define PN532_SIM_MAX_PAGES         231
+#define PN532_SIM_MAX_STEPS         24
+#define PN532_SIM_MAX_FAIL_PAGES    8
+#define PN532_SIM_READ_TIME_WAIT_MS 2000    // after activeSpoolId, for the tag read time
+
+// One "SIM RESULT" line of the benchmark
+struct Pn532SimResult {
+    bool write;                     // false: placement -> activeSpoolId
+    bool success;
+    uint8_t tagType;                // 213, 215 or 216
+    unsigned long elapsedMs;        // from placement or write request
+    unsigned long tagReadMs;        // lastTagReadTimeMs, reads only
+    unsigned long ntagWriteMs;      // lastNdefWriteStats, writes only
+    uint16_t pagesWritten;
+    uint16_t pagesSkipped;
+};
+
+typedef void (*Pn532SimResultCallback)(const Pn532SimResult& result);
+
+// Host builds: a scenario used instead of the file and the default, and a
+// callback for every result. Set both before startNfc(); the JSON must stay
+// valid until then.
+void pn532SimSetScenario(const char* json);
+void pn532SimSetResultCallback(Pn532SimResultCallback callback);
+
+// In-memory NTAG21x behind a PN532 that speaks the normal frame protocol, so
+// the driver, nfc.cpp and the web UI run unchanged without a reader. A
+// scenario (pn532SimSetScenario(), LittleFS PN532_SIM_SCENARIO_FILE or a
+// built-in default) places, removes and writes tags on a timeline and the
+// simulator logs the time from placement to activeSpoolId and the duration
+// of every write.
+class Pn532SimTransport : public Pn532Transport {
+public:
+    Pn532SimTransport();
+    bool begin() override;
+    void wakeup() override {}
+    bool write(const uint8_t* data, uint16_t length) override;
+    bool isReady() override;
+    bool beginRead(uint16_t maxLength) override;
+    bool read(uint8_t* data, uint16_t length) override;
+    void endRead() override;
+    const char* name() const override { return "sim"; }
+    uint32_t clock() const override { return 0; }
+
+private:
+    enum StepAction { STEP_PLACE, STEP_REMOVE, STEP_WRITE };
+
+    struct Step {
+        StepAction action;
+        unsigned long delayMs;          // after the previous step
+        uint8_t tagType;                // 213, 215 or 216
+        uint8_t uid[7];
+        String payload;
+        bool compact;
+        bool writeProtected;
+        uint8_t failPages[PN532_SIM_MAX_FAIL_PAGES];
+        uint8_t failPageCount;
+        uint8_t failReads;              // failed reads per listed page
+        uint16_t removeAfterExchanges;  // 0 = stays until a remove step
+    };
+
+    struct Tag {
+        bool present;
+        uint8_t type;
+        uint8_t pageCount;
+        uint8_t userEndPage;            // last user data page
+        uint8_t versionStorage;         // GET_VERSION storage size byte
+        bool writeProtected;
+        uint8_t pages[PN532_SIM_MAX_PAGES * 4];
+        uint8_t failPages[PN532_SIM_MAX_FAIL_PAGES];
+        uint8_t failCounts[PN532_SIM_MAX_FAIL_PAGES];
+        uint8_t failPageCount;
+        uint16_t exchanges;
+        uint16_t removeAfterExchanges;
+    };
+
+    void loadScenario();
+    bool parseStep(JsonObjectConst json, Step& step);
+    void update();
+    void runStep(const Step& step);
+    void placeTag(const Step& step);
+    void report();
+
+    void handleCommand(const uint8_t* cmd, uint8_t length);
+    bool respondPassiveTarget();
+    void handleDataExchange(uint8_t command, const uint8_t* data, uint8_t length);
+    bool pageFails(uint8_t page);
+    void queueResponse(uint8_t command, const uint8_t* data, uint16_t length);
+
+    // Scenario
+    Step _steps[PN532_SIM_MAX_STEPS];
+    uint8_t _stepCount;
+    uint8_t _nextStep;
+    bool _repeat;
+    unsigned long _lastStepMs;
+    uint32_t _latencyUs;                // per command
+    uint32_t _byteTimeUs;               // per frame byte on the bus
+
+    Tag _tag;
+
+    // Benchmark
+    unsigned long _placedMs;
+    bool _waitingForSpool;
+    bool _spoolSet;                     // activeSpoolId set, read time pending
+    unsigned long _spoolSetMs;
+    bool _waitingForWrite;
+    unsigned long _writeRequestedMs;
+
+    // PN532 state
+    bool _ackPending;
+    bool _listPending;                  // InListPassiveTarget waiting for a tag
+    bool _responseQueued;
+    uint32_t _responseAtUs;
+    uint8_t _response[PN532_PACKET_BUFFER_SIZE + 8];
+    uint16_t _responseLength;
+    const uint8_t* _readFrame;
+    uint16_t _readLength;
+    uint16_t _readPos;
+};
+
+#endif // ENABLE_PN532_SIMULATOR
+
+#endif
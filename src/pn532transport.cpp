@@ -0,0 +1,230 @@
+#include "pn532transport.h"
+#include "pn532sim.h"
+
+#define PN532_HSU_READ_TIMEOUT_MS   20
+
+// ##### Software SPI #####
+Pn532SoftSpiTransport::Pn532SoftSpiTransport(uint8_t sck, uint8_t miso, uint8_t mosi, uint8_t ss)
+    : _sck(sck), _miso(miso), _mosi(mosi), _ss(ss) {}
+
+bool Pn532SoftSpiTransport::begin() {
+    pinMode(_ss, OUTPUT);
+    digitalWrite(_ss, HIGH);
+    pinMode(_sck, OUTPUT);
+    digitalWrite(_sck, LOW);
+    pinMode(_mosi, OUTPUT);
+    pinMode(_miso, INPUT);
+    wakeup();
+    return true;
+}
+
+void Pn532SoftSpiTransport::wakeup() {
+    digitalWrite(_ss, LOW);
+    delay(2);
+    digitalWrite(_ss, HIGH);
+}
+
+// PN532 SPI is LSB first, data sampled on the rising edge
+uint8_t Pn532SoftSpiTransport::transfer(uint8_t out) {
+    uint8_t in = 0;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        digitalWrite(_mosi, (out >> bit) & 0x01);
+        digitalWrite(_sck, HIGH);
+        if (digitalRead(_miso)) in |= (1 << bit);
+        digitalWrite(_sck, LOW);
+    }
+    return in;
+}
+
+bool Pn532SoftSpiTransport::write(const uint8_t* data, uint16_t length) {
+    digitalWrite(_ss, LOW);
+    transfer(PN532_SPI_DATAWRITE);
+    for (uint16_t i = 0; i < length; i++) transfer(data[i]);
+    digitalWrite(_ss, HIGH);
+    return true;
+}
+
+bool Pn532SoftSpiTransport::isReady() {
+    digitalWrite(_ss, LOW);
+    transfer(PN532_SPI_STATREAD);
+    uint8_t status = transfer(0x00);
+    digitalWrite(_ss, HIGH);
+    return (status & 0x01) != 0;
+}
+
+bool Pn532SoftSpiTransport::beginRead(uint16_t maxLength) {
+    digitalWrite(_ss, LOW);
+    transfer(PN532_SPI_DATAREAD);
+    return true;
+}
+
+bool Pn532SoftSpiTransport::read(uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) data[i] = transfer(0x00);
+    return true;
+}
+
+void Pn532SoftSpiTransport::endRead() {
+    digitalWrite(_ss, HIGH);
+}
+
+// ##### Hardware SPI #####
+Pn532SpiTransport::Pn532SpiTransport(SPIClass* spi, uint8_t sck, uint8_t miso, uint8_t mosi, uint8_t ss, uint32_t clock)
+    : _spi(spi), _sck(sck), _miso(miso), _mosi(mosi), _ss(ss), _clock(clock) {}
+
+bool Pn532SpiTransport::begin() {
+    pinMode(_ss, OUTPUT);
+    digitalWrite(_ss, HIGH);
+    _spi->begin(_sck, _miso, _mosi, -1);
+    wakeup();
+    return true;
+}
+
+void Pn532SpiTransport::wakeup() {
+    digitalWrite(_ss, LOW);
+    delay(2);
+    digitalWrite(_ss, HIGH);
+}
+
+bool Pn532SpiTransport::write(const uint8_t* data, uint16_t length) {
+    _spi->beginTransaction(SPISettings(_clock, LSBFIRST, SPI_MODE0));
+    digitalWrite(_ss, LOW);
+    _spi->transfer(PN532_SPI_DATAWRITE);
+    _spi->writeBytes(data, length);
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+    return true;
+}
+
+bool Pn532SpiTransport::isReady() {
+    _spi->beginTransaction(SPISettings(_clock, LSBFIRST, SPI_MODE0));
+    digitalWrite(_ss, LOW);
+    _spi->transfer(PN532_SPI_STATREAD);
+    uint8_t status = _spi->transfer(0x00);
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+    return (status & 0x01) != 0;
+}
+
+bool Pn532SpiTransport::beginRead(uint16_t maxLength) {
+    _spi->beginTransaction(SPISettings(_clock, LSBFIRST, SPI_MODE0));
+    digitalWrite(_ss, LOW);
+    _spi->transfer(PN532_SPI_DATAREAD);
+    return true;
+}
+
+bool Pn532SpiTransport::read(uint8_t* data, uint16_t length) {
+    memset(data, 0x00, length);
+    _spi->transfer(data, length);
+    return true;
+}
+
+void Pn532SpiTransport::endRead() {
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+}
+
+// ##### I2C #####
+// Every I2C read starts with the ready byte, so a frame has to be fetched in
+// one requestFrom() that is sized up front.
+Pn532I2cTransport::Pn532I2cTransport(TwoWire* wire, uint8_t sda, uint8_t scl, uint32_t clock)
+    : _wire(wire), _sda(sda), _scl(scl), _clock(clock) {}
+
+bool Pn532I2cTransport::begin() {
+    if (!_wire->begin(_sda, _scl, _clock)) return false;
+    wakeup();
+    return true;
+}
+
+void Pn532I2cTransport::wakeup() {
+    // Addressing the chip is enough to wake it from power down
+    _wire->beginTransmission(PN532_I2C_ADDRESS);
+    _wire->endTransmission();
+    delay(2);
+}
+
+bool Pn532I2cTransport::write(const uint8_t* data, uint16_t length) {
+    _wire->beginTransmission(PN532_I2C_ADDRESS);
+    _wire->write(data, length);
+    return _wire->endTransmission() == 0;
+}
+
+bool Pn532I2cTransport::isReady() {
+    if (_wire->requestFrom((uint8_t)PN532_I2C_ADDRESS, (size_t)1) != 1) return false;
+    return (_wire->read() & 0x01) != 0;
+}
+
+uint16_t Pn532I2cTransport::maxReadLength() const {
+    return I2C_BUFFER_LENGTH - 1;
+}
+
+bool Pn532I2cTransport::beginRead(uint16_t maxLength) {
+    size_t requested = min((size_t)maxLength, (size_t)maxReadLength()) + 1;
+    if (_wire->requestFrom((uint8_t)PN532_I2C_ADDRESS, requested) != requested) return false;
+    return (_wire->read() & 0x01) != 0;
+}
+
+bool Pn532I2cTransport::read(uint8_t* data, uint16_t length) {
+    if (_wire->available() < length) return false;
+    for (uint16_t i = 0; i < length; i++) data[i] = _wire->read();
+    return true;
+}
+
+// ##### HSU #####
+Pn532HsuTransport::Pn532HsuTransport(HardwareSerial* serial, uint8_t rx, uint8_t tx, uint32_t baud)
+    : _serial(serial), _rx(rx), _tx(tx), _baud(baud) {}
+
+bool Pn532HsuTransport::begin() {
+    _serial->begin(_baud, SERIAL_8N1, _rx, _tx);
+    _serial->setTimeout(PN532_HSU_READ_TIMEOUT_MS);
+    wakeup();
+    return true;
+}
+
+// Long preamble to wake the chip, the next command has to follow right away
+void Pn532HsuTransport::wakeup() {
+    const uint8_t wakeupSequence[] = { 0x55, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                       0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    _serial->write(wakeupSequence, sizeof(wakeupSequence));
+    while (_serial->available()) _serial->read();
+}
+
+bool Pn532HsuTransport::write(const uint8_t* data, uint16_t length) {
+    // Drop stale bytes so the next read starts at a frame boundary
+    while (_serial->available()) _serial->read();
+    return _serial->write(data, length) == length;
+}
+
+bool Pn532HsuTransport::isReady() {
+    return _serial->available() > 0;
+}
+
+bool Pn532HsuTransport::beginRead(uint16_t maxLength) {
+    return true;
+}
+
+bool Pn532HsuTransport::read(uint8_t* data, uint16_t length) {
+    return _serial->readBytes(data, length) == length;
+}
+
+Pn532Transport* createPn532Transport(const Pn532Pins& pins) {
+#ifdef ENABLE_PN532_SIMULATOR
+    // Simulator builds never touch the bus
+    return new Pn532SimTransport();
+#endif
+    switch (pins.bus) {
+        case PN532_BUS_SPI:
+            return new Pn532SpiTransport(&SPI, pins.sck, pins.miso, pins.mosi, pins.ss, pins.clock);
+        case PN532_BUS_I2C:
+            // Keep the display on Wire where a second controller exists
+#if defined(SOC_I2C_NUM) && SOC_I2C_NUM > 1
+            return new Pn532I2cTransport(&Wire1, pins.mosi, pins.sck, pins.clock);
+#else
+            return new Pn532I2cTransport(&Wire, pins.mosi, pins.sck, pins.clock);
+#endif
+        case PN532_BUS_HSU:
+            return new Pn532HsuTransport(&Serial1, pins.miso, pins.mosi, pins.clock);
+        case PN532_BUS_SOFT_SPI:
+        default:
+            return new Pn532SoftSpiTransport(pins.sck, pins.miso, pins.mosi, pins.ss);
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef PN532TRANSPORT_H
+#define PN532TRANSPORT_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include "config.h"
+
+#define PN532_I2C_ADDRESS       0x24
+#define PN532_SPI_STATREAD      0x02
+#define PN532_SPI_DATAWRITE     0x01
+#define PN532_SPI_DATAREAD      0x03
+
+// Byte pipe between the PN532 command layer and the chip. A response is read
+// in one session (beginRead/read/endRead) because SPI has to keep CS low for
+// the whole frame and I2C has to fetch it in a single transfer.
+class Pn532Transport {
+public:
+    virtual ~Pn532Transport() {}
+    virtual bool begin() = 0;
+    virtual void wakeup() = 0;
+    virtual bool write(const uint8_t* data, uint16_t length) = 0;  // one complete frame
+    virtual bool isReady() = 0;                                     // response pending
+    virtual bool beginRead(uint16_t maxLength) = 0;
+    virtual bool read(uint8_t* data, uint16_t length) = 0;
+    virtual void endRead() {}
+    virtual uint16_t maxReadLength() const { return 262; }
+    virtual const char* name() const = 0;
+    virtual uint32_t clock() const = 0;
+};
+
+// Bit-banged SPI on any GPIOs, LSB first, mode 0
+class Pn532SoftSpiTransport : public Pn532Transport {
+public:
+    Pn532SoftSpiTransport(uint8_t sck, uint8_t miso, uint8_t mosi, uint8_t ss);
+    bool begin() override;
+    void wakeup() override;
+    bool write(const uint8_t* data, uint16_t length) override;
+    bool isReady() override;
+    bool beginRead(uint16_t maxLength) override;
+    bool read(uint8_t* data, uint16_t length) override;
+    void endRead() override;
+    const char* name() const override { return "softspi"; }
+    uint32_t clock() const override { return 0; }
+
+private:
+    uint8_t transfer(uint8_t out);
+    uint8_t _sck, _miso, _mosi, _ss;
+};
+
+// Hardware SPI peripheral routed to the configured pins
+class Pn532SpiTransport : public Pn532Transport {
+public:
+    Pn532SpiTransport(SPIClass* spi, uint8_t sck, uint8_t miso, uint8_t mosi, uint8_t ss, uint32_t clock);
+    bool begin() override;
+    void wakeup() override;
+    bool write(const uint8_t* data, uint16_t length) override;
+    bool isReady() override;
+    bool beginRead(uint16_t maxLength) override;
+    bool read(uint8_t* data, uint16_t length) override;
+    void endRead() override;
+    const char* name() const override { return "spi"; }
+    uint32_t clock() const override { return _clock; }
+
+private:
+    SPIClass* _spi;
+    uint8_t _sck, _miso, _mosi, _ss;
+    uint32_t _clock;
+};
+
+class Pn532I2cTransport : public Pn532Transport {
+public:
+    Pn532I2cTransport(TwoWire* wire, uint8_t sda, uint8_t scl, uint32_t clock);
+    bool begin() override;
+    void wakeup() override;
+    bool write(const uint8_t* data, uint16_t length) override;
+    bool isReady() override;
+    bool beginRead(uint16_t maxLength) override;
+    bool read(uint8_t* data, uint16_t length) override;
+    uint16_t maxReadLength() const override;
+    const char* name() const override { return "i2c"; }
+    uint32_t clock() const override { return _clock; }
+
+private:
+    TwoWire* _wire;
+    uint8_t _sda, _scl;
+    uint32_t _clock;
+};
+
+// HSU (UART) at the PN532 power-on baud rate
+class Pn532HsuTransport : public Pn532Transport {
+public:
+    Pn532HsuTransport(HardwareSerial* serial, uint8_t rx, uint8_t tx, uint32_t baud);
+    bool begin() override;
+    void wakeup() override;
+    bool write(const uint8_t* data, uint16_t length) override;
+    bool isReady() override;
+    bool beginRead(uint16_t maxLength) override;
+    bool read(uint8_t* data, uint16_t length) override;
+    const char* name() const override { return "hsu"; }
+    uint32_t clock() const override { return _baud; }
+
+private:
+    HardwareSerial* _serial;
+    uint8_t _rx, _tx;
+    uint32_t _baud;
+};
+
+// Transport for the bus selected in the pin configuration
+Pn532Transport* createPn532Transport(const Pn532Pins& pins);
+
+#endif
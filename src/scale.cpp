@@ -8,7 +8,6 @@
 TaskHandle_t ScaleTask = NULL;
 
 int16_t weight = 0;
-uint8_t weightCounterToApi = 0;
 uint8_t scale_tare_counter = 0;
 bool scaleTareRequest = false;
 uint8_t pauseMainTask = 0;
@@ -29,6 +28,7 @@ uint8_t tareScale() { return 1; }
 #else
 
 #include "nfc.h"
+#include "events.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "HX711.h"
@@ -47,6 +47,8 @@ int16_t weight = 0;
 #define DISPLAY_THRESHOLD 0.3f         // Reduced from 0.5 to 0.3g for more responsive display
 #define API_THRESHOLD 1.5f             // Reduced from 2.0 to 1.5g for faster API actions
 #define MEASUREMENT_INTERVAL_MS 30     // Reduced from 50ms to 30ms for faster updates
+#define STABLE_TIME_MS 3000            // Time a weight has to hold before it is sent to Spoolman
+#define STABLE_MIN_WEIGHT 5            // Empty scale is never reported as stable
 
 float weightBuffer[MOVING_AVERAGE_SIZE];
 uint8_t bufferIndex = 0;
@@ -55,8 +57,10 @@ float filteredWeight = 0.0f;
 int16_t lastDisplayedWeight = 0;
 int16_t lastStableWeight = 0;        // For API/action triggering
 unsigned long lastMeasurementTime = 0;
+int16_t heldWeight = 0;              // Weight currently being timed for EVENT_WEIGHT_STABLE
+unsigned long heldSince = 0;
+bool heldWeightReported = false;
 
-uint8_t weightCounterToApi = 0;
 uint8_t scale_tare_counter = 0;
 bool scaleTareRequest = false;
 uint8_t pauseMainTask = 0;
@@ -151,6 +155,26 @@ int16_t getFilteredDisplayWeight() {
   return lastDisplayedWeight;
 }
 
+/**
+ * Post weight events for the main loop: every change of the stabilized
+ * weight, and once per weight that held for STABLE_TIME_MS
+ */
+static void reportWeight(int16_t newWeight, unsigned long currentTime) {
+  if (newWeight != weight) {
+    weight = newWeight;
+    postWeightEvent(EVENT_WEIGHT_CHANGED, weight);
+  }
+
+  if (abs(weight - heldWeight) > SCALE_STABLE_TOLERANCE) {
+    heldWeight = weight;
+    heldSince = currentTime;
+    heldWeightReported = false;
+  } else if (!heldWeightReported && weight > STABLE_MIN_WEIGHT && currentTime - heldSince >= STABLE_TIME_MS) {
+    heldWeightReported = true;
+    postWeightEvent(EVENT_WEIGHT_STABLE, weight);
+  }
+}
+
 // ##### Scale functions #####
 uint8_t setAutoTare(bool autoTareValue) {
   Serial.print("Set AutoTare to ");
@@ -203,7 +227,7 @@ void scale_loop(void * parameter) {
           oledShowWeight(0);
           scaleTareRequest = false;
           scale_tare_counter = 0;
-          weight = 0; // Reset global weight variable after tare
+          reportWeight(0, millis()); // Reset global weight variable after tare
         }
 
         // Get raw weight reading
@@ -213,9 +237,7 @@ void scale_loop(void * parameter) {
         int16_t stabilizedWeight = processWeightReading(rawWeight);
         
         // Update global weight variable only if it changed significantly (for API actions)
-        if (stabilizedWeight != weight) {
-          weight = stabilizedWeight;
-        }
+        reportWeight(stabilizedWeight, currentTime);
         
         // Check if scale is correctly zeroed
         // Deviation of 2g is ignored
@@ -8,6 +8,9 @@
 extern HX711 scale;
 #endif
 
+// Deviation in g still counted as the same weight for EVENT_WEIGHT_STABLE
+#define SCALE_STABLE_TOLERANCE 2
+
 uint8_t setAutoTare(bool autoTareValue);
 void start_scale(bool touchSensorConnected);
 uint8_t calibrate_scale();
@@ -21,7 +24,6 @@ int16_t processWeightReading(float rawWeight);
 int16_t getFilteredDisplayWeight();
 
 extern int16_t weight;
-extern uint8_t weightCounterToApi;
 extern uint8_t scale_tare_counter;
 extern bool scaleTareRequest;
 extern uint8_t pauseMainTask;
@@ -0,0 +1,134 @@
+#include "scantrace.h"
+#include <esp_timer.h>
+
+#define SCAN_TRACE_HISTORY  32
+
+struct ScanTrace {
+    int64_t startUs;
+    int64_t markUs[SCAN_PHASE_COUNT];   // 0 = phase not reached
+    bool success;
+};
+
+static const char* const scanPhaseNames[SCAN_PHASE_COUNT] = { "stabilize", "read", "decode", "weight", "api" };
+
+// The RFID task, the main loop and the API task all touch the trace
+static portMUX_TYPE scanTraceMux = portMUX_INITIALIZER_UNLOCKED;
+static ScanTrace activeTrace = {};
+static bool traceActive = false;
+static ScanTrace history[SCAN_TRACE_HISTORY];
+static uint8_t historyNext = 0;
+static uint8_t historyCount = 0;
+
+void scanTraceBegin() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&scanTraceMux);
+    activeTrace = {};
+    activeTrace.startUs = now;
+    traceActive = true;
+    portEXIT_CRITICAL(&scanTraceMux);
+}
+
+void scanTraceMark(ScanPhase phase) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&scanTraceMux);
+    if (traceActive && activeTrace.markUs[phase] == 0) {
+        activeTrace.markUs[phase] = now;
+    }
+    portEXIT_CRITICAL(&scanTraceMux);
+}
+
+void scanTraceFinish(bool success) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&scanTraceMux);
+    // Weight updates from the web interface have no trace
+    if (traceActive && activeTrace.markUs[SCAN_PHASE_WEIGHT] != 0) {
+        activeTrace.markUs[SCAN_PHASE_API] = now;
+        activeTrace.success = success;
+        history[historyNext] = activeTrace;
+        historyNext = (historyNext + 1) % SCAN_TRACE_HISTORY;
+        if (historyCount < SCAN_TRACE_HISTORY) historyCount++;
+        traceActive = false;
+    }
+    portEXIT_CRITICAL(&scanTraceMux);
+}
+
+void scanTraceAbort() {
+    portENTER_CRITICAL(&scanTraceMux);
+    if (activeTrace.markUs[SCAN_PHASE_WEIGHT] == 0) {
+        traceActive = false;
+    }
+    portEXIT_CRITICAL(&scanTraceMux);
+}
+
+// Nearest-rank percentile of sorted values
+static uint32_t percentile(const uint32_t* sorted, uint8_t count, uint8_t p) {
+    uint16_t rank = (count * p + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void sortValues(uint32_t* values, uint8_t count) {
+    for (uint8_t i = 1; i < count; i++) {
+        uint32_t value = values[i];
+        int8_t j = i - 1;
+        while (j >= 0 && values[j] > value) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = value;
+    }
+}
+
+static void percentilesToJson(JsonObject out, uint32_t* values, uint8_t count) {
+    out["count"] = count;
+    if (count == 0) return;
+    sortValues(values, count);
+    out["p50"] = percentile(values, count, 50);
+    out["p95"] = percentile(values, count, 95);
+    out["p99"] = percentile(values, count, 99);
+    out["max"] = values[count - 1];
+}
+
+void scanTraceMetricsToJson(JsonObject metrics) {
+    ScanTrace traces[SCAN_TRACE_HISTORY];
+    uint8_t count;
+    portENTER_CRITICAL(&scanTraceMux);
+    count = historyCount;
+    memcpy(traces, history, sizeof(traces));
+    portEXIT_CRITICAL(&scanTraceMux);
+
+    uint32_t values[SCAN_TRACE_HISTORY];
+    uint8_t failed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!traces[i].success) failed++;
+    }
+    metrics["traces"] = count;
+    metrics["failed"] = failed;
+    metrics["unit"] = "us";
+
+    // A phase lasts from the previous phase reached (or detection) to its mark.
+    // Phases the trace skipped, e.g. decode for cached tags, are not counted.
+    JsonObject phases = metrics["phases"].to<JsonObject>();
+    for (uint8_t phase = 0; phase < SCAN_PHASE_COUNT; phase++) {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            const ScanTrace& trace = traces[i];
+            if (!trace.success || trace.markUs[phase] == 0) continue;
+            int64_t from = trace.startUs;
+            for (int8_t prev = phase - 1; prev >= 0; prev--) {
+                if (trace.markUs[prev] != 0) {
+                    from = trace.markUs[prev];
+                    break;
+                }
+            }
+            values[n++] = (uint32_t)(trace.markUs[phase] - from);
+        }
+        percentilesToJson(phases[scanPhaseNames[phase]].to<JsonObject>(), values, n);
+    }
+
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!traces[i].success) continue;
+        values[n++] = (uint32_t)(traces[i].markUs[SCAN_PHASE_API] - traces[i].startUs);
+    }
+    percentilesToJson(metrics["total"].to<JsonObject>(), values, n);
+}
@@ -0,0 +1,26 @@
+#ifndef SCANTRACE_H
+#define SCANTRACE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Latency of the scan pipeline, from a spool being placed on the reader to
+// Spoolman having its weight. One trace is in flight at a time; each phase
+// ends with scanTraceMark(). Completed traces go into a ring buffer that
+// /api/v1/metrics/scan summarises as p50/p95/p99 per phase.
+typedef enum {
+    SCAN_PHASE_STABILIZE,   // tag detected -> settle delay over
+    SCAN_PHASE_READ,        // -> sm_id known (fast path, cache or full read)
+    SCAN_PHASE_DECODE,      // -> NDEF decoded, spool handed to the main loop
+    SCAN_PHASE_WEIGHT,      // -> weight stable, Spoolman update started
+    SCAN_PHASE_API,         // -> Spoolman update finished, retries included
+    SCAN_PHASE_COUNT
+} ScanPhase;
+
+void scanTraceBegin();
+void scanTraceMark(ScanPhase phase);
+void scanTraceFinish(bool success);     // only once SCAN_PHASE_WEIGHT was marked
+void scanTraceAbort();                  // keeps a trace whose Spoolman update is running
+void scanTraceMetricsToJson(JsonObject metrics);
+
+#endif
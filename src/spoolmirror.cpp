@@ -0,0 +1,463 @@
+#include "spoolmirror.h"
+#include "api.h"
+#include "config.h"
+#include "httppool.h"
+#include <LittleFS.h>
+#include <esp_timer.h>
+
+#define SPOOL_MIRROR_FILE           "/spoolmirror.bin"
+#define SPOOL_MIRROR_TMP_FILE       "/spoolmirror.tmp"
+#define SPOOL_MIRROR_MAGIC          0x4D4C5053UL    // "SPLM"
+#define SPOOL_MIRROR_VERSION        1
+#define SPOOL_MIRROR_PAGE           10
+#define SPOOL_MIRROR_DELTA_PAGES    3               // further changes wait for the full sync
+
+struct SpoolMirrorHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t urlHash;           // Spoolman instance the records came from
+    char registered[32];        // newest timestamps seen, ISO 8601 compares as text
+    char lastUsed[32];
+};
+
+// Sorted by spool ID for binary search; slot is the record position in the file
+struct SpoolMirrorIndex {
+    uint16_t spoolId;
+    uint16_t slot;
+};
+
+struct SpoolMirrorStats {
+    uint32_t lookups;
+    uint32_t hits;
+    uint64_t lookupUsTotal;
+    uint32_t fullSyncs;
+    uint32_t deltaSyncs;
+    uint32_t syncFailures;
+    unsigned long lastSyncMs;
+};
+
+static SemaphoreHandle_t mirrorMutex = NULL;    // guards file, header and index
+static File mirrorFile;
+static SpoolMirrorHeader header = {};
+static SpoolMirrorIndex mirrorIndex[SPOOL_MIRROR_MAX];
+static SpoolMirrorStats stats = {};
+static TaskHandle_t mirrorTaskHandle = NULL;
+static volatile bool resetRequested = false;
+
+static uint32_t urlHash(const String& url) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < url.length(); i++) {
+        hash ^= (uint8_t)url[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+// Spoolman keeps extra fields JSON encoded ("\"153\""), the quotes are dropped
+static void copyField(char* dest, size_t size, const char* src) {
+    size_t n = 0;
+    for (; src && *src && n + 1 < size; src++) {
+        if (*src != '"') dest[n++] = *src;
+    }
+    dest[n] = '\0';
+}
+
+static int findIndex(uint16_t spoolId) {
+    int low = 0;
+    int high = (int)header.count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (mirrorIndex[mid].spoolId == spoolId) return mid;
+        if (mirrorIndex[mid].spoolId < spoolId) low = mid + 1;
+        else high = mid - 1;
+    }
+    return -(low + 1);
+}
+
+static size_t slotOffset(uint16_t slot) {
+    return sizeof(SpoolMirrorHeader) + (size_t)slot * sizeof(SpoolMirrorEntry);
+}
+
+static bool readSlot(uint16_t slot, SpoolMirrorEntry& entry) {
+    return mirrorFile.seek(slotOffset(slot)) &&
+           mirrorFile.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+}
+
+static bool writeSlot(File& file, uint16_t slot, const SpoolMirrorEntry& entry) {
+    return file.seek(slotOffset(slot)) &&
+           file.write((const uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+}
+
+static bool writeHeader(File& file, const SpoolMirrorHeader& fileHeader) {
+    return file.seek(0) &&
+           file.write((const uint8_t*)&fileHeader, sizeof(fileHeader)) == sizeof(fileHeader);
+}
+
+static void clearMirrorLocked() {
+    if (mirrorFile) mirrorFile.close();
+    header = {};
+    header.magic = SPOOL_MIRROR_MAGIC;
+    header.version = SPOOL_MIRROR_VERSION;
+    header.urlHash = urlHash(spoolmanUrl);
+
+    File file = LittleFS.open(SPOOL_MIRROR_FILE, "w");
+    if (file) {
+        writeHeader(file, header);
+        file.close();
+    }
+    mirrorFile = LittleFS.open(SPOOL_MIRROR_FILE, "r+");
+}
+
+// Records of the previous boot, unless they belong to another Spoolman
+static void loadMirrorLocked() {
+    mirrorFile = LittleFS.open(SPOOL_MIRROR_FILE, "r+");
+    if (!mirrorFile ||
+        mirrorFile.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != SPOOL_MIRROR_MAGIC || header.version != SPOOL_MIRROR_VERSION ||
+        header.urlHash != urlHash(spoolmanUrl) || header.count > SPOOL_MIRROR_MAX) {
+        clearMirrorLocked();
+        return;
+    }
+
+    uint16_t count = header.count;
+    header.count = 0;
+    SpoolMirrorEntry entry;
+    for (uint16_t slot = 0; slot < count && readSlot(slot, entry); slot++) {
+        int pos = -(findIndex(entry.spoolId) + 1);
+        if (pos < 0) continue;
+        memmove(&mirrorIndex[pos + 1], &mirrorIndex[pos], (header.count - pos) * sizeof(SpoolMirrorIndex));
+        mirrorIndex[pos] = { entry.spoolId, slot };
+        header.count++;
+    }
+    Serial.printf("Spool mirror: %u spools loaded\n", header.count);
+}
+
+static bool storeLocked(const SpoolMirrorEntry& entry) {
+    int pos = findIndex(entry.spoolId);
+    if (pos >= 0) {
+        return writeSlot(mirrorFile, mirrorIndex[pos].slot, entry);
+    }
+    if (header.count >= SPOOL_MIRROR_MAX) return false;
+
+    // New spools are appended, the index keeps the order
+    uint16_t slot = header.count;
+    if (!writeSlot(mirrorFile, slot, entry)) return false;
+    pos = -(pos + 1);
+    memmove(&mirrorIndex[pos + 1], &mirrorIndex[pos], (header.count - pos) * sizeof(SpoolMirrorIndex));
+    mirrorIndex[pos] = { entry.spoolId, slot };
+    header.count++;
+    return writeHeader(mirrorFile, header);
+}
+
+static void parseFilament(JsonVariantConst filament, SpoolMirrorEntry& entry) {
+    entry.filamentId = filament["id"] | 0;
+    entry.vendorId = filament["vendor"]["id"] | 0;
+    copyField(entry.material, sizeof(entry.material), filament["material"] | "");
+    copyField(entry.brand, sizeof(entry.brand), filament["vendor"]["name"] | "");
+
+    copyField(entry.color, sizeof(entry.color), filament["color_hex"] | "");
+    for (char* c = entry.color; *c; c++) *c = toupper(*c);
+
+    entry.nozzleTempMin = 0;
+    entry.nozzleTempMax = 0;
+    const char* temps = filament["extra"]["nozzle_temperature"] | "";
+    const char* comma = strchr(temps, ',');
+    if (comma) {
+        entry.nozzleTempMin = atoi(temps[0] == '[' ? temps + 1 : temps);
+        entry.nozzleTempMax = atoi(comma + 1);
+    }
+
+    copyField(entry.trayInfoIdx, sizeof(entry.trayInfoIdx), filament["extra"]["bambu_idx"] | "");
+    copyField(entry.caliIdx, sizeof(entry.caliIdx), filament["extra"]["bambu_cali_id"] | "");
+    copyField(entry.settingId, sizeof(entry.settingId), filament["extra"]["bambu_setting_id"] | "");
+}
+
+void spoolMirrorFilamentFilter(JsonObject filter) {
+    filter["id"] = true;
+    filter["material"] = true;
+    filter["color_hex"] = true;
+    filter["vendor"]["id"] = true;
+    filter["vendor"]["name"] = true;
+    filter["extra"]["nozzle_temperature"] = true;
+    filter["extra"]["bambu_idx"] = true;
+    filter["extra"]["bambu_cali_id"] = true;
+    filter["extra"]["bambu_setting_id"] = true;
+}
+
+void spoolMirrorSpoolFilter(JsonObject filter) {
+    filter["id"] = true;
+    filter["remaining_weight"] = true;
+    spoolMirrorFilamentFilter(filter["filament"].to<JsonObject>());
+}
+
+bool spoolMirrorParseSpool(JsonVariantConst spool, SpoolMirrorEntry& entry) {
+    entry = {};
+    entry.spoolId = spool["id"] | 0;
+    if (entry.spoolId == 0) return false;
+    entry.remainingWeight = (uint16_t)(spool["remaining_weight"] | 0.0f);
+    parseFilament(spool["filament"], entry);
+    return true;
+}
+
+// Same fields as fetchSingleSpoolInfo always returned. Strings are copied:
+// a char array would otherwise be kept by pointer like a literal.
+void spoolMirrorEntryToJson(const SpoolMirrorEntry& entry, JsonDocument& doc) {
+    doc["color"] = String(entry.color);
+    doc["type"] = String(entry.material);
+    doc["nozzle_temp_min"] = entry.nozzleTempMin;
+    doc["nozzle_temp_max"] = entry.nozzleTempMax;
+    doc["brand"] = String(entry.brand);
+    doc["tray_info_idx"] = String(entry.trayInfoIdx);
+    doc["cali_idx"] = String(entry.caliIdx);
+    doc["bambu_setting_id"] = String(entry.settingId);
+}
+
+bool spoolMirrorFind(uint16_t spoolId, SpoolMirrorEntry& entry) {
+    if (mirrorMutex == NULL) return false;
+
+    int64_t start = esp_timer_get_time();
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    int pos = findIndex(spoolId);
+    bool found = pos >= 0 && readSlot(mirrorIndex[pos].slot, entry);
+    stats.lookups++;
+    if (found) stats.hits++;
+    stats.lookupUsTotal += esp_timer_get_time() - start;
+    xSemaphoreGive(mirrorMutex);
+    return found;
+}
+
+void spoolMirrorStore(const SpoolMirrorEntry& entry) {
+    if (mirrorMutex == NULL) return;
+
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    storeLocked(entry);
+    mirrorFile.flush();
+    xSemaphoreGive(mirrorMutex);
+}
+
+void spoolMirrorStoreSpool(JsonVariantConst spool) {
+    SpoolMirrorEntry entry;
+    if (spoolMirrorParseSpool(spool, entry)) spoolMirrorStore(entry);
+}
+
+// A filament changed, e.g. its Bambu settings: update every spool using it
+void spoolMirrorStoreFilament(JsonVariantConst filament) {
+    uint16_t filamentId = filament["id"] | 0;
+    if (mirrorMutex == NULL || filamentId == 0) return;
+
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    SpoolMirrorEntry entry;
+    for (uint16_t slot = 0; slot < header.count; slot++) {
+        if (!readSlot(slot, entry) || entry.filamentId != filamentId) continue;
+        parseFilament(filament, entry);
+        writeSlot(mirrorFile, slot, entry);
+    }
+    mirrorFile.flush();
+    xSemaphoreGive(mirrorMutex);
+}
+
+void spoolMirrorReset() {
+    resetRequested = true;
+    if (mirrorTaskHandle != NULL) xTaskNotifyGive(mirrorTaskHandle);
+}
+
+// One page of spools, only the fields the mirror keeps
+static int fetchSpoolPage(const String& query, uint16_t offset, JsonDocument& doc) {
+    String url = spoolmanUrl + apiUrl + "/spool?" + query +
+                 "&limit=" + String(SPOOL_MIRROR_PAGE) + "&offset=" + String(offset);
+
+    JsonDocument filter;
+    JsonObject spool = filter.add<JsonObject>();
+    spoolMirrorSpoolFilter(spool);
+    spool["registered"] = true;
+    spool["last_used"] = true;
+
+    HttpPoolLease lease(url);
+    int httpCode = lease.send("GET");
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("Spool mirror: fetching %s failed, HTTP code %d\n", url.c_str(), httpCode);
+        return -1;
+    }
+    DeserializationError error = lease.readJson(doc, &filter);
+    if (error || !doc.is<JsonArray>()) {
+        Serial.print("Spool mirror: error parsing spools: ");
+        Serial.println(error.c_str());
+        return -1;
+    }
+    return doc.size();
+}
+
+static void keepNewest(char* newest, size_t size, const char* timestamp) {
+    if (timestamp && strcmp(timestamp, newest) > 0) strlcpy(newest, timestamp, size);
+}
+
+// Builds the mirror again in a temporary file and swaps it in; lookups keep
+// using the old one meanwhile
+static bool fullSync() {
+    SpoolMirrorHeader newHeader = {};
+    newHeader.magic = SPOOL_MIRROR_MAGIC;
+    newHeader.version = SPOOL_MIRROR_VERSION;
+    newHeader.urlHash = urlHash(spoolmanUrl);
+
+    SpoolMirrorIndex* newIndex = new SpoolMirrorIndex[SPOOL_MIRROR_MAX];
+    File file = LittleFS.open(SPOOL_MIRROR_TMP_FILE, "w");
+    if (newIndex == nullptr || !file) {
+        delete[] newIndex;
+        return false;
+    }
+
+    bool ok = writeHeader(file, newHeader);
+    uint16_t offset = 0;
+    while (ok && newHeader.count < SPOOL_MIRROR_MAX) {
+        JsonDocument doc;
+        int count = fetchSpoolPage("sort=id:asc", offset, doc);
+        if (count < 0) {
+            ok = false;
+            break;
+        }
+
+        for (JsonVariantConst spool : doc.as<JsonArrayConst>()) {
+            SpoolMirrorEntry entry;
+            if (newHeader.count >= SPOOL_MIRROR_MAX || !spoolMirrorParseSpool(spool, entry)) continue;
+            if (!writeSlot(file, newHeader.count, entry)) {
+                ok = false;
+                break;
+            }
+            newIndex[newHeader.count] = { entry.spoolId, newHeader.count };
+            newHeader.count++;
+            keepNewest(newHeader.registered, sizeof(newHeader.registered), spool["registered"].as<const char*>());
+            keepNewest(newHeader.lastUsed, sizeof(newHeader.lastUsed), spool["last_used"].as<const char*>());
+        }
+        if (count < SPOOL_MIRROR_PAGE) break;
+        offset += count;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (newHeader.count >= SPOOL_MIRROR_MAX) {
+        Serial.printf("Spool mirror: more than %d spools, the rest is fetched on demand\n", SPOOL_MIRROR_MAX);
+    }
+
+    ok = ok && writeHeader(file, newHeader);
+    file.close();
+    if (!ok || resetRequested) {
+        LittleFS.remove(SPOOL_MIRROR_TMP_FILE);
+        delete[] newIndex;
+        return false;
+    }
+
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    mirrorFile.close();
+    LittleFS.remove(SPOOL_MIRROR_FILE);
+    LittleFS.rename(SPOOL_MIRROR_TMP_FILE, SPOOL_MIRROR_FILE);
+    mirrorFile = LittleFS.open(SPOOL_MIRROR_FILE, "r+");
+    header = newHeader;
+    // Fetched by ascending ID, so already sorted
+    memcpy(mirrorIndex, newIndex, header.count * sizeof(SpoolMirrorIndex));
+    stats.fullSyncs++;
+    xSemaphoreGive(mirrorMutex);
+
+    delete[] newIndex;
+    Serial.printf("Spool mirror: %u spools synced\n", newHeader.count);
+    return true;
+}
+
+// Spools whose timestamp field is newer than the newest one seen so far
+static bool deltaSync(const char* field, char* watermark, size_t size) {
+    char newest[sizeof(header.registered)];
+    strlcpy(newest, watermark, sizeof(newest));
+
+    String query = String("sort=") + field + ":desc";
+    bool done = false;
+    for (uint8_t page = 0; page < SPOOL_MIRROR_DELTA_PAGES && !done; page++) {
+        JsonDocument doc;
+        int count = fetchSpoolPage(query, page * SPOOL_MIRROR_PAGE, doc);
+        if (count < 0) return false;
+
+        xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+        for (JsonVariantConst spool : doc.as<JsonArrayConst>()) {
+            const char* timestamp = spool[field] | "";
+            // Spools never used sort first or last depending on the database
+            if (timestamp[0] == '\0') continue;
+            if (strcmp(timestamp, watermark) <= 0) {
+                done = true;
+                break;
+            }
+            SpoolMirrorEntry entry;
+            if (spoolMirrorParseSpool(spool, entry)) storeLocked(entry);
+            keepNewest(newest, sizeof(newest), timestamp);
+        }
+        xSemaphoreGive(mirrorMutex);
+        if (count < SPOOL_MIRROR_PAGE) done = true;
+    }
+
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    strlcpy(watermark, newest, size);
+    writeHeader(mirrorFile, header);
+    mirrorFile.flush();
+    xSemaphoreGive(mirrorMutex);
+    return true;
+}
+
+static void spoolMirrorTask(void *parameter) {
+    bool fullSyncDue = true;
+    unsigned long lastFullSync = 0;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(fullSyncDue ? SPOOL_MIRROR_RETRY_MS : SPOOL_MIRROR_DELTA_SYNC_MS));
+
+        if (resetRequested) {
+            resetRequested = false;
+            xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+            clearMirrorLocked();
+            xSemaphoreGive(mirrorMutex);
+            fullSyncDue = true;
+        }
+        if (!spoolmanConnected || spoolmanUrl == "") continue;
+
+        bool ok;
+        if (fullSyncDue || millis() - lastFullSync >= SPOOL_MIRROR_FULL_SYNC_MS) {
+            ok = fullSync();
+            if (ok) {
+                fullSyncDue = false;
+                lastFullSync = millis();
+            }
+        } else {
+            ok = deltaSync("registered", header.registered, sizeof(header.registered)) &&
+                 deltaSync("last_used", header.lastUsed, sizeof(header.lastUsed));
+            if (ok) stats.deltaSyncs++;
+        }
+
+        if (ok) stats.lastSyncMs = millis();
+        else stats.syncFailures++;
+    }
+}
+
+void initSpoolMirror() {
+    if (mirrorMutex != NULL) return;
+    mirrorMutex = xSemaphoreCreateMutex();
+
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    loadMirrorLocked();
+    xSemaphoreGive(mirrorMutex);
+
+    xTaskCreate(spoolMirrorTask, "SpoolMirrorTask", 6144, NULL, 0, &mirrorTaskHandle);
+}
+
+void spoolMirrorStatsToJson(JsonObject out) {
+    if (mirrorMutex == NULL) return;
+
+    xSemaphoreTake(mirrorMutex, portMAX_DELAY);
+    SpoolMirrorStats copy = stats;
+    uint16_t count = header.count;
+    xSemaphoreGive(mirrorMutex);
+
+    out["spools"] = count;
+    out["capacity"] = SPOOL_MIRROR_MAX;
+    out["lookups"] = copy.lookups;
+    out["hits"] = copy.hits;
+    out["lookupAvgUs"] = copy.lookups > 0 ? (uint32_t)(copy.lookupUsTotal / copy.lookups) : 0;
+    out["fullSyncs"] = copy.fullSyncs;
+    out["deltaSyncs"] = copy.deltaSyncs;
+    out["syncFailures"] = copy.syncFailures;
+    out["lastSyncAgeMs"] = copy.lastSyncMs > 0 ? millis() - copy.lastSyncMs : 0;
+}
@@ -0,0 +1,46 @@
+#ifndef SPOOLMIRROR_H
+#define SPOOLMIRROR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Local copy of the Spoolman spools, with the filament and vendor fields the
+// device uses folded into each record. A full paginated fetch fills it after
+// boot; new and recently used spools are fetched every minute by their
+// registered/last_used timestamps, and a full fetch every few hours drops
+// deleted spools. Successful Spoolman writes update it directly.
+#define SPOOL_MIRROR_MAX                256
+#define SPOOL_MIRROR_DELTA_SYNC_MS      60000UL
+#define SPOOL_MIRROR_FULL_SYNC_MS       (6UL * 60UL * 60UL * 1000UL)
+#define SPOOL_MIRROR_RETRY_MS           5000UL
+
+struct SpoolMirrorEntry {
+    uint16_t spoolId;
+    uint16_t filamentId;
+    uint16_t vendorId;
+    uint16_t remainingWeight;
+    int16_t nozzleTempMin;
+    int16_t nozzleTempMax;
+    char color[8];              // RRGGBB, upper case
+    char material[12];
+    char brand[24];
+    char trayInfoIdx[12];       // Bambu extras, quotes stripped
+    char caliIdx[8];
+    char settingId[20];
+};
+
+void initSpoolMirror();
+void spoolMirrorReset();        // Spoolman URL changed
+bool spoolMirrorFind(uint16_t spoolId, SpoolMirrorEntry& entry);
+bool spoolMirrorParseSpool(JsonVariantConst spool, SpoolMirrorEntry& entry);
+void spoolMirrorEntryToJson(const SpoolMirrorEntry& entry, JsonDocument& doc);
+void spoolMirrorStore(const SpoolMirrorEntry& entry);
+void spoolMirrorStoreSpool(JsonVariantConst spool);
+void spoolMirrorStoreFilament(JsonVariantConst filament);
+void spoolMirrorStatsToJson(JsonObject stats);
+
+// Deserialization filters selecting what the parsers above read
+void spoolMirrorSpoolFilter(JsonObject filter);
+void spoolMirrorFilamentFilter(JsonObject filter);
+
+#endif
@@ -0,0 +1,138 @@
+#include "tagcache.h"
+#include "compacttag.h"
+
+#define TAG_CACHE_SIZE          8
+#define TAG_CACHE_BLOCK_BYTES   16
+
+static TagCacheEntry tagCache[TAG_CACHE_SIZE];
+
+// Page of the 16-byte block that starts with the record payload, 0 if the
+// first block already holds sm_id (compact tags keep it on page 7). Layouts
+// that cannot be followed within the first block fall back to page 8.
+uint8_t tagCacheIdentityPage(const uint8_t* firstBlock) {
+    // Skip NULL, lock control and memory control TLVs
+    uint16_t pos = 0;
+    while (pos < TAG_CACHE_BLOCK_BYTES && firstBlock[pos] != 0x03) {
+        if (firstBlock[pos] == 0x00) pos++;
+        else if ((firstBlock[pos] == 0x01 || firstBlock[pos] == 0x02) && pos + 1 < TAG_CACHE_BLOCK_BYTES) pos += 2 + firstBlock[pos + 1];
+        else return 8;
+    }
+
+    // TLV length (1 byte, or 0xFF and 2 bytes), record header, type length,
+    // payload length (1 byte for short records, else 4) and ID length
+    if (pos + 2 > TAG_CACHE_BLOCK_BYTES) return 8;
+    uint16_t offset = pos + (firstBlock[pos + 1] == 0xFF ? 4 : 2);
+    if (offset + 2 > TAG_CACHE_BLOCK_BYTES) return 8;
+    uint8_t flags = firstBlock[offset];
+    uint8_t typeLength = firstBlock[offset + 1];
+    uint16_t typeOffset = offset + 2 + ((flags & 0x10) ? 1 : 4);
+    uint8_t idLength = 0;
+    if (flags & 0x08) {
+        if (typeOffset >= TAG_CACHE_BLOCK_BYTES) return 8;
+        idLength = firstBlock[typeOffset];
+        typeOffset++;
+    }
+    uint16_t payloadStart = typeOffset + typeLength + idLength;
+
+    if (typeLength == strlen(COMPACT_TAG_MIME_TYPE) &&
+        typeOffset + typeLength <= TAG_CACHE_BLOCK_BYTES &&
+        memcmp(firstBlock + typeOffset, COMPACT_TAG_MIME_TYPE, typeLength) == 0 &&
+        payloadStart + COMPACT_TAG_SM_ID_OFFSET + 4 <= TAG_CACHE_BLOCK_BYTES) {
+        return 0;
+    }
+    return 4 + payloadStart / 4;
+}
+
+// FNV-1a over the first 16 bytes of the NDEF area and the sm_id block, if any
+uint32_t tagCacheFingerprint(const uint8_t* firstBlock, const uint8_t* identityBlock) {
+    uint32_t hash = 2166136261UL;
+    for (uint8_t i = 0; i < TAG_CACHE_BLOCK_BYTES; i++) {
+        hash ^= firstBlock[i];
+        hash *= 16777619UL;
+    }
+    if (identityBlock) {
+        for (uint8_t i = 0; i < TAG_CACHE_BLOCK_BYTES; i++) {
+            hash ^= identityBlock[i];
+            hash *= 16777619UL;
+        }
+    }
+    return hash;
+}
+
+static TagCacheEntry* findEntry(const uint8_t* uid, uint8_t uidLength) {
+    if (uidLength == 0 || uidLength > sizeof(tagCache[0].uid)) return nullptr;
+
+    for (int i = 0; i < TAG_CACHE_SIZE; i++) {
+        TagCacheEntry& entry = tagCache[i];
+        if (entry.uidLength == uidLength && memcmp(entry.uid, uid, uidLength) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const TagCacheEntry* tagCacheFind(const uint8_t* uid, uint8_t uidLength) {
+    TagCacheEntry* entry = findEntry(uid, uidLength);
+    if (entry) entry->lastUsed = millis();
+    return entry;
+}
+
+// Existing entry of the UID, otherwise the least recently used (or empty) slot
+static TagCacheEntry* slotFor(const uint8_t* uid, uint8_t uidLength, uint32_t fingerprint) {
+    if (uidLength == 0 || uidLength > sizeof(tagCache[0].uid)) return nullptr;
+
+    TagCacheEntry* entry = findEntry(uid, uidLength);
+    if (!entry) {
+        entry = &tagCache[0];
+        for (int i = 1; i < TAG_CACHE_SIZE; i++) {
+            if (tagCache[i].lastUsed < entry->lastUsed) {
+                entry = &tagCache[i];
+            }
+        }
+    }
+
+    memcpy(entry->uid, uid, uidLength);
+    entry->uidLength = uidLength;
+    entry->fingerprint = fingerprint;
+    entry->lastUsed = millis();
+    return entry;
+}
+
+void tagCacheStoreSpool(const uint8_t* uid, uint8_t uidLength, uint32_t fingerprint, const String& json, const String& spoolId) {
+    TagCacheEntry* entry = slotFor(uid, uidLength, fingerprint);
+    if (!entry) return;
+
+    entry->openPrintTag = false;
+    entry->json = json;
+    entry->spoolId = spoolId;
+    entry->optData = OpenPrintTagData();
+}
+
+void tagCacheStoreOpenPrintTag(const uint8_t* uid, uint8_t uidLength, uint32_t fingerprint, const String& json, const OpenPrintTagData& optData) {
+    TagCacheEntry* entry = slotFor(uid, uidLength, fingerprint);
+    if (!entry) return;
+
+    entry->openPrintTag = true;
+    entry->json = json;
+    entry->spoolId = "";
+    entry->optData = optData;
+}
+
+static void clearEntry(TagCacheEntry& entry) {
+    entry.uidLength = 0;
+    entry.lastUsed = 0;
+    entry.json = "";
+    entry.spoolId = "";
+    entry.optData = OpenPrintTagData();
+}
+
+void tagCacheInvalidate(const uint8_t* uid, uint8_t uidLength) {
+    TagCacheEntry* entry = findEntry(uid, uidLength);
+    if (entry) clearEntry(*entry);
+}
+
+void tagCacheClear() {
+    for (int i = 0; i < TAG_CACHE_SIZE; i++) {
+        clearEntry(tagCache[i]);
+    }
+}
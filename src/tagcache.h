@@ -0,0 +1,32 @@
+#ifndef TAGCACHE_H
+#define TAGCACHE_H
+
+#include <Arduino.h>
+#include "openprinttag.h"
+
+// Decoded result of a tag, keyed by UID. The fingerprint covers the first
+// bulk-read block (pages 4-7: NDEF TLV length, record header and type) and the
+// block that holds sm_id: page 7 for compact tags, the first payload block for
+// JSON tags, which optimizeJsonForFastPath() starts with sm_id. A tag that was
+// put back is confirmed with at most two 16-byte READs. Every write from this
+// device invalidates the entry.
+struct TagCacheEntry {
+    uint8_t uid[7];
+    uint8_t uidLength;
+    uint32_t fingerprint;
+    unsigned long lastUsed;
+    bool openPrintTag;
+    String json;                // nfcJsonData as shown in the web UI
+    String spoolId;             // sm_id of JSON spool tags
+    OpenPrintTagData optData;   // parsed data of OpenPrintTag tags
+};
+
+uint8_t tagCacheIdentityPage(const uint8_t* firstBlock);
+uint32_t tagCacheFingerprint(const uint8_t* firstBlock, const uint8_t* identityBlock);
+const TagCacheEntry* tagCacheFind(const uint8_t* uid, uint8_t uidLength);
+void tagCacheStoreSpool(const uint8_t* uid, uint8_t uidLength, uint32_t fingerprint, const String& json, const String& spoolId);
+void tagCacheStoreOpenPrintTag(const uint8_t* uid, uint8_t uidLength, uint32_t fingerprint, const String& json, const OpenPrintTagData& optData);
+void tagCacheInvalidate(const uint8_t* uid, uint8_t uidLength);
+void tagCacheClear();
+
+#endif
@@ -0,0 +1,53 @@
+#include "tagdecode.h"
+#include "ndefrecord.h"
+#include "compacttag.h"
+
+TagDecodeStatus decodeTagBuffer(const uint8_t* buffer, uint16_t size, TagDecodeResult& result) {
+    result.format = TAG_FORMAT_UNKNOWN;
+    result.payloadLength = 0;
+    result.truncated = false;
+
+    NdefRecordView record;
+    if (!parseNdefRecord(buffer, size, record)) {
+        return TAG_DECODE_NO_RECORD;
+    }
+    Serial.printf("Record Type: %.*s\n", (int)record.type.length, (const char*)record.type.data);
+
+    result.payloadLength = record.payload.length;
+    result.format = detectTagFormat(record.payload.data, record.payload.length, record.type.length, record.type.data);
+
+    if (result.format == TAG_FORMAT_OPENPRINTTAG) {
+        if (!parseOpenPrintTag(record.payload.data, record.payload.length, result.optData)) {
+            return TAG_DECODE_BAD_OPENPRINTTAG;
+        }
+        result.json = openPrintTagToJson(result.optData);
+        return TAG_DECODE_OK;
+    }
+
+    // JSON payloads are parsed straight from the tag buffer, compact tags are
+    // expanded to the same JSON object first
+    ByteSpan json;
+    if (result.format == TAG_FORMAT_COMPACT) {
+        if (!compactTagDecode(record.payload.data, record.payload.length, result.json)) {
+            return TAG_DECODE_BAD_COMPACT;
+        }
+        json = { (const uint8_t*)result.json.c_str(), result.json.length() };
+    } else {
+        bool complete;
+        json = jsonObjectSpan(record.payload, complete);
+        result.truncated = !complete;
+    }
+
+    result.jsonError = deserializeJson(result.doc, (const char*)json.data, json.length);
+    if (result.jsonError) {
+        return TAG_DECODE_BAD_JSON;
+    }
+
+    // Kept as text for the web interface, one allocation
+    if (result.format != TAG_FORMAT_COMPACT) {
+        result.json = "";
+        result.json.reserve(json.length);
+        result.json.concat((const char*)json.data, json.length);
+    }
+    return TAG_DECODE_OK;
+}
@@ -0,0 +1,32 @@
+#ifndef TAGDECODE_H
+#define TAGDECODE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "openprinttag.h"
+
+// Buffer side of decodeNdefAndReturnJson(): record, format detection,
+// payload decode and JSON parse of the NDEF area read from page 4, without
+// the Spoolman, display and cache side effects.
+
+enum TagDecodeStatus {
+    TAG_DECODE_OK,
+    TAG_DECODE_NO_RECORD,           // no NDEF record in the buffer
+    TAG_DECODE_BAD_OPENPRINTTAG,    // see optData.parseError
+    TAG_DECODE_BAD_COMPACT,
+    TAG_DECODE_BAD_JSON,            // see jsonError
+};
+
+struct TagDecodeResult {
+    NfcTagFormat format;
+    uint32_t payloadLength;
+    bool truncated;                 // JSON object cut off by the end of the payload
+    String json;                    // text for the web interface
+    JsonDocument doc;               // parsed JSON, not used for OpenPrintTag
+    DeserializationError jsonError;
+    OpenPrintTagData optData;       // TAG_FORMAT_OPENPRINTTAG only
+};
+
+TagDecodeStatus decodeTagBuffer(const uint8_t* buffer, uint16_t size, TagDecodeResult& result);
+
+#endif
@@ -0,0 +1,137 @@
+#include "taggeometry.h"
+#include "nfc.h"
+
+#define NTAG_CMD_GET_VERSION    0x60
+#define GEOMETRY_CACHE_SIZE     4
+
+// GET_VERSION storage size byte -> layout
+static const NtagGeometry NTAG213_GEOMETRY = { NTAG_TYPE_213, "NTAG213", 45,  4, 39,  40,  41,  144 };
+static const NtagGeometry NTAG215_GEOMETRY = { NTAG_TYPE_215, "NTAG215", 135, 4, 129, 130, 131, 504 };
+static const NtagGeometry NTAG216_GEOMETRY = { NTAG_TYPE_216, "NTAG216", 231, 4, 225, 226, 227, 888 };
+static const NtagGeometry UNKNOWN_GEOMETRY = { NTAG_TYPE_UNKNOWN, "UNKNOWN", 0, 4, 0, 0, 0, 0 };
+
+struct GeometryCacheEntry {
+    uint8_t uid[7];
+    uint8_t uidLength;
+    unsigned long lastUsed;
+    NtagGeometry geometry;
+};
+
+static GeometryCacheEntry geometryCache[GEOMETRY_CACHE_SIZE];
+static NtagGeometry uncachedGeometry;
+
+static GeometryCacheEntry* findCacheEntry(const uint8_t* uid, uint8_t uidLength) {
+    for (int i = 0; i < GEOMETRY_CACHE_SIZE; i++) {
+        GeometryCacheEntry& entry = geometryCache[i];
+        if (entry.uidLength != 0 && entry.uidLength == uidLength && memcmp(entry.uid, uid, uidLength) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+static bool identifyByVersion(NtagGeometry& geometry) {
+    uint8_t cmd[1] = { NTAG_CMD_GET_VERSION };
+    uint8_t version[8];
+    uint8_t versionLength = sizeof(version);
+
+    if (!ntagTransceive(cmd, sizeof(cmd), version, &versionLength) || versionLength != sizeof(version)) {
+        return false;
+    }
+
+    // Byte 1: vendor (0x04 = NXP), byte 2: product type (0x04 = NTAG)
+    if (version[1] != 0x04 || version[2] != 0x04) {
+        Serial.printf("GET_VERSION: not an NXP NTAG (vendor %02X, type %02X)\n", version[1], version[2]);
+        return false;
+    }
+
+    switch (version[6]) {
+        case 0x0F: geometry = NTAG213_GEOMETRY; return true;
+        case 0x11: geometry = NTAG215_GEOMETRY; return true;
+        case 0x13: geometry = NTAG216_GEOMETRY; return true;
+        default:
+            Serial.printf("GET_VERSION: unknown storage size 0x%02X\n", version[6]);
+            return false;
+    }
+}
+
+// Tags without GET_VERSION answer with a NAK and drop back to IDLE, so the
+// tag is re-selected before reading the capability container.
+static bool identifyByCapabilityContainer(NtagGeometry& geometry) {
+    uint8_t cc[4];
+
+    if (!reselectTag() || !ntagReadPages(3, 1, cc) || cc[0] != 0xE1) {
+        return false;
+    }
+
+    // CC[2] holds the NDEF data area size in bytes / 8. The NTAG21x values
+    // map to their layout, anything else is confined to the declared area.
+    uint16_t dataAreaSize = cc[2] * 8;
+    switch (cc[2]) {
+        case 0x12: geometry = NTAG213_GEOMETRY; return true;
+        case 0x3E: geometry = NTAG215_GEOMETRY; return true;
+        case 0x6D: geometry = NTAG216_GEOMETRY; return true;
+    }
+    if (dataAreaSize == 0) return false;
+
+    geometry.type = NTAG_TYPE_GENERIC;
+    geometry.name = "Type 2";
+    geometry.firstUserPage = 4;
+    geometry.lastUserPage = geometry.firstUserPage + dataAreaSize / 4 - 1;
+    geometry.dynamicLockPage = geometry.lastUserPage + 1;
+    geometry.configStartPage = geometry.lastUserPage + 1;
+    geometry.totalPages = geometry.lastUserPage + 1;
+    geometry.userDataBytes = dataAreaSize;
+    return true;
+}
+
+const NtagGeometry& getTagGeometry(const uint8_t* uid, uint8_t uidLength) {
+    if (uidLength > sizeof(geometryCache[0].uid)) uidLength = sizeof(geometryCache[0].uid);
+
+    GeometryCacheEntry* entry = findCacheEntry(uid, uidLength);
+    if (entry) {
+        entry->lastUsed = millis();
+        return entry->geometry;
+    }
+
+    NtagGeometry geometry;
+    if (identifyByVersion(geometry)) {
+        Serial.printf("Tag geometry: %s (GET_VERSION)\n", geometry.name);
+    } else if (identifyByCapabilityContainer(geometry)) {
+        Serial.printf("Tag geometry: %s (capability container)\n", geometry.name);
+    } else {
+        // No user data area, so nothing gets written; not cached so the next access retries
+        uncachedGeometry = UNKNOWN_GEOMETRY;
+        Serial.println("Tag geometry: unknown, tag will not be written");
+        return uncachedGeometry;
+    }
+
+    // Without a UID there is nothing to key the cache on
+    if (uidLength == 0) {
+        uncachedGeometry = geometry;
+        return uncachedGeometry;
+    }
+
+    // Replace the least recently used (or empty) slot
+    entry = &geometryCache[0];
+    for (int i = 1; i < GEOMETRY_CACHE_SIZE; i++) {
+        if (geometryCache[i].lastUsed < entry->lastUsed) {
+            entry = &geometryCache[i];
+        }
+    }
+    memcpy(entry->uid, uid, uidLength);
+    entry->uidLength = uidLength;
+    entry->lastUsed = millis();
+    entry->geometry = geometry;
+    return entry->geometry;
+}
+
+void invalidateTagGeometry(const uint8_t* uid, uint8_t uidLength) {
+    if (uidLength > sizeof(geometryCache[0].uid)) uidLength = sizeof(geometryCache[0].uid);
+
+    GeometryCacheEntry* entry = findCacheEntry(uid, uidLength);
+    if (entry) {
+        entry->uidLength = 0;
+        entry->lastUsed = 0;
+    }
+}
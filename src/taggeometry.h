@@ -0,0 +1,35 @@
+#ifndef TAGGEOMETRY_H
+#define TAGGEOMETRY_H
+
+#include <Arduino.h>
+
+typedef enum {
+    NTAG_TYPE_UNKNOWN,
+    NTAG_TYPE_213,
+    NTAG_TYPE_215,
+    NTAG_TYPE_216,
+    NTAG_TYPE_GENERIC           // other type 2 tag, data area from the capability container
+} NtagType;
+
+// Memory layout of an NTAG21x tag. Pages 0-3 hold UID, lock bytes and the
+// capability container, user data starts at page 4 and ends right before the
+// dynamic lock page. Everything from configStartPage on must never be written.
+// An unidentified tag has no user data area (userDataBytes 0) and must not be
+// written at all.
+struct NtagGeometry {
+    NtagType type;
+    const char* name;
+    uint16_t totalPages;
+    uint8_t firstUserPage;
+    uint16_t lastUserPage;
+    uint16_t dynamicLockPage;
+    uint16_t configStartPage;
+    uint16_t userDataBytes;
+};
+
+// Geometry of the tag with the given UID. Identified once per UID with
+// GET_VERSION (CC fallback) and served from a small cache afterwards.
+const NtagGeometry& getTagGeometry(const uint8_t* uid, uint8_t uidLength);
+void invalidateTagGeometry(const uint8_t* uid, uint8_t uidLength);    // identified again on next use
+
+#endif
@@ -13,6 +13,10 @@
 #include "ota.h"
 #include "config.h"
 #include "debug.h"
+#include "scantrace.h"
+#include "httppool.h"
+#include "spoolmirror.h"
+#include "journal.h"
 
 
 #ifndef VERSION
@@ -38,6 +42,8 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventTyp
         sendNfcData();
         foundNfcTag(client, 0);
         sendWriteResult(client, 3);
+        if (nfcBayCount > 0) sendNfcBays(client);
+        sendNfcBatch(client);
 
         // Clean up dead connections
         (*server).cleanupClients();
@@ -79,6 +85,16 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventTyp
             }
         }
 
+        else if (doc["type"] == "writeNfcBatch") {
+            if (!doc["payloads"].is<JsonArray>() || !startNfcBatch(doc["payloads"].as<JsonArrayConst>())) {
+                ws.text(client->id(), "{\"type\":\"nfcBatch\",\"active\":false,\"error\":\"Batch could not be started\"}");
+            }
+        }
+
+        else if (doc["type"] == "cancelNfcBatch") {
+            cancelNfcBatch();
+        }
+
         else if (doc["type"] == "writeOpenPrintTag") {
             if (doc["payload"].is<JsonObject>()) {
                 String payloadString;
@@ -87,6 +103,31 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventTyp
             }
         }
 
+        else if (doc["type"] == "getNfcWritePolicy") {
+            sendNfcWritePolicy(client);
+        }
+
+        else if (doc["type"] == "setNfcWritePolicy") {
+            if (setNfcWritePolicy(doc["policy"].as<String>())) {
+                sendNfcWritePolicy(nullptr);
+            } else {
+                ws.text(client->id(), "{\"type\":\"nfcWritePolicy\",\"error\":\"Unknown policy\"}");
+            }
+        }
+
+        else if (doc["type"] == "setNfcTagEncoding") {
+            if (setNfcTagEncoding(doc["encoding"].as<String>())) {
+                sendNfcWritePolicy(nullptr);
+            } else {
+                ws.text(client->id(), "{\"type\":\"nfcWritePolicy\",\"error\":\"Unknown encoding\"}");
+            }
+        }
+
+        else if (doc["type"] == "setNfcDualTarget") {
+            setNfcDualTarget(doc["enabled"].as<bool>());
+            sendNfcWritePolicy(nullptr);
+        }
+
         else if (doc["type"] == "scale") {
             uint8_t success = 0;
             if (doc["payload"] == "tare") {
@@ -188,6 +229,66 @@ void sendWriteResult(AsyncWebSocketClient *client, uint8_t success) {
     ws.textAll(response);
 }
 
+// Current write verification policy, tag encoding and dual target mode plus
+// the phase timings of the last write.
+// Sent to the requesting client, or to everyone after the policy changed.
+void sendNfcWritePolicy(AsyncWebSocketClient *client) {
+    JsonDocument doc;
+    doc["type"] = "nfcWritePolicy";
+    doc["policy"] = nfcWritePolicyToString(nfcWritePolicy);
+    doc["encoding"] = nfcTagEncodingToString(nfcTagEncoding);
+    doc["dualTarget"] = nfcDualTarget;
+
+    JsonObject lastWrite = doc["lastWrite"].to<JsonObject>();
+    lastWrite["policy"] = nfcWritePolicyToString(lastNdefWriteStats.policy);
+    lastWrite["pagesWritten"] = lastNdefWriteStats.pagesWritten;
+    lastWrite["pagesSkipped"] = lastNdefWriteStats.pagesSkipped;
+    lastWrite["pagesVerified"] = lastNdefWriteStats.pagesVerified;
+    lastWrite["preCheckMs"] = lastNdefWriteStats.preCheckMs;
+    lastWrite["readMs"] = lastNdefWriteStats.readMs;
+    lastWrite["writeMs"] = lastNdefWriteStats.writeMs;
+    lastWrite["verifyMs"] = lastNdefWriteStats.verifyMs;
+    lastWrite["postCheckMs"] = lastNdefWriteStats.postCheckMs;
+    lastWrite["totalMs"] = lastNdefWriteStats.durationMs;
+
+    String message;
+    serializeJson(doc, message);
+    if (client) {
+        ws.text(client->id(), message);
+    } else {
+        ws.textAll(message);
+    }
+}
+
+// State of the bay readers, sent whenever a bay sees a spool come or go
+void sendNfcBays(AsyncWebSocketClient *client) {
+    JsonDocument doc;
+    doc["type"] = "nfcBays";
+    nfcBaysToJson(doc["bays"].to<JsonArray>());
+
+    String message;
+    serializeJson(doc, message);
+    if (client) {
+        ws.text(client->id(), message);
+    } else {
+        ws.textAll(message);
+    }
+}
+
+void sendNfcBatch(AsyncWebSocketClient *client) {
+    JsonDocument doc;
+    doc["type"] = "nfcBatch";
+    nfcBatchToJson(doc.to<JsonObject>());
+
+    String message;
+    serializeJson(doc, message);
+    if (client) {
+        ws.text(client->id(), message);
+    } else {
+        ws.textAll(message);
+    }
+}
+
 void foundNfcTag(AsyncWebSocketClient *client, uint8_t success) {
     if (success == lastSuccess) return;
     ws.textAll("{\"type\":\"nfcTag\", \"payload\":{\"found\": " + String(success) + "}}");
@@ -529,12 +630,18 @@ void setupWebserver(AsyncWebServer &server) {
         doc["current"]["ss"]    = pn532Pins.ss;
         doc["current"]["irq"]   = pn532Pins.irq;
         doc["current"]["reset"] = pn532Pins.reset;
+        doc["current"]["bus"]   = pn532BusToString(pn532Pins.bus);
+        doc["current"]["clock"] = pn532Pins.clock;
+        doc["current"]["useIrq"] = pn532Pins.useIrq;
         doc["defaults"]["sck"]   = (uint8_t)DEFAULT_PN532_SCK;
         doc["defaults"]["miso"]  = (uint8_t)DEFAULT_PN532_MISO;
         doc["defaults"]["mosi"]  = (uint8_t)DEFAULT_PN532_MOSI;
         doc["defaults"]["ss"]    = (uint8_t)DEFAULT_PN532_SS;
         doc["defaults"]["irq"]   = (uint8_t)DEFAULT_PN532_IRQ;
         doc["defaults"]["reset"] = (uint8_t)DEFAULT_PN532_RESET;
+        doc["defaults"]["bus"]   = pn532BusToString(DEFAULT_PN532_BUS);
+        doc["defaults"]["clock"] = defaultPn532Clock(DEFAULT_PN532_BUS);
+        doc["defaults"]["useIrq"] = DEFAULT_PN532_USE_IRQ;
         String jsonResponse;
         serializeJson(doc, jsonResponse);
         request->send(200, "application/json", jsonResponse);
@@ -585,13 +692,131 @@ void setupWebserver(AsyncWebServer &server) {
         newPins.irq   = (uint8_t)vals[4];
         newPins.reset = (uint8_t)vals[5];
 
+        // Bus and clock are optional, older clients only send the pins
+        newPins.bus   = pn532Pins.bus;
+        newPins.clock = pn532Pins.clock;
+        const AsyncWebParameter *busParam = request->hasParam("bus", true) ? request->getParam("bus", true)
+                                          : request->hasParam("bus") ? request->getParam("bus") : nullptr;
+        if (busParam) {
+            uint8_t bus;
+            for (bus = PN532_BUS_SOFT_SPI; bus <= PN532_BUS_HSU; bus++) {
+                if (busParam->value() == pn532BusToString(bus)) break;
+            }
+            if (bus > PN532_BUS_HSU) {
+                request->send(400, "application/json", "{\"success\":false,\"error\":\"Unknown bus - use softspi, spi, i2c or hsu\"}");
+                return;
+            }
+            if (bus != newPins.bus) newPins.clock = defaultPn532Clock(bus);
+            newPins.bus = bus;
+        }
+        const AsyncWebParameter *clockParam = request->hasParam("clock", true) ? request->getParam("clock", true)
+                                            : request->hasParam("clock") ? request->getParam("clock") : nullptr;
+        if (clockParam && clockParam->value().length() > 0) {
+            newPins.clock = strtoul(clockParam->value().c_str(), nullptr, 10);
+        }
+        newPins.useIrq = pn532Pins.useIrq;
+        const AsyncWebParameter *irqParam = request->hasParam("useIrq", true) ? request->getParam("useIrq", true)
+                                          : request->hasParam("useIrq") ? request->getParam("useIrq") : nullptr;
+        if (irqParam) {
+            newPins.useIrq = irqParam->value() == "true" || irqParam->value() == "1";
+        }
+
         if (!savePinConfig(newPins)) {
-            request->send(400, "application/json", "{\"success\":false,\"error\":\"Validation failed - pins must be unique and between 0-48\"}");
+            request->send(400, "application/json", "{\"success\":false,\"error\":\"Validation failed - pins must be unique and between 0-48, clock within the bus limits\"}");
             return;
         }
         request->send(200, "application/json", "{\"success\":true,\"message\":\"Pins saved. Reboot to apply.\"}");
     });
 
+    // ── POST /api/v1/nfc/selftest ── (runs on the RFID task between scans)
+    server.on("/api/v1/nfc/selftest", HTTP_POST, [](AsyncWebServerRequest *request){
+        if (RfidReaderTask == NULL) {
+            request->send(503, "application/json", "{\"success\":false,\"error\":\"NFC reader not running\"}");
+            return;
+        }
+        requestPn532SelfTest();
+        request->send(202, "application/json", "{\"success\":true,\"message\":\"Self-test scheduled\"}");
+    });
+
+    // ── GET /api/v1/nfc/selftest ── (result of the last run)
+    server.on("/api/v1/nfc/selftest", HTTP_GET, [](AsyncWebServerRequest *request){
+        JsonDocument doc;
+        const Pn532SelfTestResult& result = lastPn532SelfTest;
+        doc["available"] = result.valid;
+        if (result.valid) {
+            doc["ok"]             = result.ok;
+            doc["transport"]      = result.transport;
+            doc["clock"]          = result.clock;
+            doc["iterations"]     = result.iterations;
+            doc["latencyMinUs"]   = result.latencyMinUs;
+            doc["latencyAvgUs"]   = result.latencyAvgUs;
+            doc["latencyMaxUs"]   = result.latencyMaxUs;
+            doc["echoBytes"]      = result.echoBytes;
+            doc["bytesPerSecond"] = result.bytesPerSecond;
+            doc["durationMs"]     = result.durationMs;
+        }
+        String jsonResponse;
+        serializeJson(doc, jsonResponse);
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    // ── GET /api/v1/nfc/bays ── (configured bay readers and their state)
+    server.on("/api/v1/nfc/bays", HTTP_GET, [](AsyncWebServerRequest *request){
+        JsonDocument doc;
+        doc["max"] = NFC_MAX_BAYS;
+        nfcBaysToJson(doc["bays"].to<JsonArray>());
+        String jsonResponse;
+        serializeJson(doc, jsonResponse);
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    // ── POST /api/v1/nfc/bays ── (bays=[{"ss":15,"location":"Dryer 1"}, ...])
+    server.on("/api/v1/nfc/bays", HTTP_POST, [](AsyncWebServerRequest *request){
+        const AsyncWebParameter *baysParam = request->hasParam("bays", true) ? request->getParam("bays", true)
+                                           : request->hasParam("bays") ? request->getParam("bays") : nullptr;
+        if (!baysParam || !setNfcBays(baysParam->value())) {
+            request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid bays - SS pins must be unique, unused GPIOs between 0-48\"}");
+            return;
+        }
+        request->send(200, "application/json", "{\"success\":true,\"message\":\"Bays saved. Reboot to apply.\"}");
+    });
+
+    // ── GET /api/v1/metrics/scan ── (scan pipeline latency per phase, last 32 scans)
+    server.on("/api/v1/metrics/scan", HTTP_GET, [](AsyncWebServerRequest *request){
+        JsonDocument doc;
+        scanTraceMetricsToJson(doc.to<JsonObject>());
+        String jsonResponse;
+        serializeJson(doc, jsonResponse);
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    // ── GET /api/v1/metrics/http ── (Spoolman connection reuse and connect time)
+    server.on("/api/v1/metrics/http", HTTP_GET, [](AsyncWebServerRequest *request){
+        JsonDocument doc;
+        httpPoolStatsToJson(doc.to<JsonObject>());
+        String jsonResponse;
+        serializeJson(doc, jsonResponse);
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    // ── GET /api/v1/mirror ── (local copy of the Spoolman spools)
+    server.on("/api/v1/mirror", HTTP_GET, [](AsyncWebServerRequest *request){
+        JsonDocument doc;
+        spoolMirrorStatsToJson(doc.to<JsonObject>());
+        String jsonResponse;
+        serializeJson(doc, jsonResponse);
+        request->send(200, "application/json", jsonResponse);
+    });
+
+    // ── GET /api/v1/journal ── (Spoolman updates waiting to be sent)
+    server.on("/api/v1/journal", HTTP_GET, [](AsyncWebServerRequest *request){
+        JsonDocument doc;
+        journalStatsToJson(doc.to<JsonObject>());
+        String jsonResponse;
+        serializeJson(doc, jsonResponse);
+        request->send(200, "application/json", jsonResponse);
+    });
+
     // ── Hardware / Pin Mapping page ──
     server.on("/hardware", HTTP_GET, [](AsyncWebServerRequest *request){
         Serial.println("Request for /hardware received");
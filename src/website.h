@@ -27,5 +27,8 @@ void sendAmsData(AsyncWebSocketClient *client);
 void sendNfcData();
 void foundNfcTag(AsyncWebSocketClient *client, uint8_t success);
 void sendWriteResult(AsyncWebSocketClient *client, uint8_t success);
+void sendNfcWritePolicy(AsyncWebSocketClient *client);
+void sendNfcBays(AsyncWebSocketClient *client);
+void sendNfcBatch(AsyncWebSocketClient *client);
 
 #endif